@@ -1,68 +1,123 @@
-#include "AESWrapper.hpp"
-
-#include <modes.h>
-#include <aes.h>
-#include <filters.h>
-
-#include <stdexcept>
-#include <immintrin.h>	// _rdrand32_step
-
-
-unsigned char* AESWrapper::GenerateKey(unsigned char* buffer, unsigned int length)
-{
-	for (size_t i = 0; i < length; i += sizeof(unsigned int))
-		_rdrand32_step(reinterpret_cast<unsigned int*>(&buffer[i]));
-	return buffer;
-}
-
-AESWrapper::AESWrapper()
-{
-	GenerateKey(_key, DEFAULT_KEYLENGTH);
-}
-
-AESWrapper::AESWrapper(const unsigned char* key, unsigned int length)
-{
-	if (length != DEFAULT_KEYLENGTH)
-		throw std::length_error("key length must be 16 bytes");
-	memcpy_s(_key, DEFAULT_KEYLENGTH, key, length);
-}
-
-AESWrapper::~AESWrapper()
-{
-}
-
-const unsigned char* AESWrapper::getKey() const
-{
-	return _key;
-}
-
-std::string AESWrapper::encrypt(const char* plain, unsigned int length)
-{
-	CryptoPP::byte iv[CryptoPP::AES::BLOCKSIZE] = { 0 };	// for practical use iv should never be a fixed value!
-
-	CryptoPP::AES::Encryption aesEncryption(_key, DEFAULT_KEYLENGTH);
-	CryptoPP::CBC_Mode_ExternalCipher::Encryption cbcEncryption(aesEncryption, iv);
-
-	std::string cipher;
-	CryptoPP::StreamTransformationFilter stfEncryptor(cbcEncryption, new CryptoPP::StringSink(cipher));
-	stfEncryptor.Put(reinterpret_cast<const CryptoPP::byte*>(plain), length);
-	stfEncryptor.MessageEnd();
-
-	return cipher;
-}
-
-
-std::string AESWrapper::decrypt(const char* cipher, unsigned int length)
-{
-	CryptoPP::byte iv[CryptoPP::AES::BLOCKSIZE] = { 0 };	// for practical use iv should never be a fixed value!
-
-	CryptoPP::AES::Decryption aesDecryption(_key, DEFAULT_KEYLENGTH);
-	CryptoPP::CBC_Mode_ExternalCipher::Decryption cbcDecryption(aesDecryption, iv);
-
-	std::string decrypted;
-	CryptoPP::StreamTransformationFilter stfDecryptor(cbcDecryption, new CryptoPP::StringSink(decrypted));
-	stfDecryptor.Put(reinterpret_cast<const CryptoPP::byte*>(cipher), length);
-	stfDecryptor.MessageEnd();
-
-	return decrypted;
-}
+#include "AESWrapper.hpp"
+
+#include <modes.h>
+#include <aes.h>
+#include <filters.h>
+
+#include "cksum.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <immintrin.h>	// _rdrand32_step
+
+
+unsigned char* AESWrapper::GenerateKey(unsigned char* buffer, unsigned int length)
+{
+	for (size_t i = 0; i < length; i += sizeof(unsigned int))
+		_rdrand32_step(reinterpret_cast<unsigned int*>(&buffer[i]));
+	return buffer;
+}
+
+AESWrapper::AESWrapper()
+{
+	GenerateKey(_key, DEFAULT_KEYLENGTH);
+}
+
+AESWrapper::AESWrapper(const unsigned char* key, unsigned int length)
+{
+	if (length != DEFAULT_KEYLENGTH)
+		throw std::length_error("key length must be 16 bytes");
+	memcpy_s(_key, DEFAULT_KEYLENGTH, key, length);
+}
+
+AESWrapper::~AESWrapper()
+{
+}
+
+const unsigned char* AESWrapper::getKey() const
+{
+	return _key;
+}
+
+std::string AESWrapper::encrypt(const char* plain, unsigned int length)
+{
+	TraceSpan span("AES encrypt", length);
+	CryptoPP::byte iv[CryptoPP::AES::BLOCKSIZE] = { 0 };	// for practical use iv should never be a fixed value!
+
+	CryptoPP::AES::Encryption aesEncryption(_key, DEFAULT_KEYLENGTH);
+	CryptoPP::CBC_Mode_ExternalCipher::Encryption cbcEncryption(aesEncryption, iv);
+
+	std::string cipher;
+	CryptoPP::StreamTransformationFilter stfEncryptor(cbcEncryption, new CryptoPP::StringSink(cipher));
+	stfEncryptor.Put(reinterpret_cast<const CryptoPP::byte*>(plain), length);
+	stfEncryptor.MessageEnd();
+
+	return cipher;
+}
+
+// Same output as encrypt(), into a transfer buffer: the ciphertext's size is known up front (PKCS#7 always
+// adds 1 to 16 bytes), so it's reserved once and the sink never reallocates it.
+TransferString AESWrapper::encryptFile(const char* plain, unsigned int length)
+{
+	TraceSpan span("AES encrypt file", length);
+	CryptoPP::byte iv[CryptoPP::AES::BLOCKSIZE] = { 0 };	// for practical use iv should never be a fixed value!
+
+	CryptoPP::AES::Encryption aesEncryption(_key, DEFAULT_KEYLENGTH);
+	CryptoPP::CBC_Mode_ExternalCipher::Encryption cbcEncryption(aesEncryption, iv);
+
+	TransferString cipher;
+	cipher.reserve((length / CryptoPP::AES::BLOCKSIZE + 1) * CryptoPP::AES::BLOCKSIZE);
+	CryptoPP::StreamTransformationFilter stfEncryptor(cbcEncryption, new CryptoPP::StringSinkTemplate<TransferString>(cipher));
+	stfEncryptor.Put(reinterpret_cast<const CryptoPP::byte*>(plain), length);
+	stfEncryptor.MessageEnd();
+	countBytesEncrypted(length);
+
+	return cipher;
+}
+
+// Same output as encryptFile(), but the plaintext is walked once: every FUSED_BLOCK_SIZE block is fed to
+// the CRC and then to the cipher while it is still in cache, and the cksum of the plaintext is
+// returned through the cksum parameter.
+TransferString AESWrapper::encryptAndChecksum(const char* plain, unsigned int length, unsigned long& cksum)
+{
+	TraceSpan span("AES encrypt and cksum", length);
+	CryptoPP::byte iv[CryptoPP::AES::BLOCKSIZE] = { 0 };	// for practical use iv should never be a fixed value!
+
+	CryptoPP::AES::Encryption aesEncryption(_key, DEFAULT_KEYLENGTH);
+	CryptoPP::CBC_Mode_ExternalCipher::Encryption cbcEncryption(aesEncryption, iv);
+
+	TransferString cipher;
+	cipher.reserve((length / CryptoPP::AES::BLOCKSIZE + 1) * CryptoPP::AES::BLOCKSIZE);
+	CryptoPP::StreamTransformationFilter stfEncryptor(cbcEncryption, new CryptoPP::StringSinkTemplate<TransferString>(cipher));
+
+	unsigned long crc_state = 0;
+	for (unsigned int offset = 0; offset < length; offset += FUSED_BLOCK_SIZE) {
+		unsigned int block_length = std::min(FUSED_BLOCK_SIZE, length - offset);
+		crc_state = memcrc_update(crc_state, plain + offset, block_length);
+		stfEncryptor.Put(reinterpret_cast<const CryptoPP::byte*>(plain + offset), block_length);
+	}
+	stfEncryptor.MessageEnd();
+	countBytesEncrypted(length);
+
+	cksum = memcrc_final(crc_state, length);
+	return cipher;
+}
+
+std::string AESWrapper::decrypt(const char* cipher, unsigned int length)
+{
+	TraceSpan span("AES decrypt", length);
+	CryptoPP::byte iv[CryptoPP::AES::BLOCKSIZE] = { 0 };	// for practical use iv should never be a fixed value!
+
+	CryptoPP::AES::Decryption aesDecryption(_key, DEFAULT_KEYLENGTH);
+	CryptoPP::CBC_Mode_ExternalCipher::Decryption cbcDecryption(aesDecryption, iv);
+
+	std::string decrypted;
+	CryptoPP::StreamTransformationFilter stfDecryptor(cbcDecryption, new CryptoPP::StringSink(decrypted));
+	stfDecryptor.Put(reinterpret_cast<const CryptoPP::byte*>(cipher), length);
+	stfDecryptor.MessageEnd();
+
+	return decrypted;
+}
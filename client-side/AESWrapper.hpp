@@ -1,24 +1,29 @@
-#pragma once
-
-#include <string>
-
-
-class AESWrapper
-{
-public:
-	static const unsigned int DEFAULT_KEYLENGTH = 32;
-private:
-	unsigned char _key[DEFAULT_KEYLENGTH];
-	AESWrapper(const AESWrapper& aes);
-public:
-	static unsigned char* GenerateKey(unsigned char* buffer, unsigned int length);
-
-	AESWrapper();
-	AESWrapper(const unsigned char* key, unsigned int size);
-	~AESWrapper();
-
-	const unsigned char* getKey() const;
-
-	std::string encrypt(const char* plain, unsigned int length);
-	std::string decrypt(const char* cipher, unsigned int length);
+#pragma once
+
+#include <string>
+
+#include "transfer_buffer.hpp"
+
+
+class AESWrapper
+{
+public:
+	static const unsigned int DEFAULT_KEYLENGTH = 32;
+	static const unsigned int FUSED_BLOCK_SIZE = 32 * 1024;	// plaintext block kept cache-resident between the CRC and AES passes
+private:
+	unsigned char _key[DEFAULT_KEYLENGTH];
+	AESWrapper(const AESWrapper& aes);
+public:
+	static unsigned char* GenerateKey(unsigned char* buffer, unsigned int length);
+
+	AESWrapper();
+	AESWrapper(const unsigned char* key, unsigned int size);
+	~AESWrapper();
+
+	const unsigned char* getKey() const;
+
+	std::string encrypt(const char* plain, unsigned int length);
+	TransferString encryptFile(const char* plain, unsigned int length);
+	TransferString encryptAndChecksum(const char* plain, unsigned int length, unsigned long& cksum);
+	std::string decrypt(const char* cipher, unsigned int length);
 };
\ No newline at end of file
@@ -0,0 +1,19 @@
+#include "HMACWrapper.hpp"
+
+#include <hmac.h>
+#include <sha.h>
+#include <filters.h>
+
+
+std::string HMACWrapper::sign(const std::string& key, const std::string& message)
+{
+	std::string mac;
+	CryptoPP::HMAC<CryptoPP::SHA256> hmac(reinterpret_cast<const CryptoPP::byte*>(key.c_str()), key.size());
+	CryptoPP::StringSource ss(message, true,
+		new CryptoPP::HashFilter(hmac,
+			new CryptoPP::StringSink(mac)
+		) // HashFilter
+	); // StringSource
+
+	return mac;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+
+class HMACWrapper
+{
+public:
+	static const unsigned int DIGEST_SIZE = 32;
+
+	static std::string sign(const std::string& key, const std::string& message);
+};
@@ -1,120 +1,141 @@
-#include "RSAWrapper.hpp"
-
-
-RSAPublicWrapper::RSAPublicWrapper(const char* key, unsigned int length)
-{
-	CryptoPP::StringSource ss(reinterpret_cast<const CryptoPP::byte*>(key), length, true);
-	_publicKey.Load(ss);
-}
-
-RSAPublicWrapper::RSAPublicWrapper(const std::string& key)
-{
-	CryptoPP::StringSource ss(key, true);
-	_publicKey.Load(ss);
-}
-
-RSAPublicWrapper::~RSAPublicWrapper()
-{
-}
-
-std::string RSAPublicWrapper::getPublicKey() const
-{
-	std::string key;
-	CryptoPP::StringSink ss(key);
-	_publicKey.Save(ss);
-	return key;
-}
-
-char* RSAPublicWrapper::getPublicKey(char* keyout, unsigned int length) const
-{
-	CryptoPP::ArraySink as(reinterpret_cast<CryptoPP::byte*>(keyout), length);
-	_publicKey.Save(as);
-	return keyout;
-}
-
-std::string RSAPublicWrapper::encrypt(const std::string& plain)
-{
-	std::string cipher;
-	CryptoPP::RSAES_OAEP_SHA_Encryptor e(_publicKey);
-	CryptoPP::StringSource ss(plain, true, new CryptoPP::PK_EncryptorFilter(_rng, e, new CryptoPP::StringSink(cipher)));
-	return cipher;
-}
-
-std::string RSAPublicWrapper::encrypt(const char* plain, unsigned int length)
-{
-	std::string cipher;
-	CryptoPP::RSAES_OAEP_SHA_Encryptor e(_publicKey);
-	CryptoPP::StringSource ss(reinterpret_cast<const CryptoPP::byte*>(plain), length, true, new CryptoPP::PK_EncryptorFilter(_rng, e, new CryptoPP::StringSink(cipher)));
-	return cipher;
-}
-
-
-
-RSAPrivateWrapper::RSAPrivateWrapper()
-{
-	_privateKey.Initialize(_rng, BITS);
-}
-
-RSAPrivateWrapper::RSAPrivateWrapper(const char* key, unsigned int length)
-{
-	CryptoPP::StringSource ss(reinterpret_cast<const CryptoPP::byte*>(key), length, true);
-	_privateKey.Load(ss);
-}
-
-RSAPrivateWrapper::RSAPrivateWrapper(const std::string& key)
-{
-	CryptoPP::StringSource ss(key, true);
-	_privateKey.Load(ss);
-}
-
-RSAPrivateWrapper::~RSAPrivateWrapper()
-{
-}
-
-std::string RSAPrivateWrapper::getPrivateKey() const
-{
-	std::string key;
-	CryptoPP::StringSink ss(key);
-	_privateKey.Save(ss);
-	return key;
-}
-
-char* RSAPrivateWrapper::getPrivateKey(char* keyout, unsigned int length) const
-{
-	CryptoPP::ArraySink as(reinterpret_cast<CryptoPP::byte*>(keyout), length);
-	_privateKey.Save(as);
-	return keyout;
-}
-
-std::string RSAPrivateWrapper::getPublicKey() const
-{
-	CryptoPP::RSAFunction publicKey(_privateKey);
-	std::string key;
-	CryptoPP::StringSink ss(key);
-	publicKey.Save(ss);
-	return key;
-}
-
-char* RSAPrivateWrapper::getPublicKey(char* keyout, unsigned int length) const
-{
-	CryptoPP::RSAFunction publicKey(_privateKey);
-	CryptoPP::ArraySink as(reinterpret_cast<CryptoPP::byte*>(keyout), length);
-	publicKey.Save(as);
-	return keyout;
-}
-
-std::string RSAPrivateWrapper::decrypt(const std::string& cipher)
-{
-	std::string decrypted;
-	CryptoPP::RSAES_OAEP_SHA_Decryptor d(_privateKey);
-	CryptoPP::StringSource ss_cipher(cipher, true, new CryptoPP::PK_DecryptorFilter(_rng, d, new CryptoPP::StringSink(decrypted)));
-	return decrypted;
-}
-
-std::string RSAPrivateWrapper::decrypt(const char* cipher, unsigned int length)
-{
-	std::string decrypted;
-	CryptoPP::RSAES_OAEP_SHA_Decryptor d(_privateKey);
-	CryptoPP::StringSource ss_cipher(reinterpret_cast<const CryptoPP::byte*>(cipher), length, true, new CryptoPP::PK_DecryptorFilter(_rng, d, new CryptoPP::StringSink(decrypted)));
-	return decrypted;
-}
+#include "RSAWrapper.hpp"
+#include "trace.hpp"
+
+
+RSAPublicWrapper::RSAPublicWrapper(const char* key, unsigned int length)
+{
+	CryptoPP::StringSource ss(reinterpret_cast<const CryptoPP::byte*>(key), length, true);
+	_publicKey.Load(ss);
+}
+
+RSAPublicWrapper::RSAPublicWrapper(const std::string& key)
+{
+	CryptoPP::StringSource ss(key, true);
+	_publicKey.Load(ss);
+}
+
+RSAPublicWrapper::~RSAPublicWrapper()
+{
+}
+
+std::string RSAPublicWrapper::getPublicKey() const
+{
+	std::string key;
+	CryptoPP::StringSink ss(key);
+	_publicKey.Save(ss);
+	return key;
+}
+
+char* RSAPublicWrapper::getPublicKey(char* keyout, unsigned int length) const
+{
+	CryptoPP::ArraySink as(reinterpret_cast<CryptoPP::byte*>(keyout), length);
+	_publicKey.Save(as);
+	return keyout;
+}
+
+std::string RSAPublicWrapper::encrypt(const std::string& plain)
+{
+	TraceSpan span("RSA encrypt");
+	std::string cipher;
+	CryptoPP::RSAES_OAEP_SHA_Encryptor e(_publicKey);
+	CryptoPP::StringSource ss(plain, true, new CryptoPP::PK_EncryptorFilter(_rng, e, new CryptoPP::StringSink(cipher)));
+	return cipher;
+}
+
+std::string RSAPublicWrapper::encrypt(const char* plain, unsigned int length)
+{
+	TraceSpan span("RSA encrypt");
+	std::string cipher;
+	CryptoPP::RSAES_OAEP_SHA_Encryptor e(_publicKey);
+	CryptoPP::StringSource ss(reinterpret_cast<const CryptoPP::byte*>(plain), length, true, new CryptoPP::PK_EncryptorFilter(_rng, e, new CryptoPP::StringSink(cipher)));
+	return cipher;
+}
+
+
+
+RSAPrivateWrapper::RSAPrivateWrapper()
+{
+	TraceSpan span("RSA generate key");
+	_privateKey.Initialize(_rng, BITS);
+}
+
+RSAPrivateWrapper::RSAPrivateWrapper(const char* key, unsigned int length)
+{
+	TraceSpan span("RSA load key");
+	CryptoPP::StringSource ss(reinterpret_cast<const CryptoPP::byte*>(key), length, true);
+	_privateKey.Load(ss);
+}
+
+RSAPrivateWrapper::RSAPrivateWrapper(const std::string& key)
+{
+	TraceSpan span("RSA load key");
+	CryptoPP::StringSource ss(key, true);
+	_privateKey.Load(ss);
+}
+
+RSAPrivateWrapper::RSAPrivateWrapper(const CryptoPP::Integer& n, const CryptoPP::Integer& e, const CryptoPP::Integer& d,
+	const CryptoPP::Integer& p, const CryptoPP::Integer& q,
+	const CryptoPP::Integer& dp, const CryptoPP::Integer& dq, const CryptoPP::Integer& u)
+{
+	TraceSpan span("RSA load cached key");
+	_privateKey.Initialize(n, e, d, p, q, dp, dq, u);
+}
+
+RSAPrivateWrapper::~RSAPrivateWrapper()
+{
+}
+
+const CryptoPP::RSA::PrivateKey& RSAPrivateWrapper::getKey() const
+{
+	return _privateKey;
+}
+
+std::string RSAPrivateWrapper::getPrivateKey() const
+{
+	std::string key;
+	CryptoPP::StringSink ss(key);
+	_privateKey.Save(ss);
+	return key;
+}
+
+char* RSAPrivateWrapper::getPrivateKey(char* keyout, unsigned int length) const
+{
+	CryptoPP::ArraySink as(reinterpret_cast<CryptoPP::byte*>(keyout), length);
+	_privateKey.Save(as);
+	return keyout;
+}
+
+std::string RSAPrivateWrapper::getPublicKey() const
+{
+	CryptoPP::RSAFunction publicKey(_privateKey);
+	std::string key;
+	CryptoPP::StringSink ss(key);
+	publicKey.Save(ss);
+	return key;
+}
+
+char* RSAPrivateWrapper::getPublicKey(char* keyout, unsigned int length) const
+{
+	CryptoPP::RSAFunction publicKey(_privateKey);
+	CryptoPP::ArraySink as(reinterpret_cast<CryptoPP::byte*>(keyout), length);
+	publicKey.Save(as);
+	return keyout;
+}
+
+std::string RSAPrivateWrapper::decrypt(const std::string& cipher)
+{
+	TraceSpan span("RSA decrypt");
+	std::string decrypted;
+	CryptoPP::RSAES_OAEP_SHA_Decryptor d(_privateKey);
+	CryptoPP::StringSource ss_cipher(cipher, true, new CryptoPP::PK_DecryptorFilter(_rng, d, new CryptoPP::StringSink(decrypted)));
+	return decrypted;
+}
+
+std::string RSAPrivateWrapper::decrypt(const char* cipher, unsigned int length)
+{
+	TraceSpan span("RSA decrypt");
+	std::string decrypted;
+	CryptoPP::RSAES_OAEP_SHA_Decryptor d(_privateKey);
+	CryptoPP::StringSource ss_cipher(reinterpret_cast<const CryptoPP::byte*>(cipher), length, true, new CryptoPP::PK_DecryptorFilter(_rng, d, new CryptoPP::StringSink(decrypted)));
+	return decrypted;
+}
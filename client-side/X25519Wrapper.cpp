@@ -0,0 +1,53 @@
+#include "X25519Wrapper.hpp"
+#include "HMACWrapper.hpp"
+#include "trace.hpp"
+
+#include <stdexcept>
+
+
+X25519Wrapper::X25519Wrapper()
+{
+	TraceSpan span("X25519 generate key");
+	_domain.GenerateKeyPair(_rng, _privateKey, _publicKey);
+}
+
+X25519Wrapper::X25519Wrapper(const std::string& key)
+{
+	if (key.size() != KEYSIZE)
+		throw std::length_error("x25519 private key length must be 32 bytes");
+	memcpy(_privateKey, key.c_str(), KEYSIZE);
+	_domain.GeneratePublicKey(_rng, _privateKey, _publicKey);
+}
+
+X25519Wrapper::~X25519Wrapper()
+{
+}
+
+std::string X25519Wrapper::getPrivateKey() const
+{
+	return std::string(reinterpret_cast<const char*>(_privateKey), KEYSIZE);
+}
+
+std::string X25519Wrapper::getPublicKey() const
+{
+	return std::string(reinterpret_cast<const char*>(_publicKey), KEYSIZE);
+}
+
+std::string X25519Wrapper::agree(const std::string& peer_public_key)
+{
+	TraceSpan span("X25519 agree");
+	if (peer_public_key.size() != KEYSIZE)
+		throw std::length_error("x25519 public key length must be 32 bytes");
+
+	std::string shared(KEYSIZE, '\0');
+	if (!_domain.Agree(reinterpret_cast<CryptoPP::byte*>(&shared[0]), _privateKey, reinterpret_cast<const CryptoPP::byte*>(peer_public_key.c_str())))
+		throw std::runtime_error("x25519 key agreement failed");
+	return shared;
+}
+
+// The AES key of a handshake with the server's ephemeral key: the shared secret is derived with both public
+// keys mixed in, so the key is bound to this exchange and not only to the raw shared point.
+std::string X25519Wrapper::agreeAESKey(const std::string& server_public_key)
+{
+	return HMACWrapper::sign(agree(server_public_key), "x25519 session key" + getPublicKey() + server_public_key);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <osrng.h>
+#include <xed25519.h>
+#include <string>
+
+
+
+class X25519Wrapper
+{
+public:
+	static const unsigned int KEYSIZE = 32;
+
+private:
+	CryptoPP::AutoSeededRandomPool _rng;
+	CryptoPP::x25519 _domain;
+	CryptoPP::byte _privateKey[KEYSIZE];
+	CryptoPP::byte _publicKey[KEYSIZE];
+
+	X25519Wrapper(const X25519Wrapper& x25519);
+	X25519Wrapper& operator=(const X25519Wrapper& x25519);
+public:
+	X25519Wrapper();
+	X25519Wrapper(const std::string& key);
+	~X25519Wrapper();
+
+	std::string getPrivateKey() const;
+	std::string getPublicKey() const;
+
+	std::string agree(const std::string& peer_public_key);
+	std::string agreeAESKey(const std::string& server_public_key);
+};
@@ -0,0 +1,176 @@
+#include "alloc_tracking.hpp"
+
+#ifdef TRACK_ALLOCATIONS
+#include "run_report.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <new>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+constexpr size_t NO_ALLOCATION_PHASE = static_cast<size_t>(RunPhase::Count);
+
+struct AllocationCounters {
+	std::atomic<uint64_t> count;
+	std::atomic<uint64_t> bytes;
+};
+
+// Constant initialized, so the allocations made before main (by other files' statics) are counted too.
+static AllocationCounters allocation_counters[NO_ALLOCATION_PHASE + 1] = {};
+static thread_local size_t thread_allocation_phase = NO_ALLOCATION_PHASE;
+static thread_local uint64_t thread_allocations = 0;
+
+size_t enterAllocationPhase(size_t phase) {
+	size_t previous_phase = thread_allocation_phase;
+	thread_allocation_phase = phase;
+	return previous_phase;
+}
+
+void leaveAllocationPhase(size_t previous_phase) {
+	thread_allocation_phase = previous_phase;
+}
+
+void recordAllocation(size_t bytes) {
+	AllocationCounters& counters = allocation_counters[thread_allocation_phase];
+	counters.count.fetch_add(1, std::memory_order_relaxed);
+	counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+	thread_allocations++;
+}
+
+uint64_t threadAllocationCount() {
+	return thread_allocations;
+}
+
+void readAllocations(size_t phase, uint64_t& count, uint64_t& bytes) {
+	count = allocation_counters[phase].count.load(std::memory_order_relaxed);
+	bytes = allocation_counters[phase].bytes.load(std::memory_order_relaxed);
+}
+
+AllocationFreeCheck::AllocationFreeCheck(const char* what)
+	: what(what), start(thread_allocations), uncaught_exceptions(std::uncaught_exceptions()) {}
+
+AllocationFreeCheck::~AllocationFreeCheck() {
+	uint64_t allocations = thread_allocations - this->start;
+	if (allocations != 0 && std::uncaught_exceptions() == this->uncaught_exceptions) {
+		// not through the log: its flusher thread wouldn't get to write the message before the abort.
+		fprintf(stderr, "allocation check failed: %s allocated %llu times\n", this->what, static_cast<unsigned long long>(allocations));
+		std::abort();
+	}
+}
+
+static void* allocate(size_t size) {
+	recordAllocation(size);
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+static void* allocateAligned(size_t size, size_t alignment) {
+	recordAllocation(size);
+#ifdef _MSC_VER
+	return _aligned_malloc(size == 0 ? 1 : size, alignment);
+#else
+	void* buffer = nullptr;
+	return posix_memalign(&buffer, alignment < sizeof(void*) ? sizeof(void*) : alignment, size == 0 ? 1 : size) == 0 ? buffer : nullptr;
+#endif
+}
+
+static void freeAligned(void* buffer) {
+#ifdef _MSC_VER
+	_aligned_free(buffer);
+#else
+	std::free(buffer);
+#endif
+}
+
+void* operator new(size_t size) {
+	void* buffer = allocate(size);
+	if (buffer == nullptr) {
+		throw std::bad_alloc();
+	}
+	return buffer;
+}
+
+void* operator new[](size_t size) {
+	return ::operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	return allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+	void* buffer = allocateAligned(size, static_cast<size_t>(alignment));
+	if (buffer == nullptr) {
+		throw std::bad_alloc();
+	}
+	return buffer;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+	return ::operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return allocateAligned(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return allocateAligned(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* buffer) noexcept {
+	std::free(buffer);
+}
+
+void operator delete[](void* buffer) noexcept {
+	std::free(buffer);
+}
+
+void operator delete(void* buffer, size_t) noexcept {
+	std::free(buffer);
+}
+
+void operator delete[](void* buffer, size_t) noexcept {
+	std::free(buffer);
+}
+
+void operator delete(void* buffer, const std::nothrow_t&) noexcept {
+	std::free(buffer);
+}
+
+void operator delete[](void* buffer, const std::nothrow_t&) noexcept {
+	std::free(buffer);
+}
+
+void operator delete(void* buffer, std::align_val_t) noexcept {
+	freeAligned(buffer);
+}
+
+void operator delete[](void* buffer, std::align_val_t) noexcept {
+	freeAligned(buffer);
+}
+
+void operator delete(void* buffer, size_t, std::align_val_t) noexcept {
+	freeAligned(buffer);
+}
+
+void operator delete[](void* buffer, size_t, std::align_val_t) noexcept {
+	freeAligned(buffer);
+}
+
+void operator delete(void* buffer, std::align_val_t, const std::nothrow_t&) noexcept {
+	freeAligned(buffer);
+}
+
+void operator delete[](void* buffer, std::align_val_t, const std::nothrow_t&) noexcept {
+	freeAligned(buffer);
+}
+#endif
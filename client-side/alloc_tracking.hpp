@@ -0,0 +1,45 @@
+#ifndef ALLOC_TRACKING_HPP
+#define ALLOC_TRACKING_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Building with TRACK_ALLOCATIONS defined replaces the global operator new and delete with ones that count
+// every allocation and its bytes, attributed to the phase the allocating thread is in (see PhaseTimer), and
+// turns every AllocationFreeCheck into a hard check. Without it nothing here costs anything.
+#ifdef TRACK_ALLOCATIONS
+
+size_t enterAllocationPhase(size_t phase); // returns the phase the thread was in, for leaveAllocationPhase
+void leaveAllocationPhase(size_t previous_phase);
+void recordAllocation(size_t bytes);       // for the buffers that don't come from operator new
+uint64_t threadAllocationCount();
+void readAllocations(size_t phase, uint64_t& count, uint64_t& bytes); // phase RunPhase::Count is outside every phase
+
+// Aborts the process if the calling thread allocates between its construction and its destruction.
+// It marks the loops that must stay allocation free, so a regression fails the tracking build's first run,
+// and tests/allocation_check.cpp (ctest) runs them on every build.
+// A scope left by an exception isn't checked: the error path may allocate its message.
+class AllocationFreeCheck {
+private:
+	const char* what;
+	uint64_t start;
+	int uncaught_exceptions;
+
+public:
+	explicit AllocationFreeCheck(const char* what);
+	~AllocationFreeCheck();
+
+	AllocationFreeCheck(const AllocationFreeCheck&) = delete;
+	AllocationFreeCheck& operator=(const AllocationFreeCheck&) = delete;
+};
+
+#else
+
+class AllocationFreeCheck {
+public:
+	explicit AllocationFreeCheck(const char*) {}
+};
+
+#endif
+
+#endif
@@ -0,0 +1,103 @@
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+// The values that need bucket k (k >= 1) are in [2^(SUB_BUCKET_BITS + k - 1), 2^(SUB_BUCKET_BITS + k)),
+// each of its SUB_BUCKET_HALF_COUNT sub-buckets is 2^k values wide.
+static int mostSignificantBit(uint64_t value) {
+	int bit = 0;
+	while (value >>= 1) {
+		bit++;
+	}
+	return bit;
+}
+
+size_t LatencyHistogram::indexOf(uint64_t value) {
+	if (value < SUB_BUCKET_COUNT) {
+		return static_cast<size_t>(value);
+	}
+	int bucket = mostSignificantBit(value) - SUB_BUCKET_BITS + 1;
+	uint64_t sub_bucket = (value >> bucket) - SUB_BUCKET_HALF_COUNT;
+	return static_cast<size_t>(SUB_BUCKET_COUNT + (bucket - 1) * SUB_BUCKET_HALF_COUNT + sub_bucket);
+}
+
+uint64_t LatencyHistogram::highestEquivalentValue(size_t index) {
+	if (index < SUB_BUCKET_COUNT) {
+		return index;
+	}
+	int bucket = static_cast<int>((index - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF_COUNT) + 1;
+	uint64_t sub_bucket = (index - SUB_BUCKET_COUNT) % SUB_BUCKET_HALF_COUNT;
+	return ((SUB_BUCKET_HALF_COUNT + sub_bucket + 1) << bucket) - 1;
+}
+
+LatencyHistogram::LatencyHistogram()
+	: counts(SUB_BUCKET_COUNT + (MAX_VALUE_BITS - SUB_BUCKET_BITS) * SUB_BUCKET_HALF_COUNT, 0),
+	total_count(0), min_value(UINT64_MAX), max_value(0), sum(0) {
+}
+
+void LatencyHistogram::record(uint64_t microseconds) {
+	uint64_t value = std::min(microseconds, (uint64_t(1) << MAX_VALUE_BITS) - 1);
+	this->counts[indexOf(value)]++;
+	this->total_count++;
+	this->min_value = std::min(this->min_value, value);
+	this->max_value = std::max(this->max_value, value);
+	this->sum += value;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+	for (size_t i = 0; i < this->counts.size(); i++) {
+		this->counts[i] += other.counts[i];
+	}
+	this->total_count += other.total_count;
+	this->min_value = std::min(this->min_value, other.min_value);
+	this->max_value = std::max(this->max_value, other.max_value);
+	this->sum += other.sum;
+}
+
+uint64_t LatencyHistogram::count() const {
+	return this->total_count;
+}
+
+uint64_t LatencyHistogram::min() const {
+	return this->total_count == 0 ? 0 : this->min_value;
+}
+
+uint64_t LatencyHistogram::max() const {
+	return this->max_value;
+}
+
+double LatencyHistogram::mean() const {
+	return this->total_count == 0 ? 0 : static_cast<double>(this->sum / this->total_count);
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const {
+	if (this->total_count == 0) {
+		return 0;
+	}
+	uint64_t wanted = std::max<uint64_t>(1, static_cast<uint64_t>(percentile / 100 * this->total_count + 0.5));
+	uint64_t seen = 0;
+	for (size_t i = 0; i < this->counts.size(); i++) {
+		seen += this->counts[i];
+		if (seen >= wanted) {
+			return std::min(highestEquivalentValue(i), this->max_value);
+		}
+	}
+	return this->max_value;
+}
+
+std::string LatencyHistogram::toJson() const {
+	std::ostringstream json;
+	json << std::fixed << std::setprecision(1)
+		<< "{\"count\":" << count()
+		<< ",\"min_us\":" << min()
+		<< ",\"mean_us\":" << mean()
+		<< ",\"p50_us\":" << percentile(50)
+		<< ",\"p90_us\":" << percentile(90)
+		<< ",\"p99_us\":" << percentile(99)
+		<< ",\"p99_9_us\":" << percentile(99.9)
+		<< ",\"max_us\":" << max()
+		<< "}";
+	return json.str();
+}
@@ -0,0 +1,48 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A high dynamic range histogram of latencies in microseconds: every value from 1 us to over an hour is kept
+// with 3 significant digits (a relative error under 0.1%), in a fixed number of counters.
+//
+// Values below SUB_BUCKET_COUNT are counted exactly. Above, every power of two range [2^k, 2^(k+1)) is split
+// into SUB_BUCKET_COUNT / 2 equal sub-buckets, so the bucket of a value is found with a shift and an add.
+// Recording doesn't allocate or lock - every thread records into its own histogram, and they're merged at
+// the end.
+class LatencyHistogram {
+private:
+	static constexpr int SUB_BUCKET_BITS = 11;
+	static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t(1) << SUB_BUCKET_BITS;
+	static constexpr uint64_t SUB_BUCKET_HALF_COUNT = SUB_BUCKET_COUNT / 2;
+	static constexpr int MAX_VALUE_BITS = 42; // about 50 days in microseconds
+
+	std::vector<uint64_t> counts;
+	uint64_t total_count;
+	uint64_t min_value;
+	uint64_t max_value;
+	long double sum;
+
+	static size_t indexOf(uint64_t value);
+	static uint64_t highestEquivalentValue(size_t index);
+
+public:
+	LatencyHistogram();
+
+	void record(uint64_t microseconds);
+	void merge(const LatencyHistogram& other);
+
+	uint64_t count() const;
+	uint64_t min() const;
+	uint64_t max() const;
+	double mean() const;
+	uint64_t percentile(double percentile) const; // the value at or below which `percentile` percent of the values are
+
+	// {"count":..,"min_us":..,"mean_us":..,"p50_us":..,"p90_us":..,"p99_us":..,"p99_9_us":..,"max_us":..}
+	std::string toJson() const;
+};
+
+#endif
@@ -0,0 +1,481 @@
+// Load generator for the server: simulates many concurrent clients, each running sessions (registration,
+// reconnection or an upload) back to back over its own connection, with the client's own Request classes and
+// transaction engine. It reports the throughput and the latency percentiles (HDR histograms) of every kind of
+// session, and how many failed, as one JSON document.
+//
+// By default it targets the Python server on 127.0.0.1:1256 (its default port); --stand-in runs it against the
+// in-process loopback_server.hpp instead. Every simulated client is a thread, since the engine's sockets block.
+//
+// Usage: load_generator [--server HOST:PORT | --stand-in 1] [--clients N] [--duration SECONDS] [--ramp-up SECONDS]
+//                       [--mix register=1,reconnect=1,upload=8] [--file-sizes 4K:50,64K:30,1M:20 | lognormal:MEDIAN:SIGMA]
+//                       [--key-pool N] [--think-ms N] [--output FILE]
+
+#include "latency_histogram.hpp"
+#include "loopback_server.hpp"
+#include "../cksum.hpp"
+#include "../codes.hpp"
+#include "../payloads_sizes.hpp"
+#include "../requests.hpp"
+#include "../requests_payloads.hpp"
+#include "../response_reader.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <sstream>
+
+using LoadClock = std::chrono::steady_clock;
+
+constexpr const char* LOAD_FILE_NAME = "load.bin";
+
+enum class SessionKind {
+	Register,
+	Reconnect,
+	Upload,
+	Count
+};
+
+static const char* const SESSION_KIND_NAMES[] = { "register", "reconnect", "upload" };
+
+struct LoadOptions {
+	string host = "127.0.0.1";
+	string port = "1256";
+	bool stand_in = false;
+	size_t clients = 100;
+	double duration_seconds = 30;
+	double ramp_up_seconds = 5;                 // the clients' first sessions are spread over this long
+	double mix[static_cast<size_t>(SessionKind::Count)] = { 1, 1, 8 };
+	vector<std::pair<size_t, double>> file_sizes = { { size_t(64) << 10, 1 } }; // size and weight
+	bool lognormal_sizes = false;
+	double lognormal_median = 0;
+	double lognormal_sigma = 0;
+	size_t key_pool = 16;                       // RSA key pairs the clients register with, generated before the run
+	double think_ms = 0;                        // pause between two sessions of a client
+	string output;
+};
+
+// What every client thread measures. Merged once the threads are done.
+struct ClientResults {
+	LatencyHistogram latency[static_cast<size_t>(SessionKind::Count)];
+	uint64_t completed[static_cast<size_t>(SessionKind::Count)] = {};
+	uint64_t failed[static_cast<size_t>(SessionKind::Count)] = {};
+	uint64_t bytes_uploaded = 0;
+};
+
+// A user this client registered, and the key pair it registered with.
+struct Identity {
+	string name;
+	UUID uuid;
+	RSAPrivateWrapper* rsa_wrapper;
+};
+
+static string runId() {
+	return std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() % 100000000);
+}
+
+static size_t clampFileSize(double size) {
+	// the encrypted file (up to 16 bytes longer) must fit in 65535 packets.
+	double largest = static_cast<double>(UINT16_MAX) * CONTENT_SIZE_PER_PACKET - 16;
+	return static_cast<size_t>(std::max(1.0, std::min(size, largest)));
+}
+
+class LoadClient {
+private:
+	const LoadOptions& options;
+	std::unique_ptr<RSAPrivateWrapper> rsa_wrapper; // this client's copy of a pooled key pair - decrypt uses the wrapper's RNG, which isn't thread-safe
+	const TransferString& file_pattern;
+	size_t client_index;
+	string run_id;
+	std::mt19937_64 random;
+	boost::asio::io_context io_context;
+	tcp::resolver::results_type endpoints;
+	std::unique_ptr<Identity> identity;
+	size_t registrations;
+
+	SessionKind chooseSession();
+	size_t chooseFileSize();
+	string exchangeKey(ClientSocket& sock, ResponseReader& reader);
+	void registerIdentity(ClientSocket& sock, ResponseReader& reader, string& aes_key);
+	void upload(ClientSocket& sock, ResponseReader& reader, const string& aes_key, size_t file_size);
+
+public:
+	ClientResults results;
+
+	LoadClient(const LoadOptions& options, const vector<std::unique_ptr<RSAPrivateWrapper>>& keys, const TransferString& file_pattern,
+		size_t client_index, const string& run_id);
+	void run(LoadClock::time_point start, LoadClock::time_point end);
+};
+
+LoadClient::LoadClient(const LoadOptions& options, const vector<std::unique_ptr<RSAPrivateWrapper>>& keys, const TransferString& file_pattern,
+	size_t client_index, const string& run_id)
+	: options(options), rsa_wrapper(std::make_unique<RSAPrivateWrapper>(keys[client_index % keys.size()]->getPrivateKey())), file_pattern(file_pattern), client_index(client_index), run_id(run_id),
+	random(client_index * 0x9e3779b97f4a7c15ull + 1), registrations(0) {
+	tcp::resolver resolver(this->io_context);
+	this->endpoints = resolver.resolve(options.host, options.port);
+}
+
+SessionKind LoadClient::chooseSession() {
+	std::discrete_distribution<int> distribution(std::begin(this->options.mix), std::end(this->options.mix));
+	return static_cast<SessionKind>(distribution(this->random));
+}
+
+size_t LoadClient::chooseFileSize() {
+	if (this->options.lognormal_sizes) {
+		std::lognormal_distribution<double> distribution(std::log(this->options.lognormal_median), this->options.lognormal_sigma);
+		return clampFileSize(distribution(this->random));
+	}
+	vector<double> weights;
+	for (const auto& file_size : this->options.file_sizes) {
+		weights.push_back(file_size.second);
+	}
+	std::discrete_distribution<size_t> distribution(weights.begin(), weights.end());
+	return this->options.file_sizes[distribution(this->random)].first;
+}
+
+/** LoadClient::registerIdentity
+ * Registers a new user and sends its public key, like a client's first run.
+ *
+ * @param sock The connected socket.
+ * @param reader The connection's response reader.
+ * @param aes_key Set to the session's AES key.
+ * @throws std::runtime_error if the server refused a request.
+ */
+void LoadClient::registerIdentity(ClientSocket& sock, ResponseReader& reader, string& aes_key) {
+	std::unique_ptr<Identity> new_identity = std::make_unique<Identity>();
+	new_identity->name = "load-" + this->run_id + "-" + std::to_string(this->client_index) + "-" + std::to_string(this->registrations++);
+	new_identity->rsa_wrapper = this->rsa_wrapper.get();
+
+	RegisterRequest register_request(RequestHeader(NIL_UUID, Codes::REGISTRATION_CODE, PayloadSize::REGISTRATION_PAYLOAD_SIZE), RegistrationPayload(new_identity->name));
+	if (register_request.run(sock, reader) != SUCCESS) {
+		throw std::runtime_error("registration failed");
+	}
+	new_identity->uuid = register_request.getHeader().getUUID();
+
+	SendPublicKeyRequest public_key_request(RequestHeader(new_identity->uuid, Codes::SENDING_PUBLIC_KEY_CODE, PayloadSize::SENDING_PUBLIC_KEY_PAYLOAD_SIZE),
+		SendPublicKeyPayload(new_identity->name, new_identity->rsa_wrapper->getPublicKey()));
+	if (public_key_request.run(sock, reader) != SUCCESS) {
+		throw std::runtime_error("sending the public key failed");
+	}
+	aes_key = new_identity->rsa_wrapper->decrypt(public_key_request.getEncryptedAESKey());
+	this->identity = std::move(new_identity);
+}
+
+/** LoadClient::exchangeKey
+ * Gets the session's AES key: by reconnecting with the client's identity, or by registering one if it has none
+ * yet (or the server doesn't know it anymore).
+ */
+string LoadClient::exchangeKey(ClientSocket& sock, ResponseReader& reader) {
+	string aes_key;
+	if (!this->identity) {
+		registerIdentity(sock, reader, aes_key);
+		return aes_key;
+	}
+
+	ReconnectRequest reconnect_request(RequestHeader(this->identity->uuid, Codes::RECONNECTION_CODE, PayloadSize::RECONNECTION_PAYLOAD_SIZE),
+		ReconnectionPayload(this->identity->name));
+	int result = reconnect_request.run(sock, reader);
+	if (result == SUCCESS) {
+		return this->identity->rsa_wrapper->decrypt(reconnect_request.getPayload()->getEncryptedAESKey());
+	}
+	if (result == REGISTERED_NOT_RECONNECTED) {
+		// the server registered us again under a new uuid, it expects the public key next.
+		this->identity->uuid = reconnect_request.getHeader().getUUID();
+		SendPublicKeyRequest public_key_request(RequestHeader(this->identity->uuid, Codes::SENDING_PUBLIC_KEY_CODE, PayloadSize::SENDING_PUBLIC_KEY_PAYLOAD_SIZE),
+			SendPublicKeyPayload(this->identity->name, this->identity->rsa_wrapper->getPublicKey()));
+		if (public_key_request.run(sock, reader) == SUCCESS) {
+			return this->identity->rsa_wrapper->decrypt(public_key_request.getEncryptedAESKey());
+		}
+	}
+	throw std::runtime_error("reconnection failed");
+}
+
+/** LoadClient::upload
+ * Sends a file of the given size like run_client: encrypts it, sends its packets, checks the server's CRC
+ * and confirms it.
+ *
+ * @throws std::runtime_error if a request failed or the CRCs differ.
+ */
+void LoadClient::upload(ClientSocket& sock, ResponseReader& reader, const string& aes_key, size_t file_size) {
+	const char* content = this->file_pattern.data();
+	unsigned long cksum = memcrc(content, file_size);
+	AESWrapper aes_wrapper(reinterpret_cast<const unsigned char*>(aes_key.data()), static_cast<unsigned int>(aes_key.size()));
+	TransferString encrypted_content = aes_wrapper.encryptFile(content, static_cast<unsigned int>(file_size));
+	uint32_t content_size = static_cast<uint32_t>(encrypted_content.size());
+
+	SendFilePayload send_file_payload(content_size, static_cast<uint32_t>(file_size), static_cast<uint16_t>(TOTAL_PACKETS(content_size)), LOAD_FILE_NAME, encrypted_content);
+	SendFileRequest send_file_request(RequestHeader(this->identity->uuid, Codes::SENDING_FILE_CODE, PayloadSize::SEND_FILE_PAYLOAD_SIZE), std::move(send_file_payload));
+	if (send_file_request.run(sock, reader) != SUCCESS) {
+		throw std::runtime_error("sending the file failed");
+	}
+	if (send_file_request.getPayload()->getCksum() != cksum) {
+		throw std::runtime_error("the server's CRC doesn't match");
+	}
+
+	ValidCrcRequest valid_crc_request(RequestHeader(this->identity->uuid, Codes::VALID_CRC_CODE, PayloadSize::VALID_CRC_PAYLOAD_SIZE), ValidCrcPayload(LOAD_FILE_NAME));
+	if (valid_crc_request.run(sock, reader) != SUCCESS) {
+		throw std::runtime_error("confirming the CRC failed");
+	}
+}
+
+/** LoadClient::run
+ * Runs sessions back to back until the end of the run.
+ *
+ * This function performs the following steps:
+ * 1. Waits for its turn in the ramp up, so the clients don't all connect at once.
+ * 2. Picks the next session from the mix, connects, and runs it:
+ *    - register: registers a new user and sends its public key.
+ *    - reconnect: reconnects with the client's user (registering one first if it has none).
+ *    - upload: reconnects (or registers) and sends a file with a size drawn from the distribution.
+ * 3. Records the session's latency (connect to the last response) in its kind's histogram, or counts it as
+ *    failed. A failed session forgets the client's user, so the next one starts over with a registration.
+ *
+ * @param start When the run started.
+ * @param end When the run ends, sessions in progress are finished but not started.
+ */
+void LoadClient::run(LoadClock::time_point start, LoadClock::time_point end) {
+	double ramp_up_seconds = std::min(this->options.ramp_up_seconds, this->options.duration_seconds);
+	double ramp_up_offset = ramp_up_seconds * this->client_index / std::max<size_t>(1, this->options.clients);
+	std::this_thread::sleep_until(start + std::chrono::duration_cast<LoadClock::duration>(std::chrono::duration<double>(ramp_up_offset)));
+
+	while (LoadClock::now() < end) {
+		SessionKind kind = chooseSession();
+		size_t index = static_cast<size_t>(kind);
+		size_t file_size = kind == SessionKind::Upload ? chooseFileSize() : 0;
+
+		LoadClock::time_point session_start = LoadClock::now();
+		try {
+			ClientSocket sock(this->io_context);
+			boost::asio::connect(sock, this->endpoints);
+			sock.set_option(tcp::no_delay(true));
+			ResponseReader reader;
+
+			string aes_key;
+			if (kind == SessionKind::Register) {
+				registerIdentity(sock, reader, aes_key);
+			}
+			else {
+				aes_key = exchangeKey(sock, reader);
+			}
+			if (kind == SessionKind::Upload) {
+				upload(sock, reader, aes_key, file_size);
+				this->results.bytes_uploaded += file_size;
+			}
+			this->results.latency[index].record(std::chrono::duration_cast<std::chrono::microseconds>(LoadClock::now() - session_start).count());
+			this->results.completed[index]++;
+		}
+		catch (std::exception&) {
+			this->results.failed[index]++;
+			this->identity.reset();
+		}
+
+		if (this->options.think_ms > 0) {
+			std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(this->options.think_ms));
+		}
+	}
+}
+
+// Splits "a,b,c".
+static vector<string> splitList(const string& list, char separator) {
+	vector<string> items;
+	std::istringstream stream(list);
+	string item;
+	while (std::getline(stream, item, separator)) {
+		if (!item.empty()) {
+			items.push_back(item);
+		}
+	}
+	return items;
+}
+
+// Parses a size with an optional K/M suffix (binary units), "64K" is 65536.
+static double parseSize(const string& text) {
+	double size = std::strtod(text.c_str(), nullptr);
+	char suffix = text.empty() ? '\0' : static_cast<char>(toupper(text.back()));
+	return suffix == 'K' ? size * 1024 : suffix == 'M' ? size * 1024 * 1024 : size;
+}
+
+static bool parseOptions(int argc, char* argv[], LoadOptions& options) {
+	for (int i = 1; i < argc; i++) {
+		string option = argv[i];
+		if (i + 1 >= argc) {
+			std::cerr << "missing value for " << option << std::endl;
+			return false;
+		}
+		string value = argv[++i];
+		if (option == "--server") {
+			size_t colon = value.rfind(':');
+			if (colon == string::npos) {
+				std::cerr << "--server expects HOST:PORT" << std::endl;
+				return false;
+			}
+			options.host = value.substr(0, colon);
+			options.port = value.substr(colon + 1);
+		}
+		else if (option == "--stand-in") {
+			options.stand_in = value != "0";
+		}
+		else if (option == "--clients") {
+			options.clients = std::max<size_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+		}
+		else if (option == "--duration") {
+			options.duration_seconds = std::strtod(value.c_str(), nullptr);
+		}
+		else if (option == "--ramp-up") {
+			options.ramp_up_seconds = std::strtod(value.c_str(), nullptr);
+		}
+		else if (option == "--mix") {
+			std::fill(std::begin(options.mix), std::end(options.mix), 0);
+			for (const string& entry : splitList(value, ',')) {
+				size_t equals = entry.find('=');
+				const char* const* kind = std::find(std::begin(SESSION_KIND_NAMES), std::end(SESSION_KIND_NAMES), entry.substr(0, equals));
+				if (equals == string::npos || kind == std::end(SESSION_KIND_NAMES)) {
+					std::cerr << "--mix expects register=W,reconnect=W,upload=W" << std::endl;
+					return false;
+				}
+				options.mix[kind - std::begin(SESSION_KIND_NAMES)] = std::strtod(entry.c_str() + equals + 1, nullptr);
+			}
+		}
+		else if (option == "--file-sizes") {
+			vector<string> fields = splitList(value, ':');
+			if (fields.size() == 3 && fields[0] == "lognormal") {
+				options.lognormal_sizes = true;
+				options.lognormal_median = parseSize(fields[1]);
+				options.lognormal_sigma = std::strtod(fields[2].c_str(), nullptr);
+				continue;
+			}
+			options.file_sizes.clear();
+			for (const string& entry : splitList(value, ',')) {
+				vector<string> size_and_weight = splitList(entry, ':');
+				double weight = size_and_weight.size() > 1 ? std::strtod(size_and_weight[1].c_str(), nullptr) : 1;
+				options.file_sizes.push_back({ clampFileSize(parseSize(size_and_weight[0])), weight });
+			}
+		}
+		else if (option == "--key-pool") {
+			options.key_pool = std::max<size_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+		}
+		else if (option == "--think-ms") {
+			options.think_ms = std::strtod(value.c_str(), nullptr);
+		}
+		else if (option == "--output") {
+			options.output = value;
+		}
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			return false;
+		}
+	}
+	if (options.file_sizes.empty() || *std::max_element(std::begin(options.mix), std::end(options.mix)) <= 0) {
+		std::cerr << "the mix and the file sizes need at least one positive weight" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+static size_t largestFileSize(const LoadOptions& options) {
+	if (options.lognormal_sizes) {
+		return clampFileSize(1e18);
+	}
+	size_t largest = 0;
+	for (const auto& file_size : options.file_sizes) {
+		largest = std::max(largest, file_size.first);
+	}
+	return largest;
+}
+
+static string resultsToJson(const LoadOptions& options, const ClientResults& total, double elapsed_seconds) {
+	std::ostringstream json;
+	json << std::fixed << std::setprecision(3)
+		<< "{\"suite\":\"server_load\""
+		<< ",\"target\":\"" << (options.stand_in ? "stand-in" : options.host + ":" + options.port) << "\""
+		<< ",\"clients\":" << options.clients
+		<< ",\"duration_s\":" << elapsed_seconds
+		<< ",\"upload_mb_per_s\":" << total.bytes_uploaded / elapsed_seconds / 1e6
+		<< ",\"sessions\":{";
+	for (size_t i = 0; i < static_cast<size_t>(SessionKind::Count); i++) {
+		json << (i == 0 ? "" : ",") << "\"" << SESSION_KIND_NAMES[i] << "\":{"
+			<< "\"completed\":" << total.completed[i]
+			<< ",\"failed\":" << total.failed[i]
+			<< ",\"per_s\":" << total.completed[i] / elapsed_seconds
+			<< ",\"latency\":" << total.latency[i].toJson() << "}";
+	}
+	json << "}}\n";
+	return json.str();
+}
+
+int main(int argc, char* argv[])
+{
+	LoadOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		std::cerr << "usage: load_generator [--server HOST:PORT | --stand-in 1] [--clients N] [--duration SECONDS] [--ramp-up SECONDS]\n"
+			"                      [--mix register=1,reconnect=1,upload=8] [--file-sizes 4K:50,64K:30,1M:20 | lognormal:MEDIAN:SIGMA]\n"
+			"                      [--key-pool N] [--think-ms N] [--output FILE]" << std::endl;
+		return 1;
+	}
+
+	// a failing server makes every request log its failure, the logger keeps that off the clients' threads.
+	startLogger();
+	std::unique_ptr<LoopbackServer> stand_in;
+	if (options.stand_in) {
+		stand_in = std::make_unique<LoopbackServer>();
+		stand_in->start();
+		options.host = "127.0.0.1";
+		options.port = std::to_string(stand_in->port());
+	}
+
+	// RSA key generation would dominate the client side, so a small pool of key pairs is made up front. Every client loads one into a wrapper of its own.
+	vector<std::unique_ptr<RSAPrivateWrapper>> keys;
+	for (size_t i = 0; i < options.key_pool; i++) {
+		keys.push_back(std::make_unique<RSAPrivateWrapper>());
+	}
+	TransferString file_pattern(largestFileSize(options), '\0');
+	for (size_t i = 0; i < file_pattern.size(); i++) {
+		file_pattern[i] = static_cast<char>(i * 2654435761u >> 24);
+	}
+
+	string run_id = runId();
+	vector<std::unique_ptr<LoadClient>> clients;
+	for (size_t i = 0; i < options.clients; i++) {
+		clients.push_back(std::make_unique<LoadClient>(options, keys, file_pattern, i, run_id));
+	}
+
+	LoadClock::time_point start = LoadClock::now();
+	LoadClock::time_point end = start + std::chrono::duration_cast<LoadClock::duration>(std::chrono::duration<double>(options.duration_seconds));
+	vector<std::thread> threads;
+	for (std::unique_ptr<LoadClient>& client : clients) {
+		threads.emplace_back(&LoadClient::run, client.get(), start, end);
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	double elapsed_seconds = std::chrono::duration<double>(LoadClock::now() - start).count();
+
+	ClientResults total;
+	for (const std::unique_ptr<LoadClient>& client : clients) {
+		for (size_t i = 0; i < static_cast<size_t>(SessionKind::Count); i++) {
+			total.latency[i].merge(client->results.latency[i]);
+			total.completed[i] += client->results.completed[i];
+			total.failed[i] += client->results.failed[i];
+		}
+		total.bytes_uploaded += client->results.bytes_uploaded;
+	}
+	if (stand_in) {
+		stand_in->stop();
+	}
+	stopLogger();
+
+	string json = resultsToJson(options, total, elapsed_seconds);
+	if (options.output.empty()) {
+		std::cout << json;
+		return 0;
+	}
+	ofstream output(options.output, std::ios::trunc);
+	if (!output) {
+		std::cerr << "Couldn't write the results to " << options.output << std::endl;
+		return 1;
+	}
+	output << json;
+	return 0;
+}
@@ -0,0 +1,384 @@
+// End-to-end benchmark of the client's send path against the in-process stand-in server (loopback_server.hpp),
+// over loopback TCP. For every write engine (asio, io_uring) and file size it registers a client, then
+// reconnects and sends the file repeatedly, and reports MB/s, packets/s, client and server CPU per byte and
+// the peak RSS as one JSON document. Every scenario runs in a child process of its own, so each one's peak
+// RSS is its own. It needs nothing but loopback, so it runs offline.
+//
+// With any of the WAN options the client connects through a WanProxy (wan_proxy.hpp) that adds the round
+// trip time, jitter, bandwidth limit, losses and stalls of a wide area link, and the client's socket settings
+// are tuned for that link. Each run then also reports how many round trips its handshakes and transfer took.
+//
+// Usage: loopback_benchmark [--sizes 4K,64K,1M,16M,63M] [--repeats N] [--engines asio,io_uring] [--output FILE]
+//                           [--rtt-ms MS] [--jitter-ms MS] [--bandwidth-mbit MBIT] [--loss-percent P] [--stall-every-ms MS --stall-ms MS]
+
+#ifndef __linux__
+#error "the loopback benchmark forks a process per scenario and reads Linux thread CPU clocks"
+#endif
+
+#include "loopback_server.hpp"
+#include "wan_proxy.hpp"
+#include "../cksum.hpp"
+#include "../codes.hpp"
+#include "../payloads_sizes.hpp"
+#include "../requests.hpp"
+#include "../requests_payloads.hpp"
+#include "../response_reader.hpp"
+#include "../socket_policy.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using BenchmarkClock = std::chrono::steady_clock;
+
+constexpr const char* LOOPBACK_USERNAME = "loopback";
+constexpr const char* LOOPBACK_FILE_NAME = "loopback.bin";
+
+struct LoopbackOptions {
+	vector<size_t> sizes = { size_t(4) << 10, size_t(64) << 10, size_t(1) << 20, size_t(16) << 20, size_t(63) << 20 };
+	size_t repeats = 5;                   // measured transfers per scenario, after one warmup transfer
+	vector<string> engines = { "asio", "io_uring" };
+	string output;                        // the JSON file, stdout if empty
+	WanProfile wan;                       // the link between the client and the server, loopback if it's not enabled
+};
+
+struct Scenario {
+	string engine;
+	size_t file_size;
+};
+
+static uint64_t threadCpuNanoseconds() {
+	timespec now;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+	return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+static double secondsSince(BenchmarkClock::time_point start) {
+	return std::chrono::duration<double>(BenchmarkClock::now() - start).count();
+}
+
+static double median(vector<double> values) {
+	std::sort(values.begin(), values.end());
+	size_t middle = values.size() / 2;
+	return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+/** exchangeKey
+ * Runs the handshake of one connection, like run_client: registration and the public key the first time,
+ * reconnection afterwards.
+ *
+ * @param sock The connected socket.
+ * @param reader The connection's response reader.
+ * @param rsa_wrapper The client's RSA key pair.
+ * @param uuid The client's uuid, set by the registration.
+ * @param first Whether this is the client's first connection.
+ * @return The session's AES key.
+ * @throws std::runtime_error if the server refused a request.
+ */
+static string exchangeKey(ClientSocket& sock, ResponseReader& reader, RSAPrivateWrapper& rsa_wrapper, UUID& uuid, bool first) {
+	if (first) {
+		RegisterRequest register_request(RequestHeader(NIL_UUID, Codes::REGISTRATION_CODE, PayloadSize::REGISTRATION_PAYLOAD_SIZE), RegistrationPayload(LOOPBACK_USERNAME));
+		if (register_request.run(sock, reader) != SUCCESS) {
+			throw std::runtime_error("registration failed");
+		}
+		uuid = register_request.getHeader().getUUID();
+
+		SendPublicKeyRequest public_key_request(RequestHeader(uuid, Codes::SENDING_PUBLIC_KEY_CODE, PayloadSize::SENDING_PUBLIC_KEY_PAYLOAD_SIZE),
+			SendPublicKeyPayload(LOOPBACK_USERNAME, rsa_wrapper.getPublicKey()));
+		if (public_key_request.run(sock, reader) != SUCCESS) {
+			throw std::runtime_error("sending the public key failed");
+		}
+		return rsa_wrapper.decrypt(public_key_request.getEncryptedAESKey());
+	}
+
+	ReconnectRequest reconnect_request(RequestHeader(uuid, Codes::RECONNECTION_CODE, PayloadSize::RECONNECTION_PAYLOAD_SIZE), ReconnectionPayload(LOOPBACK_USERNAME));
+	if (reconnect_request.run(sock, reader) != SUCCESS) {
+		throw std::runtime_error("reconnection failed");
+	}
+	return rsa_wrapper.decrypt(reconnect_request.getPayload()->getEncryptedAESKey());
+}
+
+/** sendFile
+ * Sends a file the way run_client does once it has the AES key: computes its cksum, encrypts it, sends its
+ * packets, checks the server's CRC and confirms it.
+ *
+ * @throws std::runtime_error if a request failed or the CRCs differ.
+ */
+static void sendFile(ClientSocket& sock, ResponseReader& reader, const UUID& uuid, const string& aes_key, const TransferString& content) {
+	unsigned long cksum = memcrc(content.data(), content.size());
+	AESWrapper aes_wrapper(reinterpret_cast<const unsigned char*>(aes_key.data()), static_cast<unsigned int>(aes_key.size()));
+	TransferString encrypted_content = aes_wrapper.encryptFile(content.data(), static_cast<unsigned int>(content.size()));
+	uint32_t content_size = static_cast<uint32_t>(encrypted_content.size());
+
+	SendFilePayload send_file_payload(content_size, static_cast<uint32_t>(content.size()), static_cast<uint16_t>(TOTAL_PACKETS(content_size)), LOOPBACK_FILE_NAME, encrypted_content);
+	SendFileRequest send_file_request(RequestHeader(uuid, Codes::SENDING_FILE_CODE, PayloadSize::SEND_FILE_PAYLOAD_SIZE), std::move(send_file_payload));
+	if (send_file_request.run(sock, reader) != SUCCESS) {
+		throw std::runtime_error("sending the file failed");
+	}
+	if (send_file_request.getPayload()->getCksum() != cksum) {
+		throw std::runtime_error("the server's CRC doesn't match");
+	}
+
+	ValidCrcRequest valid_crc_request(RequestHeader(uuid, Codes::VALID_CRC_CODE, PayloadSize::VALID_CRC_PAYLOAD_SIZE), ValidCrcPayload(LOOPBACK_FILE_NAME));
+	if (valid_crc_request.run(sock, reader) != SUCCESS) {
+		throw std::runtime_error("confirming the CRC failed");
+	}
+}
+
+/** runScenario
+ * Runs one scenario against a fresh stand-in server and returns its results as a JSON object.
+ *
+ * This function performs the following steps:
+ * 1. Starts the server (and the WAN proxy in front of it, if the options emulate a link) and fills the file
+ *    with a deterministic pattern.
+ * 2. Connects, registers, and sends the file once as a warmup (not measured).
+ * 3. Reconnects and sends the file `repeats` times, timing the transfer (cksum, encryption, packets, the
+ *    wait for the CRC and its confirmation) and the client thread's CPU time of each one.
+ * 4. Stops the server, and reads its CPU time and the process's peak RSS.
+ * 5. Over an emulated link, divides the handshakes' and the transfer's times (without the time the link's
+ *    bandwidth needs for the bytes) by the round trip time: the round trips the protocol waited for.
+ *
+ * @param scenario The write engine and the file size.
+ * @param options The number of measured transfers and the emulated link.
+ * @return The scenario's results.
+ */
+static string runScenario(const Scenario& scenario, const LoopbackOptions& options) {
+	LoopbackServer server;
+	server.start();
+	tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), server.port());
+
+	SocketSettings settings;
+	settings.io_uring = scenario.engine == "io_uring";
+	std::unique_ptr<WanProxy> proxy;
+	if (options.wan.enabled()) {
+		proxy = std::make_unique<WanProxy>(options.wan, "127.0.0.1", std::to_string(server.port()));
+		proxy->start();
+		endpoint.port(proxy->port());
+		settings.rtt_ms = static_cast<uint32_t>(options.wan.rtt_ms);
+		settings.bandwidth_mbit = static_cast<uint32_t>(options.wan.bandwidth_mbit);
+	}
+	TransferString content(scenario.file_size, '\0');
+	for (size_t i = 0; i < content.size(); i++) {
+		content[i] = static_cast<char>(i * 2654435761u >> 24);
+	}
+
+	RSAPrivateWrapper rsa_wrapper;
+	UUID uuid = NIL_UUID;
+	vector<double> transfer_seconds, handshake_seconds, client_cpu_ns_per_byte;
+	double registration_seconds = 0;
+
+	for (size_t repeat = 0; repeat <= options.repeats; repeat++) {
+		boost::asio::io_context io_context;
+		ClientSocket sock(io_context);
+		sock.connect(endpoint);
+		applySocketSettings(sock, settings);
+		ResponseReader reader;
+
+		BenchmarkClock::time_point handshake_start = BenchmarkClock::now();
+		string aes_key = exchangeKey(sock, reader, rsa_wrapper, uuid, repeat == 0);
+		if (repeat == 0) {
+			registration_seconds = secondsSince(handshake_start);
+		}
+		else {
+			handshake_seconds.push_back(secondsSince(handshake_start));
+		}
+
+		uint64_t cpu_start = threadCpuNanoseconds();
+		BenchmarkClock::time_point transfer_start = BenchmarkClock::now();
+		sendFile(sock, reader, uuid, aes_key, content);
+		if (repeat > 0) {
+			transfer_seconds.push_back(secondsSince(transfer_start));
+			client_cpu_ns_per_byte.push_back(static_cast<double>(threadCpuNanoseconds() - cpu_start) / scenario.file_size);
+		}
+	}
+	if (proxy) {
+		proxy->stop();
+	}
+	server.stop();
+
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	double transfer = median(transfer_seconds);
+	size_t encrypted_size = scenario.file_size + 16 - scenario.file_size % 16; // PKCS#7 always adds padding
+	size_t packets = TOTAL_PACKETS(encrypted_size);
+
+	std::ostringstream result;
+	result << std::fixed << std::setprecision(3)
+		<< "{\"engine\":\"" << scenario.engine << "\""
+		<< ",\"file_size\":" << scenario.file_size
+		<< ",\"packets\":" << packets
+		<< ",\"repeats\":" << options.repeats
+		<< ",\"transfer_ms\":{\"median\":" << transfer * 1e3
+		<< ",\"min\":" << *std::min_element(transfer_seconds.begin(), transfer_seconds.end()) * 1e3
+		<< ",\"max\":" << *std::max_element(transfer_seconds.begin(), transfer_seconds.end()) * 1e3 << "}"
+		<< ",\"mb_per_s\":" << scenario.file_size / transfer / 1e6
+		<< ",\"packets_per_s\":" << packets / transfer
+		<< ",\"client_cpu_ns_per_byte\":" << median(client_cpu_ns_per_byte)
+		<< ",\"server_cpu_ns_per_byte\":" << static_cast<double>(server.cpuNanoseconds()) / (server.filesReceived() * scenario.file_size)
+		<< ",\"registration_ms\":" << registration_seconds * 1e3
+		<< ",\"reconnection_ms\":" << median(handshake_seconds) * 1e3
+		<< ",\"peak_rss_kib\":" << usage.ru_maxrss;
+	if (options.wan.rtt_ms > 0) {
+		// every packet is a request header and a send file payload, and the CRC confirmation follows them.
+		double wire_bytes = static_cast<double>(packets) * (REQUEST_HEADER_SIZE + PayloadSize::SEND_FILE_PAYLOAD_SIZE)
+			+ REQUEST_HEADER_SIZE + PayloadSize::VALID_CRC_PAYLOAD_SIZE;
+		double serialization_seconds = options.wan.bandwidth_mbit > 0 ? wire_bytes * 8 / (options.wan.bandwidth_mbit * 1e6) : 0;
+		double rtt_seconds = options.wan.rtt_ms / 1e3;
+		result << ",\"round_trips\":{\"registration\":" << registration_seconds / rtt_seconds
+			<< ",\"reconnection\":" << median(handshake_seconds) / rtt_seconds
+			<< ",\"transfer\":" << (transfer - serialization_seconds) / rtt_seconds
+			<< ",\"transfer_serialization_ms\":" << serialization_seconds * 1e3 << "}";
+	}
+	result << "}";
+	return result.str();
+}
+
+// Runs the scenario in a child process and returns the JSON object it wrote to the pipe.
+static string runScenarioInChild(const Scenario& scenario, const LoopbackOptions& options) {
+	int pipe_fds[2];
+	if (pipe(pipe_fds) != 0) {
+		throw std::runtime_error("pipe failed");
+	}
+	pid_t child = fork();
+	if (child < 0) {
+		throw std::runtime_error("fork failed");
+	}
+
+	if (child == 0) {
+		close(pipe_fds[0]);
+		string result;
+		try {
+			result = runScenario(scenario, options);
+		}
+		catch (std::exception& e) {
+			result = "{\"engine\":\"" + scenario.engine + "\",\"file_size\":" + std::to_string(scenario.file_size) + ",\"error\":\"" + e.what() + "\"}";
+		}
+		size_t written = 0;
+		while (written < result.size()) {
+			ssize_t count = write(pipe_fds[1], result.data() + written, result.size() - written);
+			if (count <= 0) {
+				break;
+			}
+			written += count;
+		}
+		_exit(0);
+	}
+
+	close(pipe_fds[1]);
+	string result;
+	char buffer[4096];
+	ssize_t count;
+	while ((count = read(pipe_fds[0], buffer, sizeof(buffer))) > 0) {
+		result.append(buffer, count);
+	}
+	close(pipe_fds[0]);
+	int status;
+	waitpid(child, &status, 0);
+	if (result.empty()) {
+		result = "{\"engine\":\"" + scenario.engine + "\",\"file_size\":" + std::to_string(scenario.file_size) + ",\"error\":\"the scenario crashed\"}";
+	}
+	return result;
+}
+
+// Splits "a,b,c".
+static vector<string> splitList(const string& list) {
+	vector<string> items;
+	std::istringstream stream(list);
+	string item;
+	while (std::getline(stream, item, ',')) {
+		if (!item.empty()) {
+			items.push_back(item);
+		}
+	}
+	return items;
+}
+
+// Parses a size with an optional K/M suffix (binary units), "64K" is 65536.
+static size_t parseSize(const string& text) {
+	size_t size = std::strtoull(text.c_str(), nullptr, 10);
+	char suffix = text.empty() ? '\0' : static_cast<char>(toupper(text.back()));
+	return suffix == 'K' ? size << 10 : suffix == 'M' ? size << 20 : size;
+}
+
+static bool parseOptions(int argc, char* argv[], LoopbackOptions& options) {
+	for (int i = 1; i < argc; i++) {
+		string option = argv[i];
+		if (i + 1 >= argc) {
+			std::cerr << "missing value for " << option << std::endl;
+			return false;
+		}
+		string value = argv[++i];
+		if (option == "--sizes") {
+			options.sizes.clear();
+			for (const string& size : splitList(value)) {
+				options.sizes.push_back(parseSize(size));
+			}
+		}
+		else if (option == "--repeats") {
+			options.repeats = std::max<size_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+		}
+		else if (option == "--engines") {
+			options.engines = splitList(value);
+		}
+		else if (option == "--output") {
+			options.output = value;
+		}
+		else if (parseWanOption(option, value, options.wan)) {
+			continue;
+		}
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			return false;
+		}
+	}
+
+	// total_packets is 16 bits: the encrypted file (at most 16 bytes longer) must fit in 65535 packets.
+	for (size_t size : options.sizes) {
+		size_t encrypted_size = size + 16;
+		if (size == 0 || TOTAL_PACKETS(encrypted_size) > UINT16_MAX) {
+			std::cerr << "file sizes must be between 1 byte and " << (UINT16_MAX * CONTENT_SIZE_PER_PACKET - 16) << " bytes" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	LoopbackOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		std::cerr << "usage: loopback_benchmark [--sizes 4K,64K,1M,16M,63M] [--repeats N] [--engines asio,io_uring] [--output FILE]\n"
+			"                          " << WAN_OPTIONS_USAGE << std::endl;
+		return 1;
+	}
+
+	std::ostringstream results;
+	results << "{\"suite\":\"client_loopback_benchmark\",\"wan\":" << options.wan.toJson() << ",\"runs\":[";
+	bool first = true;
+	for (const string& engine : options.engines) {
+		for (size_t size : options.sizes) {
+			string result = runScenarioInChild({ engine, size }, options);
+			std::cerr << result << std::endl;
+			results << (first ? "\n" : ",\n") << result;
+			first = false;
+		}
+	}
+	results << "\n]}\n";
+
+	if (options.output.empty()) {
+		std::cout << results.str();
+		return 0;
+	}
+	ofstream output(options.output, std::ios::trunc);
+	if (!output) {
+		std::cerr << "Couldn't write the results to " << options.output << std::endl;
+		return 1;
+	}
+	output << results.str();
+	return 0;
+}
@@ -0,0 +1,276 @@
+#include "loopback_server.hpp"
+#include "../cksum.hpp"
+#include "../codes.hpp"
+#include "../payloads_sizes.hpp"
+
+#include <boost/uuid/random_generator.hpp>
+
+#include <cstring>
+#include <ctime>
+
+constexpr uint8_t LOOPBACK_SERVER_VERSION = 3;
+constexpr size_t LOOPBACK_READ_BUFFER_SIZE = 1 << 20;
+
+// The fields of a send file payload: content size (4) | original size (4) | packet number (2) | total packets (2)
+// | file name (255) | content (1024).
+constexpr size_t SEND_FILE_TOTAL_PACKETS_OFFSET = 10;
+constexpr size_t SEND_FILE_FILE_NAME_OFFSET = 12;
+constexpr size_t SEND_FILE_CONTENT_OFFSET = SEND_FILE_FILE_NAME_OFFSET + MAX_FILE_NAME_LENGTH;
+
+static uint64_t threadCpuNanoseconds() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+	timespec now;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+	return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+#else
+	return 0;
+#endif
+}
+
+static uint32_t readLittleEndian32(const Byte* bytes) {
+	return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8)
+		| (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+static uint16_t readLittleEndian16(const Byte* bytes) {
+	return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+static void appendLittleEndian(Bytes& bytes, uint32_t value, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		bytes.push_back(static_cast<Byte>(value >> (8 * i)));
+	}
+}
+
+// A name field of a payload: MAX_USERNAME_LENGTH / MAX_FILE_NAME_LENGTH bytes, null padded.
+static string readName(const Byte* field, size_t length) {
+	const char* name = reinterpret_cast<const char*>(field);
+	return string(name, strnlen(name, length));
+}
+
+static void sendResponse(tcp::socket& sock, uint16_t code, const Bytes& payload) {
+	Bytes response;
+	response.reserve(RESPONSE_HEADER_SIZE + payload.size());
+	response.push_back(LOOPBACK_SERVER_VERSION);
+	appendLittleEndian(response, code, sizeof(code));
+	appendLittleEndian(response, static_cast<uint32_t>(payload.size()), sizeof(uint32_t));
+	response.insert(response.end(), payload.begin(), payload.end());
+	boost::asio::write(sock, boost::asio::buffer(response));
+}
+
+static Bytes uuidPayload(const UUID& uuid) {
+	return Bytes(uuid.begin(), uuid.end());
+}
+
+// Buffers the connection's reads, so the packets of a file cost one read for many of them.
+class LoopbackReader {
+private:
+	Bytes buffer;
+	size_t begin;
+	size_t end;
+
+public:
+	LoopbackReader() : buffer(LOOPBACK_READ_BUFFER_SIZE), begin(0), end(0) {}
+
+	// Returns the next size bytes of the connection, valid until the next call.
+	const Byte* next(tcp::socket& sock, size_t size) {
+		if (size > this->buffer.size()) {
+			throw std::length_error("request larger than the read buffer");
+		}
+		if (this->end - this->begin < size) {
+			std::memmove(this->buffer.data(), this->buffer.data() + this->begin, this->end - this->begin);
+			this->end -= this->begin;
+			this->begin = 0;
+			while (this->end < size) {
+				this->end += sock.read_some(boost::asio::buffer(this->buffer.data() + this->end, this->buffer.size() - this->end));
+			}
+		}
+		const Byte* bytes = this->buffer.data() + this->begin;
+		this->begin += size;
+		return bytes;
+	}
+};
+
+LoopbackServer::LoopbackServer(bool decrypt_files)
+	: acceptor(io_context, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)), decrypt_files(decrypt_files), stopping(false), cpu_nanoseconds(0), files_received(0) {
+}
+
+LoopbackServer::~LoopbackServer() {
+	stop();
+}
+
+uint16_t LoopbackServer::port() const {
+	return this->acceptor.local_endpoint().port();
+}
+
+void LoopbackServer::start() {
+	this->accept_thread = std::thread(&LoopbackServer::acceptConnections, this);
+}
+
+/** LoopbackServer::stop
+ * Stops accepting connections and waits for the connections in progress to end (their clients close them).
+ */
+void LoopbackServer::stop() {
+	if (this->accept_thread.joinable()) {
+		// a blocking accept doesn't return when the acceptor is closed from another thread, connect to wake it.
+		this->stopping = true;
+		boost::system::error_code error;
+		tcp::socket wakeup(this->io_context);
+		wakeup.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port()), error);
+		this->accept_thread.join();
+	}
+	if (this->acceptor.is_open()) {
+		boost::system::error_code error;
+		this->acceptor.close(error);
+	}
+	std::lock_guard<std::mutex> lock(this->connections_mutex);
+	for (std::thread& connection_thread : this->connection_threads) {
+		connection_thread.join();
+	}
+	this->connection_threads.clear();
+}
+
+uint64_t LoopbackServer::cpuNanoseconds() const {
+	return this->cpu_nanoseconds.load();
+}
+
+uint64_t LoopbackServer::filesReceived() const {
+	return this->files_received.load();
+}
+
+void LoopbackServer::acceptConnections() {
+	for (;;) {
+		tcp::socket sock(this->io_context);
+		boost::system::error_code error;
+		this->acceptor.accept(sock, error);
+		if (error || this->stopping) {
+			return;
+		}
+		sock.set_option(tcp::no_delay(true), error);
+
+		std::lock_guard<std::mutex> lock(this->connections_mutex);
+		this->connection_threads.emplace_back(&LoopbackServer::serveConnection, this, std::move(sock));
+	}
+}
+
+/** LoopbackServer::serveConnection
+ * Answers the requests of one connection until the client closes it.
+ *
+ * This function performs the following steps:
+ * 1. Reads the request header (uuid | version | code | payload size) and the payload.
+ * 2. Registration: adds the user and answers with a new uuid, or REGISTRATION_FAILED if the name is taken.
+ * 3. Public key: keeps it, and answers with a new AES key encrypted with it.
+ * 4. Reconnection: answers a known user with a new AES key encrypted with its public key, and registers an
+ *    unknown one (RECONNECTION_FAILED with the new uuid) so it sends its public key next.
+ * 5. Send file: collects the content of every packet and, after the last one, decrypts the file and answers
+ *    with its CRC (the CRC of the encrypted file when the server doesn't decrypt files).
+ * 6. Valid CRC / invalid CRC done: answers MESSAGE_RECEIVED. Sending the CRC again isn't answered.
+ * Any other request gets a general error and ends the connection.
+ * The CPU time of the thread is added to cpu_nanoseconds when the connection ends.
+ *
+ * @param sock The accepted connection.
+ */
+void LoopbackServer::serveConnection(tcp::socket sock) {
+	uint64_t cpu_start = threadCpuNanoseconds();
+	LoopbackReader reader;
+	User* user = nullptr;
+	TransferString encrypted_file;
+	uint16_t packets_received = 0;
+
+	try {
+		for (;;) {
+			const Byte* header = reader.next(sock, REQUEST_HEADER_SIZE);
+			UUID uuid;
+			std::copy(header, header + UUID_SIZE, uuid.begin());
+			uint16_t code = readLittleEndian16(header + UUID_SIZE + 1);
+			uint32_t payload_size = readLittleEndian32(header + UUID_SIZE + 3);
+			const Byte* payload = reader.next(sock, payload_size);
+
+			if (code == Codes::REGISTRATION_CODE && payload_size == PayloadSize::REGISTRATION_PAYLOAD_SIZE) {
+				string name = readName(payload, MAX_USERNAME_LENGTH);
+				std::lock_guard<std::mutex> lock(this->users_mutex);
+				if (this->users.count(name) != 0) {
+					sendResponse(sock, Codes::REGISTRATION_FAILED_CODE, {});
+					continue;
+				}
+				user = &this->users[name];
+				user->name = name;
+				user->uuid = boost::uuids::random_generator()();
+				sendResponse(sock, Codes::REGISTRATION_SUCCEEDED_CODE, uuidPayload(user->uuid));
+			}
+			else if ((code == Codes::SENDING_PUBLIC_KEY_CODE && payload_size == PayloadSize::SENDING_PUBLIC_KEY_PAYLOAD_SIZE)
+				|| (code == Codes::RECONNECTION_CODE && payload_size == PayloadSize::RECONNECTION_PAYLOAD_SIZE)) {
+				string name = readName(payload, MAX_USERNAME_LENGTH);
+				std::lock_guard<std::mutex> lock(this->users_mutex);
+				bool known = this->users.count(name) != 0;
+				user = &this->users[name];
+				if (!known) {
+					user->name = name;
+					user->uuid = boost::uuids::random_generator()();
+				}
+				if (code == Codes::SENDING_PUBLIC_KEY_CODE) {
+					user->public_key.assign(reinterpret_cast<const char*>(payload) + MAX_USERNAME_LENGTH, RSAPublicWrapper::KEYSIZE);
+				}
+				else if (!known || user->public_key.empty()) {
+					sendResponse(sock, Codes::RECONNECTION_FAILED_CODE, uuidPayload(user->uuid));
+					continue;
+				}
+
+				AESWrapper aes_key;
+				user->aes_key.assign(reinterpret_cast<const char*>(aes_key.getKey()), AESWrapper::DEFAULT_KEYLENGTH);
+				RSAPublicWrapper rsa_public(user->public_key);
+				Bytes response_payload = uuidPayload(user->uuid);
+				string encrypted_aes_key = rsa_public.encrypt(user->aes_key);
+				response_payload.insert(response_payload.end(), encrypted_aes_key.begin(), encrypted_aes_key.end());
+				sendResponse(sock, code == Codes::SENDING_PUBLIC_KEY_CODE ? Codes::PUBLIC_KEY_RECEIVED_CODE : Codes::RECONNECTION_SUCCEEDED_CODE, response_payload);
+			}
+			else if (code == Codes::SENDING_FILE_CODE && payload_size == PayloadSize::SEND_FILE_PAYLOAD_SIZE && user != nullptr && uuid == user->uuid) {
+				uint32_t content_size = readLittleEndian32(payload);
+				uint16_t total_packets = readLittleEndian16(payload + SEND_FILE_TOTAL_PACKETS_OFFSET);
+				if (packets_received == 0) {
+					encrypted_file.clear();
+					encrypted_file.reserve(static_cast<size_t>(total_packets) * CONTENT_SIZE_PER_PACKET);
+				}
+				const char* content = reinterpret_cast<const char*>(payload + SEND_FILE_CONTENT_OFFSET);
+				encrypted_file.append(content, CONTENT_SIZE_PER_PACKET);
+				if (++packets_received < total_packets) {
+					continue;
+				}
+
+				// the last packet is padded with zeros, only content_size bytes are the encrypted file.
+				packets_received = 0;
+				encrypted_file.resize(std::min<size_t>(content_size, encrypted_file.size()));
+				unsigned long cksum;
+				if (this->decrypt_files) {
+					AESWrapper aes(reinterpret_cast<const unsigned char*>(user->aes_key.data()), static_cast<unsigned int>(user->aes_key.size()));
+					string decrypted = aes.decrypt(encrypted_file.data(), static_cast<unsigned int>(encrypted_file.size()));
+					cksum = memcrc(decrypted.data(), decrypted.size());
+				}
+				else {
+					cksum = memcrc(encrypted_file.data(), encrypted_file.size());
+				}
+				this->files_received++;
+
+				Bytes response_payload = uuidPayload(user->uuid);
+				appendLittleEndian(response_payload, content_size, sizeof(content_size));
+				response_payload.insert(response_payload.end(), payload + SEND_FILE_FILE_NAME_OFFSET, payload + SEND_FILE_CONTENT_OFFSET);
+				appendLittleEndian(response_payload, static_cast<uint32_t>(cksum), sizeof(uint32_t));
+				sendResponse(sock, Codes::FILE_RECEIVED_CRC_CODE, response_payload);
+			}
+			else if ((code == Codes::VALID_CRC_CODE || code == Codes::INVALID_CRC_DONE_CODE) && user != nullptr) {
+				sendResponse(sock, Codes::MESSAGE_RECEIVED_CODE, uuidPayload(user->uuid));
+			}
+			else if (code == Codes::SENDING_CRC_AGAIN_CODE) {
+				continue;
+			}
+			else {
+				sendResponse(sock, Codes::GENERAL_ERROR_CODE, {});
+				break;
+			}
+		}
+	}
+	catch (std::exception&) {
+		// the client closed the connection (or broke the protocol), either way it's over.
+	}
+	this->cpu_nanoseconds += threadCpuNanoseconds() - cpu_start;
+}
@@ -0,0 +1,60 @@
+#ifndef LOOPBACK_SERVER_HPP
+#define LOOPBACK_SERVER_HPP
+#include "../utils.hpp"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// A stand-in for the server, for benchmarks: it runs in the benchmark's process and speaks protocol version 3
+// over loopback TCP, so the client's send path can be measured without the Python server or a network.
+//
+// It handles registration, the RSA public key, reconnection, the file's packets (answered with the CRC of the
+// decrypted file, like the real server) and the CRC confirmations. Anything else - resumption, tickets,
+// X25519 - is answered with a general error and the connection is closed.
+//
+// A server built with decrypt_files = false answers with the CRC of the file as it was received, without
+// decrypting it: replayed sessions (see wire_replay.cpp) are encrypted with an AES key it never sent.
+class LoopbackServer {
+private:
+	struct User {
+		string name;
+		UUID uuid;
+		string public_key;  // the RSA public key the client sent, empty until it did
+		string aes_key;
+	};
+
+	boost::asio::io_context io_context;
+	tcp::acceptor acceptor;
+	std::thread accept_thread;
+	bool decrypt_files;
+	std::atomic<bool> stopping;
+	std::mutex connections_mutex;
+	vector<std::thread> connection_threads;
+
+	std::mutex users_mutex;
+	std::map<string, User> users; // by name
+
+	std::atomic<uint64_t> cpu_nanoseconds;
+	std::atomic<uint64_t> files_received;
+
+	void acceptConnections();
+	void serveConnection(tcp::socket sock);
+
+public:
+	explicit LoopbackServer(bool decrypt_files = true);
+	~LoopbackServer();
+
+	LoopbackServer(const LoopbackServer&) = delete;
+	LoopbackServer& operator=(const LoopbackServer&) = delete;
+
+	uint16_t port() const;
+	void start();
+	void stop();
+
+	uint64_t cpuNanoseconds() const;   // CPU time of the connection threads so far (0 where it can't be measured)
+	uint64_t filesReceived() const;
+};
+
+#endif
@@ -0,0 +1,379 @@
+// Microbenchmarks of the client's hot kernels: the CRC, AES, Base64 and RSA wrappers, packing requests and
+// parsing responses. Every benchmark is timed over repeated samples and the results are written as one JSON
+// document, so runs of two releases can be compared.
+//
+// Usage: micro_benchmarks [--filter TEXT] [--samples N] [--min-sample-ms N] [--max-size BYTES] [--output FILE]
+
+#include "../AESWrapper.hpp"
+#include "../Base64Wrapper.hpp"
+#include "../RSAWrapper.hpp"
+#include "../cksum.hpp"
+#include "../request.hpp"
+#include "../requests.hpp"
+#include "../requests_payloads.hpp"
+#include "../utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+
+using BenchmarkClock = std::chrono::steady_clock;
+
+// What a benchmark's body returns is folded into this, so the compiler can't drop the work as unused.
+static volatile uint64_t benchmark_sink = 0;
+
+struct BenchmarkOptions {
+	string filter;                         // run only the benchmarks whose name contains it
+	size_t samples = 20;                   // timed samples per benchmark, after one warmup sample
+	double min_sample_ms = 20;             // every sample repeats the body until it ran at least this long
+	double max_benchmark_seconds = 10;     // fewer samples (but at least MIN_SAMPLES) for the slowest benchmarks
+	size_t max_size = size_t(1) << 30;     // memcrc sizes above this are skipped
+	string output;                         // the JSON file, stdout if empty
+};
+
+constexpr size_t MIN_SAMPLES = 5;
+
+struct Benchmark {
+	string name;
+	size_t bytes;                          // bytes processed by one iteration, 0 when throughput means nothing
+	std::function<uint64_t()> body;
+};
+
+struct BenchmarkResult {
+	string name;
+	size_t bytes;
+	size_t iterations;                     // iterations per sample
+	vector<double> sample_ns;              // nanoseconds per iteration of every sample, sorted
+	double median_ns;
+	double mean_ns;
+	double stddev_ns;
+	double mad_ns;                         // median absolute deviation, scaled to estimate the stddev
+	double ci95_low_ns;
+	double ci95_high_ns;
+	size_t outliers;                       // samples further than 3 scaled MADs from the median
+};
+
+// Two sided 95% critical values of Student's t distribution, for 1 to 30 degrees of freedom.
+static const double T_CRITICAL_95[] = {
+	12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+	2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+	2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+};
+
+static double tCritical95(size_t degrees_of_freedom) {
+	size_t table_size = sizeof(T_CRITICAL_95) / sizeof(T_CRITICAL_95[0]);
+	return degrees_of_freedom <= table_size ? T_CRITICAL_95[degrees_of_freedom - 1] : 1.960;
+}
+
+static double median(const vector<double>& sorted) {
+	size_t middle = sorted.size() / 2;
+	return sorted.size() % 2 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2;
+}
+
+static double timeIterations(const Benchmark& benchmark, size_t iterations) {
+	uint64_t folded = 0;
+	BenchmarkClock::time_point start = BenchmarkClock::now();
+	for (size_t i = 0; i < iterations; i++) {
+		folded += benchmark.body();
+	}
+	double elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(BenchmarkClock::now() - start).count());
+	benchmark_sink = benchmark_sink + folded;
+	return elapsed_ns;
+}
+
+/** runBenchmark
+ * Times a benchmark and summarizes its samples.
+ *
+ * This function performs the following steps:
+ * 1. Runs the body once as a warmup, and doubles the iterations per sample until a sample lasts at least
+ *    min_sample_ms, so the clock's resolution doesn't matter.
+ * 2. Takes the samples, fewer of them if they would run past max_benchmark_seconds (but at least MIN_SAMPLES).
+ * 3. Computes the median and its MAD, which outliers (a preempted sample, a page fault) barely move, and
+ *    the mean with its 95% confidence interval.
+ *
+ * @param benchmark The benchmark to run.
+ * @param options The sampling options.
+ * @return The benchmark's result, times are per iteration.
+ */
+static BenchmarkResult runBenchmark(const Benchmark& benchmark, const BenchmarkOptions& options) {
+	double min_sample_ns = options.min_sample_ms * 1e6;
+	size_t iterations = 1;
+	double elapsed_ns = timeIterations(benchmark, iterations);
+	while (elapsed_ns < min_sample_ns) {
+		iterations *= 2;
+		elapsed_ns = timeIterations(benchmark, iterations);
+	}
+
+	size_t samples = options.samples;
+	size_t affordable = static_cast<size_t>(options.max_benchmark_seconds * 1e9 / elapsed_ns);
+	samples = std::max(MIN_SAMPLES, std::min(samples, affordable));
+
+	BenchmarkResult result = {};
+	result.name = benchmark.name;
+	result.bytes = benchmark.bytes;
+	result.iterations = iterations;
+	for (size_t i = 0; i < samples; i++) {
+		result.sample_ns.push_back(timeIterations(benchmark, iterations) / iterations);
+	}
+	std::sort(result.sample_ns.begin(), result.sample_ns.end());
+
+	result.median_ns = median(result.sample_ns);
+	vector<double> deviations;
+	double sum = 0;
+	for (double sample : result.sample_ns) {
+		deviations.push_back(std::fabs(sample - result.median_ns));
+		sum += sample;
+	}
+	std::sort(deviations.begin(), deviations.end());
+	result.mad_ns = 1.4826 * median(deviations);
+	result.mean_ns = sum / samples;
+
+	double squares = 0;
+	for (double sample : result.sample_ns) {
+		squares += (sample - result.mean_ns) * (sample - result.mean_ns);
+	}
+	result.stddev_ns = std::sqrt(squares / (samples - 1));
+	double margin = tCritical95(samples - 1) * result.stddev_ns / std::sqrt(static_cast<double>(samples));
+	result.ci95_low_ns = result.mean_ns - margin;
+	result.ci95_high_ns = result.mean_ns + margin;
+
+	for (double deviation : deviations) {
+		if (deviation > 3 * result.mad_ns) {
+			result.outliers++;
+		}
+	}
+	return result;
+}
+
+static string sizeName(size_t bytes) {
+	if (bytes >= (size_t(1) << 30) && bytes % (size_t(1) << 30) == 0) {
+		return std::to_string(bytes >> 30) + "GiB";
+	}
+	if (bytes >= (size_t(1) << 20) && bytes % (size_t(1) << 20) == 0) {
+		return std::to_string(bytes >> 20) + "MiB";
+	}
+	if (bytes >= 1024 && bytes % 1024 == 0) {
+		return std::to_string(bytes >> 10) + "KiB";
+	}
+	return std::to_string(bytes) + "B";
+}
+
+// Deterministic filler, so every run benchmarks the same bytes.
+static void fillPattern(char* data, size_t size) {
+	uint32_t state = 0x9e3779b9;
+	for (size_t i = 0; i < size; i++) {
+		state = state * 1664525 + 1013904223;
+		data[i] = static_cast<char>(state >> 24);
+	}
+}
+
+/** makeBenchmarks
+ * Builds the benchmarks and the inputs they share. The inputs are created once, outside the timed bodies.
+ *
+ * @param options The options, max_size caps the memcrc sizes (and the memory the suite allocates).
+ * @return The benchmarks, in the order they run.
+ */
+static vector<Benchmark> makeBenchmarks(const BenchmarkOptions& options) {
+	vector<Benchmark> benchmarks;
+
+	// memcrc from a single packet's worth to 1 GiB, the sizes grow by 16.
+	size_t largest_crc_size = 0;
+	for (size_t size = 64; size <= (size_t(1) << 30); size *= 16) {
+		if (size <= options.max_size) {
+			largest_crc_size = size;
+		}
+	}
+	auto crc_input = std::make_shared<TransferString>(std::max(largest_crc_size, size_t(1) << 24), '\0');
+	fillPattern(&(*crc_input)[0], crc_input->size());
+	for (size_t size = 64; size <= largest_crc_size; size *= 16) {
+		benchmarks.push_back({ "memcrc/" + sizeName(size), size, [crc_input, size]() {
+			return static_cast<uint64_t>(memcrc(crc_input->data(), size));
+		} });
+	}
+
+	// AES-CBC with the session key size, over a packet, a typical file and the early data limit.
+	unsigned char key[AESWrapper::DEFAULT_KEYLENGTH];
+	AESWrapper::GenerateKey(key, sizeof(key));
+	auto aes = std::make_shared<AESWrapper>(key, static_cast<unsigned int>(sizeof(key)));
+	for (size_t size : { size_t(1024), size_t(64) << 10, size_t(1) << 20, size_t(16) << 20 }) {
+		auto cipher = std::make_shared<string>(aes->encrypt(crc_input->data(), static_cast<unsigned int>(size)));
+		benchmarks.push_back({ "aes_encrypt/" + sizeName(size), size, [aes, crc_input, size]() {
+			return static_cast<uint64_t>(aes->encrypt(crc_input->data(), static_cast<unsigned int>(size)).size());
+		} });
+		benchmarks.push_back({ "aes_encrypt_file/" + sizeName(size), size, [aes, crc_input, size]() {
+			return static_cast<uint64_t>(aes->encryptFile(crc_input->data(), static_cast<unsigned int>(size)).size());
+		} });
+		benchmarks.push_back({ "aes_encrypt_and_cksum/" + sizeName(size), size, [aes, crc_input, size]() {
+			unsigned long cksum;
+			return static_cast<uint64_t>(aes->encryptAndChecksum(crc_input->data(), static_cast<unsigned int>(size), cksum).size()) + cksum;
+		} });
+		benchmarks.push_back({ "aes_decrypt/" + sizeName(size), size, [aes, cipher]() {
+			return static_cast<uint64_t>(aes->decrypt(cipher->data(), static_cast<unsigned int>(cipher->size())).size());
+		} });
+	}
+
+	// Packing: a request header, one SendFile packet's payload and every packet of a 1 MiB file.
+	UUID uuid = getUUIDFromString("0123456789abcdef0123456789abcdef");
+	auto header = std::make_shared<RequestHeader>(uuid, Codes::SENDING_FILE_CODE, PayloadSize::SEND_FILE_PAYLOAD_SIZE);
+	benchmarks.push_back({ "pack_header", REQUEST_HEADER_SIZE, [header]() {
+		return static_cast<uint64_t>(header->pack_header().size());
+	} });
+
+	size_t file_size = size_t(1) << 20;
+	auto file_content = std::make_shared<TransferString>(crc_input->data(), file_size); // the payloads refer to it
+	uint16_t total_packets = static_cast<uint16_t>(TOTAL_PACKETS(file_size));
+	auto send_file_payload = std::make_shared<SendFilePayload>(static_cast<uint32_t>(file_size), static_cast<uint32_t>(file_size), total_packets, "benchmark.bin", *file_content);
+	auto packet_content = std::make_shared<Bytes>(crc_input->data(), crc_input->data() + CONTENT_SIZE_PER_PACKET);
+	benchmarks.push_back({ "send_file_pack_payload", PayloadSize::SEND_FILE_PAYLOAD_SIZE, [file_content, send_file_payload, packet_content]() {
+		return static_cast<uint64_t>(send_file_payload->pack_payload(*packet_content, 7).size());
+	} });
+	auto send_file_request = std::make_shared<SendFileRequest>(*header, SendFilePayload(*send_file_payload));
+	benchmarks.push_back({ "send_file_pack_request/" + sizeName(file_size), file_size, [file_content, send_file_request]() {
+		return static_cast<uint64_t>(send_file_request->pack_request().size());
+	} });
+
+	// Parsing a FILE_RECEIVED_CRC response: header fields, content size, file name and cksum.
+	auto response = std::make_shared<Bytes>(RESPONSE_HEADER_SIZE + PayloadSize::FILE_RECEIVED_CRC_PAYLOAD_SIZE, 0);
+	fillPattern(reinterpret_cast<char*>(response->data()), response->size());
+	(*response)[RESPONSE_HEADER_SIZE + 16 + 4 + 12] = 0; // terminates the file name
+	benchmarks.push_back({ "extract_response_header", RESPONSE_HEADER_SIZE, [response]() {
+		const Byte* header_bytes = response->data();
+		return static_cast<uint64_t>(extractCodeFromResponseHeader(header_bytes)) + extractPayloadSizeFromResponseHeader(header_bytes);
+	} });
+	benchmarks.push_back({ "extract_file_received_crc", PayloadSize::FILE_RECEIVED_CRC_PAYLOAD_SIZE, [response]() {
+		const Byte* payload = response->data() + RESPONSE_HEADER_SIZE;
+		return static_cast<uint64_t>(extractPayloadContentSize(payload))
+			+ extractSendFileResponseFileName(payload, PayloadSize::FILE_RECEIVED_CRC_PAYLOAD_SIZE).size()
+			+ extractSendFileResponseCksum(payload);
+	} });
+
+	// Base64 of an RSA public key (what me.info holds) and of a larger blob.
+	for (size_t size : { size_t(RSAPublicWrapper::KEYSIZE), size_t(64) << 10 }) {
+		auto plain = std::make_shared<string>(crc_input->data(), size);
+		auto encoded = std::make_shared<string>(Base64Wrapper::encode(*plain));
+		benchmarks.push_back({ "base64_encode/" + sizeName(size), size, [plain]() {
+			return static_cast<uint64_t>(Base64Wrapper::encode(*plain).size());
+		} });
+		benchmarks.push_back({ "base64_decode/" + sizeName(size), size, [encoded]() {
+			return static_cast<uint64_t>(Base64Wrapper::decode(*encoded).size());
+		} });
+	}
+
+	// RSA: generating the client's key pair, and decrypting the AES key the server sends.
+	benchmarks.push_back({ "rsa_generate_key", 0, []() {
+		RSAPrivateWrapper rsa_private;
+		return static_cast<uint64_t>(rsa_private.getPublicKey().size());
+	} });
+	auto rsa_private = std::make_shared<RSAPrivateWrapper>();
+	RSAPublicWrapper rsa_public(rsa_private->getPublicKey());
+	auto encrypted_key = std::make_shared<string>(rsa_public.encrypt(reinterpret_cast<const char*>(key), static_cast<unsigned int>(sizeof(key))));
+	benchmarks.push_back({ "rsa_decrypt_aes_key", sizeof(key), [rsa_private, encrypted_key]() {
+		return static_cast<uint64_t>(rsa_private->decrypt(*encrypted_key).size());
+	} });
+
+	return benchmarks;
+}
+
+static void writeResults(std::ostream& output, const vector<BenchmarkResult>& results, const BenchmarkOptions& options) {
+	long long started_at = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	output << std::fixed << std::setprecision(3);
+	output << "{\"suite\":\"client_micro_benchmarks\""
+		<< ",\"started_at_unix_ms\":" << started_at
+#ifdef NDEBUG
+		<< ",\"build\":\"release\""
+#else
+		<< ",\"build\":\"debug\""
+#endif
+		<< ",\"samples\":" << options.samples
+		<< ",\"min_sample_ms\":" << options.min_sample_ms
+		<< ",\"benchmarks\":[";
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchmarkResult& result = results[i];
+		output << (i == 0 ? "\n" : ",\n")
+			<< "{\"name\":\"" << result.name << "\""
+			<< ",\"bytes\":" << result.bytes
+			<< ",\"iterations\":" << result.iterations
+			<< ",\"samples\":" << result.sample_ns.size()
+			<< ",\"median_ns\":" << result.median_ns
+			<< ",\"mad_ns\":" << result.mad_ns
+			<< ",\"mean_ns\":" << result.mean_ns
+			<< ",\"stddev_ns\":" << result.stddev_ns
+			<< ",\"ci95_ns\":[" << result.ci95_low_ns << "," << result.ci95_high_ns << "]"
+			<< ",\"min_ns\":" << result.sample_ns.front()
+			<< ",\"max_ns\":" << result.sample_ns.back()
+			<< ",\"outliers\":" << result.outliers;
+		if (result.bytes > 0) {
+			output << ",\"mb_per_s\":" << result.bytes / result.median_ns * 1e3; // bytes per ns * 1e9 / 1e6
+		}
+		output << "}";
+	}
+	output << "\n]}\n";
+}
+
+static bool parseOptions(int argc, char* argv[], BenchmarkOptions& options) {
+	for (int i = 1; i < argc; i++) {
+		string option = argv[i];
+		if (i + 1 >= argc) {
+			std::cerr << "missing value for " << option << std::endl;
+			return false;
+		}
+		string value = argv[++i];
+		if (option == "--filter") {
+			options.filter = value;
+		}
+		else if (option == "--samples") {
+			options.samples = std::max<size_t>(MIN_SAMPLES, std::strtoull(value.c_str(), nullptr, 10));
+		}
+		else if (option == "--min-sample-ms") {
+			options.min_sample_ms = std::strtod(value.c_str(), nullptr);
+		}
+		else if (option == "--max-size") {
+			options.max_size = std::strtoull(value.c_str(), nullptr, 10);
+		}
+		else if (option == "--output") {
+			options.output = value;
+		}
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		std::cerr << "usage: micro_benchmarks [--filter TEXT] [--samples N] [--min-sample-ms N] [--max-size BYTES] [--output FILE]" << std::endl;
+		return 1;
+	}
+
+	vector<BenchmarkResult> results;
+	for (const Benchmark& benchmark : makeBenchmarks(options)) {
+		if (benchmark.name.find(options.filter) == string::npos) {
+			continue;
+		}
+		BenchmarkResult result = runBenchmark(benchmark, options);
+		std::cerr << std::left << std::setw(32) << result.name << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(14) << result.median_ns << " ns  +/- " << std::setw(10) << result.mad_ns << std::endl;
+		results.push_back(std::move(result));
+	}
+
+	if (options.output.empty()) {
+		writeResults(std::cout, results, options);
+		return 0;
+	}
+	ofstream output(options.output, std::ios::trunc);
+	if (!output) {
+		std::cerr << "Couldn't write the results to " << options.output << std::endl;
+		return 1;
+	}
+	writeResults(output, results, options);
+	return 0;
+}
@@ -0,0 +1,284 @@
+#include "wan_proxy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+constexpr size_t WAN_READ_SIZE = 64 << 10;
+constexpr size_t WAN_SLICE_SIZE = 16 << 10;             // a paced write sends at most this much at once
+constexpr size_t WAN_SEGMENT_SIZE = 1448;               // a TCP segment's payload on a 1500 byte MTU
+constexpr size_t WAN_UNLIMITED_BUFFER_SIZE = 4 << 20;   // what a direction holds when the bandwidth isn't limited
+constexpr size_t WAN_MIN_BUFFER_SIZE = 256 << 10;
+constexpr auto WAN_MIN_RETRANSMISSION_TIMEOUT = std::chrono::milliseconds(200); // Linux's TCP_RTO_MIN
+
+bool WanProfile::enabled() const {
+	return this->rtt_ms > 0 || this->jitter_ms > 0 || this->bandwidth_mbit > 0 || this->loss_percent > 0
+		|| (this->stall_every_ms > 0 && this->stall_ms > 0);
+}
+
+size_t WanProfile::bufferBytes() const {
+	if (this->bandwidth_mbit <= 0) {
+		return WAN_UNLIMITED_BUFFER_SIZE;
+	}
+	double bytes_per_ms = this->bandwidth_mbit * 1e6 / 8 / 1e3;
+	return std::max(WAN_MIN_BUFFER_SIZE, static_cast<size_t>(bytes_per_ms * (this->rtt_ms + 2 * this->jitter_ms)));
+}
+
+std::chrono::microseconds WanProfile::retransmissionTimeout() const {
+	// like TCP's: the smoothed round trip time plus four times its variation, at least TCP_RTO_MIN.
+	auto timeout = std::chrono::microseconds(static_cast<int64_t>((this->rtt_ms + 4 * this->jitter_ms) * 1e3));
+	return std::max<std::chrono::microseconds>(timeout, WAN_MIN_RETRANSMISSION_TIMEOUT);
+}
+
+string WanProfile::toJson() const {
+	std::ostringstream json;
+	json << std::fixed << std::setprecision(3)
+		<< "{\"rtt_ms\":" << this->rtt_ms
+		<< ",\"jitter_ms\":" << this->jitter_ms
+		<< ",\"bandwidth_mbit\":" << this->bandwidth_mbit
+		<< ",\"loss_percent\":" << this->loss_percent
+		<< ",\"stall_every_ms\":" << this->stall_every_ms
+		<< ",\"stall_ms\":" << this->stall_ms
+		<< "}";
+	return json.str();
+}
+
+bool parseWanOption(const string& option, const string& value, WanProfile& profile) {
+	double number = std::max(0.0, std::strtod(value.c_str(), nullptr));
+	if (option == "--rtt-ms") {
+		profile.rtt_ms = number;
+	}
+	else if (option == "--jitter-ms") {
+		profile.jitter_ms = number;
+	}
+	else if (option == "--bandwidth-mbit") {
+		profile.bandwidth_mbit = number;
+	}
+	else if (option == "--loss-percent") {
+		profile.loss_percent = std::min(number, 100.0);
+	}
+	else if (option == "--stall-every-ms") {
+		profile.stall_every_ms = number;
+	}
+	else if (option == "--stall-ms") {
+		profile.stall_ms = number;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+WanProxy::Connection::Connection(boost::asio::io_context& io_context)
+	: client(io_context), server(io_context) {
+}
+
+WanProxy::WanProxy(const WanProfile& profile, const string& target_host, const string& target_port, uint16_t listen_port)
+	: profile(profile), epoch(Clock::now()), acceptor(io_context, tcp::endpoint(boost::asio::ip::address_v4::loopback(), listen_port)), stopping(false) {
+	this->target = tcp::resolver(this->io_context).resolve(target_host, target_port);
+}
+
+WanProxy::~WanProxy() {
+	stop();
+}
+
+uint16_t WanProxy::port() const {
+	return this->acceptor.local_endpoint().port();
+}
+
+void WanProxy::start() {
+	this->accept_thread = std::thread(&WanProxy::acceptConnections, this);
+}
+
+/** WanProxy::stop
+ * Stops accepting connections and waits for the connections in progress to end (their peers close them).
+ */
+void WanProxy::stop() {
+	if (this->accept_thread.joinable()) {
+		// a blocking accept doesn't return when the acceptor is closed from another thread, connect to wake it.
+		this->stopping = true;
+		boost::system::error_code error;
+		tcp::socket wakeup(this->io_context);
+		wakeup.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port()), error);
+		this->accept_thread.join();
+	}
+	if (this->acceptor.is_open()) {
+		boost::system::error_code error;
+		this->acceptor.close(error);
+	}
+	std::lock_guard<std::mutex> lock(this->connections_mutex);
+	for (std::unique_ptr<Connection>& connection : this->connections) {
+		for (std::thread& thread : connection->threads) {
+			thread.join();
+		}
+	}
+	this->connections.clear();
+}
+
+/** WanProxy::acceptConnections
+ * Accepts connections until the proxy stops, and connects each one to the target.
+ *
+ * A connection the target refuses is closed right away. Otherwise each direction gets a thread that receives
+ * from one side and a thread that delivers to the other.
+ */
+void WanProxy::acceptConnections() {
+	for (uint64_t index = 0;; index++) {
+		std::unique_ptr<Connection> connection = std::make_unique<Connection>(this->io_context);
+		boost::system::error_code error;
+		this->acceptor.accept(connection->client, error);
+		if (error || this->stopping) {
+			return;
+		}
+		boost::asio::connect(connection->server, this->target, error);
+		if (error) {
+			continue;
+		}
+		connection->client.set_option(tcp::no_delay(true), error);
+		connection->server.set_option(tcp::no_delay(true), error);
+
+		// every connection gets its own seeds, so a run's losses and jitter are the same every time.
+		connection->upstream.random.seed(2 * index + 1);
+		connection->downstream.random.seed(2 * index + 2);
+		Connection& relayed = *connection;
+		relayed.threads[0] = std::thread(&WanProxy::receive, this, std::ref(relayed.client), std::ref(relayed.upstream));
+		relayed.threads[1] = std::thread(&WanProxy::deliver, this, std::ref(relayed.upstream), std::ref(relayed.server), std::ref(relayed.client));
+		relayed.threads[2] = std::thread(&WanProxy::receive, this, std::ref(relayed.server), std::ref(relayed.downstream));
+		relayed.threads[3] = std::thread(&WanProxy::deliver, this, std::ref(relayed.downstream), std::ref(relayed.client), std::ref(relayed.server));
+
+		std::lock_guard<std::mutex> lock(this->connections_mutex);
+		this->connections.push_back(std::move(connection));
+	}
+}
+
+/** WanProxy::receive
+ * Reads one direction of a connection into its pipe, and decides when each chunk may be delivered.
+ *
+ * This function performs the following steps:
+ * 1. Waits until the pipe holds less than the link's buffer, so the sender blocks once the link is full.
+ * 2. Reads whatever the sender sent, up to WAN_READ_SIZE.
+ * 3. Releases the chunk after half the round trip, give or take the jitter - but never before the chunk
+ *    ahead of it, a TCP stream arrives in order.
+ * 4. Holds it back by a retransmission timeout if one of its segments is lost, and every chunk after it with
+ *    it (head of line blocking).
+ * When the sender closes its side (or the connection fails), marks the pipe as ended.
+ *
+ * @param from The socket to read from.
+ * @param pipe The direction's pipe.
+ */
+void WanProxy::receive(tcp::socket& from, Pipe& pipe) {
+	double one_way_ms = this->profile.rtt_ms / 2;
+	double segment_delivered = 1 - this->profile.loss_percent / 100;
+	std::uniform_real_distribution<double> jitter(-this->profile.jitter_ms, this->profile.jitter_ms);
+	std::uniform_real_distribution<double> uniform(0, 1);
+	size_t buffer_bytes = this->profile.bufferBytes();
+
+	Bytes buffer(WAN_READ_SIZE);
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(pipe.mutex);
+			pipe.changed.wait(lock, [&]() { return pipe.queued_bytes < buffer_bytes || pipe.ended; });
+			if (pipe.ended) {
+				break;
+			}
+		}
+
+		boost::system::error_code error;
+		size_t received = from.read_some(boost::asio::buffer(buffer), error);
+		if (error) {
+			break;
+		}
+
+		Clock::time_point now = Clock::now();
+		std::lock_guard<std::mutex> lock(pipe.mutex);
+		double delay_ms = std::max(0.0, one_way_ms + jitter(pipe.random));
+		Clock::time_point release = std::max(now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(delay_ms)), pipe.last_release);
+		size_t segments = (received + WAN_SEGMENT_SIZE - 1) / WAN_SEGMENT_SIZE;
+		if (this->profile.loss_percent > 0 && uniform(pipe.random) >= std::pow(segment_delivered, static_cast<double>(segments))) {
+			release += this->profile.retransmissionTimeout();
+		}
+		pipe.last_release = release;
+		pipe.chunks.push_back({ Bytes(buffer.begin(), buffer.begin() + received), release });
+		pipe.queued_bytes += received;
+		pipe.changed.notify_all();
+	}
+
+	std::lock_guard<std::mutex> lock(pipe.mutex);
+	pipe.ended = true;
+	pipe.changed.notify_all();
+}
+
+// The end of the stall `time` falls in, or `time` itself if the link isn't stalled then.
+WanProxy::Clock::time_point WanProxy::afterStall(Clock::time_point time) const {
+	if (this->profile.stall_every_ms <= 0 || this->profile.stall_ms <= 0) {
+		return time;
+	}
+	double since_epoch_ms = std::chrono::duration<double, std::milli>(time - this->epoch).count();
+	double into_period_ms = std::fmod(since_epoch_ms, this->profile.stall_every_ms);
+	double stall_start_ms = this->profile.stall_every_ms - this->profile.stall_ms; // each period ends with its stall
+	if (into_period_ms < stall_start_ms) {
+		return time;
+	}
+	return time + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(this->profile.stall_every_ms - into_period_ms));
+}
+
+/** WanProxy::deliver
+ * Writes one direction of a connection to the other side, as the link would deliver it.
+ *
+ * This function performs the following steps:
+ * 1. Waits for the next chunk and for its release time.
+ * 2. Sends it in slices of WAN_SLICE_SIZE, each one once the link finished sending the previous one at its
+ *    bandwidth, and not during a stall.
+ * 3. Frees the chunk's room in the pipe, which lets the receiving thread read more.
+ * Once the pipe ended and is empty, shuts down the sending side of the socket so the peer sees the end of the
+ * stream. If writing fails, shuts down the other side's socket so its reader stops as well.
+ *
+ * @param pipe The direction's pipe.
+ * @param to The socket to write to.
+ * @param from The socket the pipe is read from.
+ */
+void WanProxy::deliver(Pipe& pipe, tcp::socket& to, tcp::socket& from) {
+	double bytes_per_second = this->profile.bandwidth_mbit * 1e6 / 8;
+	Clock::time_point link_free = Clock::now();
+	boost::system::error_code error;
+
+	for (;;) {
+		Chunk chunk;
+		{
+			std::unique_lock<std::mutex> lock(pipe.mutex);
+			pipe.changed.wait(lock, [&]() { return !pipe.chunks.empty() || pipe.ended; });
+			if (pipe.chunks.empty()) {
+				break;
+			}
+			chunk = std::move(pipe.chunks.front());
+			pipe.chunks.pop_front();
+		}
+
+		std::this_thread::sleep_until(chunk.release);
+		for (size_t sent = 0; sent < chunk.data.size() && !error; ) {
+			size_t slice = std::min(WAN_SLICE_SIZE, chunk.data.size() - sent);
+			Clock::time_point send_at = afterStall(std::max(link_free, Clock::now()));
+			std::this_thread::sleep_until(send_at);
+			boost::asio::write(to, boost::asio::buffer(chunk.data.data() + sent, slice), error);
+			sent += slice;
+			link_free = send_at;
+			if (bytes_per_second > 0) {
+				link_free += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(slice / bytes_per_second));
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(pipe.mutex);
+		pipe.queued_bytes -= chunk.data.size();
+		if (error) {
+			pipe.ended = true;
+			pipe.chunks.clear();
+			pipe.queued_bytes = 0;
+		}
+		pipe.changed.notify_all();
+		if (error) {
+			from.shutdown(tcp::socket::shutdown_both, error);
+			return;
+		}
+	}
+	to.shutdown(tcp::socket::shutdown_send, error);
+}
@@ -0,0 +1,98 @@
+#ifndef WAN_PROXY_HPP
+#define WAN_PROXY_HPP
+#include "../utils.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+// The link a WanProxy emulates, in each direction. All zeros is a plain relay.
+struct WanProfile {
+	double rtt_ms = 0;           // added round trip time, half of it on the way in each direction
+	double jitter_ms = 0;        // each chunk's delay varies by up to this much either way (chunks stay in order)
+	double bandwidth_mbit = 0;   // the link's rate in each direction, 0 for no limit
+	double loss_percent = 0;     // the share of TCP segments lost, each loss delays its chunk by a retransmission timeout
+	double stall_every_ms = 0;   // every so often the link stops for stall_ms, 0 for no stalls
+	double stall_ms = 0;
+
+	bool enabled() const;
+	size_t bufferBytes() const;  // how much a direction holds before the sender is blocked: the link's bandwidth-delay product
+	std::chrono::microseconds retransmissionTimeout() const;
+	string toJson() const;
+};
+
+// Parses one of the --rtt-ms, --jitter-ms, --bandwidth-mbit, --loss-percent, --stall-every-ms and --stall-ms
+// options into the profile. Returns false for any other option.
+bool parseWanOption(const string& option, const string& value, WanProfile& profile);
+
+constexpr const char* WAN_OPTIONS_USAGE = "[--rtt-ms MS] [--jitter-ms MS] [--bandwidth-mbit MBIT] [--loss-percent P] [--stall-every-ms MS --stall-ms MS]";
+
+// A TCP proxy on loopback that makes the connections through it behave like a wide area link: every chunk it
+// reads is delivered to the other side after the link's delay, at the link's bandwidth, and held back by
+// losses and stalls. Each direction buffers at most the link's bandwidth-delay product, so a sender that
+// outruns the link blocks like it would on a real one.
+//
+// Each connection is relayed by four threads (a reader and a writer per direction), every socket blocks.
+class WanProxy {
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Chunk {
+		Bytes data;
+		Clock::time_point release; // not sent before this
+	};
+
+	// One direction of a connection.
+	struct Pipe {
+		std::mutex mutex;
+		std::condition_variable changed;
+		std::deque<Chunk> chunks;
+		size_t queued_bytes = 0;
+		bool ended = false;        // the sender closed its side, or it failed
+		Clock::time_point last_release;
+		std::mt19937_64 random;
+	};
+
+	struct Connection {
+		tcp::socket client;
+		tcp::socket server;
+		Pipe upstream;             // client to server
+		Pipe downstream;           // server to client
+		std::thread threads[4];
+
+		explicit Connection(boost::asio::io_context& io_context);
+	};
+
+	WanProfile profile;
+	tcp::resolver::results_type target;
+	Clock::time_point epoch;       // stalls are scheduled from here
+	boost::asio::io_context io_context;
+	tcp::acceptor acceptor;
+	std::thread accept_thread;
+	std::atomic<bool> stopping;
+	std::mutex connections_mutex;
+	vector<std::unique_ptr<Connection>> connections;
+
+	void acceptConnections();
+	void receive(tcp::socket& from, Pipe& pipe);
+	void deliver(Pipe& pipe, tcp::socket& to, tcp::socket& from);
+	Clock::time_point afterStall(Clock::time_point time) const;
+
+public:
+	WanProxy(const WanProfile& profile, const string& target_host, const string& target_port, uint16_t listen_port = 0);
+	~WanProxy();
+
+	WanProxy(const WanProxy&) = delete;
+	WanProxy& operator=(const WanProxy&) = delete;
+
+	uint16_t port() const;
+	void start();
+	void stop();
+};
+
+#endif
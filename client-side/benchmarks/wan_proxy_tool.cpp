@@ -0,0 +1,51 @@
+// Runs a WanProxy (wan_proxy.hpp) on its own, in front of any server, so the real client (or the load generator)
+// can be run over an emulated wide area link: point the client's transfer.info at 127.0.0.1 and the --listen port.
+// It relays connections until it's killed.
+//
+// Usage: wan_proxy --target HOST:PORT [--listen PORT] [--rtt-ms MS] [--jitter-ms MS] [--bandwidth-mbit MBIT]
+//                  [--loss-percent P] [--stall-every-ms MS --stall-ms MS]
+
+#include "wan_proxy.hpp"
+
+int main(int argc, char* argv[])
+{
+	WanProfile profile;
+	string target_host, target_port;
+	uint16_t listen_port = 0;
+	bool valid = true;
+	for (int i = 1; i + 1 < argc && valid; i += 2) {
+		string option = argv[i];
+		string value = argv[i + 1];
+		if (option == "--target") {
+			size_t colon = value.rfind(':');
+			valid = colon != string::npos;
+			if (valid) {
+				target_host = value.substr(0, colon);
+				target_port = value.substr(colon + 1);
+			}
+		}
+		else if (option == "--listen") {
+			listen_port = static_cast<uint16_t>(std::strtoul(value.c_str(), nullptr, 10));
+		}
+		else {
+			valid = parseWanOption(option, value, profile);
+		}
+	}
+	if (!valid || argc % 2 == 0 || target_host.empty()) {
+		std::cerr << "usage: wan_proxy --target HOST:PORT [--listen PORT] " << WAN_OPTIONS_USAGE << std::endl;
+		return 1;
+	}
+
+	try {
+		WanProxy proxy(profile, target_host, target_port, listen_port);
+		proxy.start();
+		std::cout << "127.0.0.1:" << proxy.port() << " -> " << target_host << ":" << target_port << " " << profile.toJson() << std::endl;
+		for (;;) {
+			std::this_thread::sleep_for(std::chrono::hours(1));
+		}
+	}
+	catch (std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+}
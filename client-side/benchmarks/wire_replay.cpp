@@ -0,0 +1,383 @@
+// Replays sessions captured by the client (TRANSFER_CAPTURE, see wire_capture.hpp) against a server: the captured
+// requests are sent again byte for byte, at their original pace or faster, so the server's receive side and the
+// protocol's framing can be benchmarked without generating keys or encrypting files.
+//
+// By default the sessions are replayed against the in-process loopback_server.hpp, which then answers with the
+// CRC of the file as received (a replayed file is encrypted with the captured session's AES key). --server
+// replays them against another server instead.
+//
+// The server hands out new uuids, so the replay keeps the uuid of every captured response and the uuid the
+// server answered in its place, and rewrites the uuid of every request it sends accordingly. The rest of
+// each request is sent as captured. The captured responses only tell how many responses to wait for.
+//
+// Usage: wire_replay --capture FILE [--server HOST:PORT] [--speed X] [--repeats N] [--concurrency N] [--output FILE]
+//   --speed 1 keeps the captured pauses between the requests, 10 makes them 10 times shorter, 0 drops them.
+
+#include "latency_histogram.hpp"
+#include "loopback_server.hpp"
+#include "../response_reader.hpp"
+#include "../wire_capture.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <sstream>
+
+using ReplayClock = std::chrono::steady_clock;
+
+struct ReplayOptions {
+	string capture_path;
+	string host;
+	string port;
+	double speed = 1;
+	size_t repeats = 1;
+	size_t concurrency = 1;
+	string output;
+};
+
+// A captured session, with what the replay needs to know about its byte streams found up front: where the
+// uuid of every request is, and which responses every received record completes.
+struct ReplayPlan {
+	const CapturedSession* session;
+	vector<uint64_t> stream_offsets;       // the offset of every record in the stream of its direction
+	vector<uint64_t> request_uuid_offsets; // in the sent stream
+	vector<UUID> request_uuids;
+	vector<size_t> responses_completed;    // for every received record, the responses complete by its end
+	vector<uint16_t> response_codes;
+	vector<UUID> response_uuids;           // nil for the responses without a payload
+	uint64_t duration_us;
+};
+
+struct ReplayResults {
+	LatencyHistogram session_latency;
+	uint64_t completed = 0;
+	uint64_t failed = 0;
+	uint64_t bytes_sent = 0;
+	uint64_t bytes_received = 0;
+	uint64_t responses = 0;
+	uint64_t different_responses = 0;      // a different code than captured, e.g. registering a name again
+};
+
+// Reads bytes from the stream of one direction of a session, across its records.
+class CapturedStream {
+private:
+	const CapturedSession& session;
+	vector<std::pair<uint64_t, size_t>> records; // the stream offset of each record of the direction, and its index
+	uint64_t stream_size;
+
+public:
+	CapturedStream(const CapturedSession& session, CaptureRecordType type, vector<uint64_t>& stream_offsets)
+		: session(session) {
+		uint64_t offset = 0;
+		for (size_t i = 0; i < session.records.size(); i++) {
+			if (session.records[i].type == type) {
+				stream_offsets[i] = offset;
+				this->records.push_back({ offset, i });
+				offset += session.records[i].data.size();
+			}
+		}
+		this->stream_size = offset;
+	}
+
+	uint64_t size() const {
+		return this->stream_size;
+	}
+
+	bool read(uint64_t offset, Byte* destination, size_t size) const {
+		if (offset + size > this->stream_size) {
+			return false;
+		}
+		auto record = std::upper_bound(this->records.begin(), this->records.end(), std::make_pair(offset, SIZE_MAX)) - 1;
+		for (size_t copied = 0; copied < size; ) {
+			const Bytes& data = this->session.records[record->second].data;
+			size_t start = static_cast<size_t>(offset + copied - record->first);
+			size_t length = std::min(size - copied, data.size() - start);
+			std::copy(data.begin() + start, data.begin() + start + length, destination + copied);
+			copied += length;
+			record++;
+		}
+		return true;
+	}
+};
+
+static uint32_t readLittleEndian32(const Byte* bytes) {
+	return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+/** planReplay
+ * Finds the requests and the responses of a captured session.
+ *
+ * This function performs the following steps:
+ * 1. Walks the sent stream request by request (header, then payload) and keeps where each request's uuid is
+ *    and what it was.
+ * 2. Walks the received stream response by response, and keeps every response's code and uuid.
+ * 3. For every received record, counts the responses that were complete once it arrived - the replay waits
+ *    for as many responses at that point.
+ */
+static ReplayPlan planReplay(const CapturedSession& session) {
+	ReplayPlan plan;
+	plan.session = &session;
+	plan.stream_offsets.resize(session.records.size());
+	plan.responses_completed.resize(session.records.size());
+	plan.duration_us = session.records.empty() ? 0 : session.records.back().offset_us;
+
+	CapturedStream sent(session, CaptureRecordType::Sent, plan.stream_offsets);
+	Byte header[REQUEST_HEADER_SIZE];
+	for (uint64_t offset = 0; sent.read(offset, header, REQUEST_HEADER_SIZE); offset += REQUEST_HEADER_SIZE + readLittleEndian32(header + UUID_SIZE + 3)) {
+		UUID uuid;
+		std::copy(header, header + UUID_SIZE, uuid.begin());
+		plan.request_uuid_offsets.push_back(offset);
+		plan.request_uuids.push_back(uuid);
+	}
+
+	CapturedStream received(session, CaptureRecordType::Received, plan.stream_offsets);
+	vector<uint64_t> response_ends;
+	for (uint64_t offset = 0; received.read(offset, header, RESPONSE_HEADER_SIZE); ) {
+		uint32_t payload_size = readLittleEndian32(header + 3);
+		UUID uuid = NIL_UUID;
+		if (payload_size >= UUID_SIZE && !received.read(offset + RESPONSE_HEADER_SIZE, uuid.data, UUID_SIZE)) {
+			break;
+		}
+		offset += RESPONSE_HEADER_SIZE + payload_size;
+		if (offset > received.size()) {
+			break;
+		}
+		plan.response_codes.push_back(static_cast<uint16_t>(header[1] | header[2] << 8));
+		plan.response_uuids.push_back(uuid);
+		response_ends.push_back(offset);
+	}
+	for (size_t i = 0; i < session.records.size(); i++) {
+		if (session.records[i].type == CaptureRecordType::Received) {
+			uint64_t end = plan.stream_offsets[i] + session.records[i].data.size();
+			plan.responses_completed[i] = std::upper_bound(response_ends.begin(), response_ends.end(), end) - response_ends.begin();
+		}
+	}
+	return plan;
+}
+
+/** replaySession
+ * Replays one captured session on a new connection.
+ *
+ * This function performs the following steps:
+ * 1. Connects to the server.
+ * 2. Goes through the captured records in order, waiting for each one's time (divided by the speed):
+ *    - sent: writes the record's bytes, with the uuid of every request in it replaced by the one the server
+ *      answered in its place (the bytes are sent from the capture, only the uuids come from elsewhere).
+ *    - received: reads responses until as many arrived as the capture had by the end of the record, and
+ *      pairs the uuid of each with the captured one.
+ * 3. Records how long the session took.
+ *
+ * @throws boost::system::system_error if the connection fails or the server closes it early.
+ */
+static void replaySession(const ReplayPlan& plan, const tcp::resolver::results_type& endpoints, double speed, ReplayResults& results) {
+	boost::asio::io_context io_context;
+	tcp::socket sock(io_context);
+	ReplayClock::time_point start = ReplayClock::now();
+	boost::asio::connect(sock, endpoints);
+	sock.set_option(tcp::no_delay(true));
+	ResponseReader reader;
+
+	std::map<UUID, UUID> live_uuids; // by captured uuid
+	size_t responses = 0;
+	vector<boost::asio::const_buffer> buffers;
+	for (size_t i = 0; i < plan.session->records.size(); i++) {
+		const CaptureRecord& record = plan.session->records[i];
+		if (speed > 0) {
+			std::this_thread::sleep_until(start + std::chrono::duration_cast<ReplayClock::duration>(std::chrono::duration<double, std::micro>(record.offset_us / speed)));
+		}
+
+		if (record.type == CaptureRecordType::Sent) {
+			uint64_t record_start = plan.stream_offsets[i];
+			uint64_t record_end = record_start + record.data.size();
+			uint64_t written = record_start; // everything before this is in the buffers
+			buffers.clear();
+			// the first request whose uuid ends in the record - a record may start in the middle of a uuid.
+			uint64_t first_uuid_offset = record_start < UUID_SIZE ? 0 : record_start - UUID_SIZE + 1;
+			auto request = std::lower_bound(plan.request_uuid_offsets.begin(), plan.request_uuid_offsets.end(), first_uuid_offset);
+			for (; request != plan.request_uuid_offsets.end() && *request < record_end; ++request) {
+				auto live_uuid = live_uuids.find(plan.request_uuids[request - plan.request_uuid_offsets.begin()]);
+				if (live_uuid == live_uuids.end()) {
+					continue;
+				}
+				uint64_t from = std::max(*request, record_start);
+				uint64_t to = std::min(*request + UUID_SIZE, record_end);
+				buffers.push_back(boost::asio::buffer(record.data.data() + (written - record_start), static_cast<size_t>(from - written)));
+				buffers.push_back(boost::asio::buffer(live_uuid->second.data + (from - *request), static_cast<size_t>(to - from)));
+				written = to;
+			}
+			buffers.push_back(boost::asio::buffer(record.data.data() + (written - record_start), static_cast<size_t>(record_end - written)));
+			boost::asio::write(sock, buffers);
+			results.bytes_sent += record.data.size();
+		}
+		else {
+			for (; responses < plan.responses_completed[i]; responses++) {
+				ResponseView response = reader.next(sock);
+				results.bytes_received += RESPONSE_HEADER_SIZE + response.payload_size;
+				results.responses++;
+				if (response.code != plan.response_codes[responses]) {
+					results.different_responses++;
+				}
+				if (response.payload_size >= UUID_SIZE && !plan.response_uuids[responses].is_nil()) {
+					std::copy(response.payload, response.payload + UUID_SIZE, live_uuids[plan.response_uuids[responses]].begin());
+				}
+			}
+		}
+	}
+	results.session_latency.record(std::chrono::duration_cast<std::chrono::microseconds>(ReplayClock::now() - start).count());
+}
+
+static bool parseOptions(int argc, char* argv[], ReplayOptions& options) {
+	for (int i = 1; i < argc; i++) {
+		string option = argv[i];
+		if (i + 1 >= argc) {
+			std::cerr << "missing value for " << option << std::endl;
+			return false;
+		}
+		string value = argv[++i];
+		if (option == "--capture") {
+			options.capture_path = value;
+		}
+		else if (option == "--server") {
+			size_t colon = value.rfind(':');
+			if (colon == string::npos) {
+				std::cerr << "--server expects HOST:PORT" << std::endl;
+				return false;
+			}
+			options.host = value.substr(0, colon);
+			options.port = value.substr(colon + 1);
+		}
+		else if (option == "--speed") {
+			options.speed = std::max(0.0, std::strtod(value.c_str(), nullptr));
+		}
+		else if (option == "--repeats") {
+			options.repeats = std::max<size_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+		}
+		else if (option == "--concurrency") {
+			options.concurrency = std::max<size_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+		}
+		else if (option == "--output") {
+			options.output = value;
+		}
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			return false;
+		}
+	}
+	if (options.capture_path.empty()) {
+		std::cerr << "--capture is required" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	ReplayOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		std::cerr << "usage: wire_replay --capture FILE [--server HOST:PORT] [--speed X] [--repeats N] [--concurrency N] [--output FILE]" << std::endl;
+		return 1;
+	}
+
+	vector<CapturedSession> sessions;
+	try {
+		sessions = readCapture(options.capture_path);
+	}
+	catch (std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	vector<ReplayPlan> plans;
+	uint64_t captured_duration_us = 0;
+	for (const CapturedSession& session : sessions) {
+		plans.push_back(planReplay(session));
+		captured_duration_us += plans.back().duration_us;
+	}
+	if (plans.empty()) {
+		std::cerr << options.capture_path << " has no sessions" << std::endl;
+		return 1;
+	}
+
+	std::unique_ptr<LoopbackServer> stand_in;
+	if (options.host.empty()) {
+		stand_in = std::make_unique<LoopbackServer>(false);
+		stand_in->start();
+		options.host = "127.0.0.1";
+		options.port = std::to_string(stand_in->port());
+	}
+	boost::asio::io_context io_context;
+	tcp::resolver::results_type endpoints = tcp::resolver(io_context).resolve(options.host, options.port);
+
+	// every thread takes the next session to replay, each session is replayed `repeats` times.
+	size_t replays = plans.size() * options.repeats;
+	std::atomic<size_t> next_replay(0);
+	vector<ReplayResults> thread_results(options.concurrency);
+	vector<std::thread> threads;
+	ReplayClock::time_point start = ReplayClock::now();
+	for (size_t t = 0; t < options.concurrency; t++) {
+		threads.emplace_back([&, t]() {
+			for (size_t replay = next_replay++; replay < replays; replay = next_replay++) {
+				try {
+					replaySession(plans[replay % plans.size()], endpoints, options.speed, thread_results[t]);
+					thread_results[t].completed++;
+				}
+				catch (std::exception&) {
+					thread_results[t].failed++;
+				}
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	double elapsed_seconds = std::chrono::duration<double>(ReplayClock::now() - start).count();
+	if (stand_in) {
+		stand_in->stop();
+	}
+
+	ReplayResults total;
+	for (const ReplayResults& results : thread_results) {
+		total.session_latency.merge(results.session_latency);
+		total.completed += results.completed;
+		total.failed += results.failed;
+		total.bytes_sent += results.bytes_sent;
+		total.bytes_received += results.bytes_received;
+		total.responses += results.responses;
+		total.different_responses += results.different_responses;
+	}
+
+	std::ostringstream json;
+	json << std::fixed << std::setprecision(3)
+		<< "{\"suite\":\"wire_replay\""
+		<< ",\"target\":\"" << (stand_in ? "stand-in" : options.host + ":" + options.port) << "\""
+		<< ",\"captured_sessions\":" << plans.size()
+		<< ",\"captured_duration_ms\":" << captured_duration_us / 1000.0
+		<< ",\"speed\":" << options.speed
+		<< ",\"concurrency\":" << options.concurrency
+		<< ",\"completed\":" << total.completed
+		<< ",\"failed\":" << total.failed
+		<< ",\"duration_s\":" << elapsed_seconds
+		<< ",\"sent_mb_per_s\":" << total.bytes_sent / elapsed_seconds / 1e6
+		<< ",\"bytes_sent\":" << total.bytes_sent
+		<< ",\"bytes_received\":" << total.bytes_received
+		<< ",\"responses\":" << total.responses
+		<< ",\"different_responses\":" << total.different_responses;
+	if (stand_in && total.bytes_sent > 0) {
+		json << ",\"server_cpu_ns_per_byte\":" << static_cast<double>(stand_in->cpuNanoseconds()) / total.bytes_sent;
+	}
+	json << ",\"session_latency\":" << total.session_latency.toJson() << "}\n";
+
+	if (options.output.empty()) {
+		std::cout << json.str();
+		return 0;
+	}
+	ofstream output(options.output, std::ios::trunc);
+	if (!output) {
+		std::cerr << "Couldn't write the results to " << options.output << std::endl;
+		return 1;
+	}
+	output << json.str();
+	return 0;
+}
@@ -1,11 +1,16 @@
-#include <iostream>
-#include <fstream>
-#include <ostream>
-#include <cstdio>
-#include <vector>
-#include <iterator>
-#include <filesystem>
-#include <string>
-
-std::string readfile(std::string fname);
-unsigned long memcrc(const char* b, size_t n);
\ No newline at end of file
+#include <iostream>
+#include <fstream>
+#include <ostream>
+#include <cstdio>
+#include <vector>
+#include <iterator>
+#include <filesystem>
+#include <string>
+
+std::string readfile(std::string fname);
+unsigned long memcrc(const char* b, size_t n);
+
+// Incremental form of memcrc: feed the data through memcrc_update (starting from 0)
+// in as many pieces as needed, then memcrc_final with the total number of bytes fed.
+unsigned long memcrc_update(unsigned long crc_state, const char* b, size_t n);
+unsigned long memcrc_final(unsigned long crc_state, size_t total_length);
\ No newline at end of file
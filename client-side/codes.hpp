@@ -1,25 +1,34 @@
-#ifndef CODES_HPP
-#define CODES_HPP
-#include "utils.hpp"
-
-// 16 bits = 2 bytes
-enum Codes : uint16_t {
-	REGISTRATION_CODE = 825,
-	SENDING_PUBLIC_KEY_CODE = 826,
-	RECONNECTION_CODE = 827,
-	SENDING_FILE_CODE = 828,
-	VALID_CRC_CODE = 900,
-	SENDING_CRC_AGAIN_CODE = 901,
-	INVALID_CRC_DONE_CODE = 902,
-
-	REGISTRATION_SUCCEEDED_CODE = 1600,
-	REGISTRATION_FAILED_CODE = 1601,
-	PUBLIC_KEY_RECEIVED_CODE = 1602,
-	FILE_RECEIVED_CRC_CODE = 1603,
-	MESSAGE_RECEIVED_CODE = 1604,
-	RECONNECTION_SUCCEEDED_CODE = 1605,
-	RECONNECTION_FAILED_CODE = 1606,
-	GENERAL_ERROR_CODE = 1607
-};
-
+#ifndef CODES_HPP
+#define CODES_HPP
+#include "utils.hpp"
+
+// 16 bits = 2 bytes
+enum Codes : uint16_t {
+	REGISTRATION_CODE = 825,
+	SENDING_PUBLIC_KEY_CODE = 826,
+	RECONNECTION_CODE = 827,
+	SENDING_FILE_CODE = 828,
+	VALID_CRC_CODE = 900,
+	SENDING_CRC_AGAIN_CODE = 901,
+	INVALID_CRC_DONE_CODE = 902,
+	RESUMPTION_CODE = 829,
+	RESUMPTION_TICKET_REQUEST_CODE = 830,
+	SENDING_X25519_PUBLIC_KEY_CODE = 831,
+	EARLY_DATA_RESUMPTION_CODE = 832,
+
+	REGISTRATION_SUCCEEDED_CODE = 1600,
+	REGISTRATION_FAILED_CODE = 1601,
+	PUBLIC_KEY_RECEIVED_CODE = 1602,
+	FILE_RECEIVED_CRC_CODE = 1603,
+	MESSAGE_RECEIVED_CODE = 1604,
+	RECONNECTION_SUCCEEDED_CODE = 1605,
+	RECONNECTION_FAILED_CODE = 1606,
+	GENERAL_ERROR_CODE = 1607,
+	RESUMPTION_SUCCEEDED_CODE = 1608,
+	RESUMPTION_FAILED_CODE = 1609,
+	RESUMPTION_TICKET_CODE = 1610,
+	X25519_PUBLIC_KEY_RECEIVED_CODE = 1611,
+	RECONNECTION_X25519_SUCCEEDED_CODE = 1612
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "connection_pool.hpp"
+
+constexpr auto POOL_RETRY_INTERVAL = std::chrono::seconds(1); // between connects while the server is unreachable
+
+ConnectionPool::ConnectionPool(boost::asio::io_context& io_context, const string& address, const string& port, const SocketSettings& settings, size_t size)
+	: io_context(io_context), settings(settings), size(size), stopping(false) {
+	tcp::resolver resolver(io_context);
+	this->endpoints = resolver.resolve(address, port);
+	this->connect_thread = std::thread(&ConnectionPool::keepFilled, this);
+}
+
+ConnectionPool::~ConnectionPool() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->changed.notify_all();
+	this->connect_thread.join();
+}
+
+// Only connects: the socket is tuned by take, on the thread of the job that will use it.
+ClientSocket ConnectionPool::connect() {
+	ClientSocket sock(this->io_context);
+	boost::asio::connect(sock, this->endpoints);
+	return sock;
+}
+
+// Connects sockets until the pool holds `size` of them, and again every time a job takes one.
+void ConnectionPool::keepFilled() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	for (;;) {
+		this->changed.wait(lock, [this]() { return this->stopping || this->ready.size() < this->size; });
+		if (this->stopping) {
+			return;
+		}
+
+		lock.unlock();
+		try {
+			ClientSocket sock = connect();
+			lock.lock();
+			this->ready.push_back(std::move(sock));
+		}
+		catch (std::exception& e) {
+			LOG_WARNING({}, "Couldn't connect ahead to the server: %s", e.what());
+			lock.lock();
+			this->changed.wait_for(lock, POOL_RETRY_INTERVAL, [this]() { return this->stopping; });
+		}
+	}
+}
+
+// Whether the server kept the connection open while it waited in the pool: a peek that would block means
+// nothing arrived, not even the end of the stream.
+static bool stillOpen(tcp::socket& sock) {
+	boost::system::error_code error;
+	Byte probe;
+	sock.non_blocking(true, error);
+	sock.receive(boost::asio::buffer(&probe, 1), tcp::socket::message_peek, error);
+	bool open = error == boost::asio::error::would_block;
+	sock.non_blocking(false, error);
+	return open;
+}
+
+/** ConnectionPool::take
+ * Hands out a connected socket for a job.
+ *
+ * This function performs the following steps:
+ * 1. Takes the oldest socket the pool connected ahead, and wakes the connect thread to replace it.
+ * 2. Drops it if the server closed it while it waited, and takes the next one.
+ * 3. If no socket is ready, connects one now.
+ * 4. Tunes the socket with the pool's settings. This runs on the calling thread, never on the connect thread
+ *    while another job's socket is in the middle of a write.
+ *
+ * @return The connected socket, tuned with the pool's socket settings.
+ * @throws boost::system::system_error if the server can't be reached.
+ */
+ClientSocket ConnectionPool::take() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (!this->ready.empty()) {
+		ClientSocket sock = std::move(this->ready.front());
+		this->ready.pop_front();
+		this->changed.notify_all();
+		if (stillOpen(sock)) {
+			lock.unlock();
+			applySocketSettings(sock, this->settings);
+			return sock;
+		}
+	}
+	lock.unlock();
+	ClientSocket sock = connect();
+	applySocketSettings(sock, this->settings);
+	return sock;
+}
@@ -0,0 +1,42 @@
+#ifndef CONNECTION_POOL_HPP
+#define CONNECTION_POOL_HPP
+#include "utils.hpp"
+#include "socket_policy.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+constexpr size_t POOLED_CONNECTIONS = 2; // connected ahead of the jobs, so a job doesn't wait for the connect
+
+// Connections to the server, connected ahead of the jobs that will use them. The server closes a connection
+// after the file it carried, so every job takes a fresh one and the pool connects the next in the background.
+// The server's address is resolved once, when the pool starts.
+class ConnectionPool {
+private:
+	boost::asio::io_context& io_context;
+	tcp::resolver::results_type endpoints;
+	SocketSettings settings;
+	size_t size;
+
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::deque<ClientSocket> ready;
+	bool stopping;
+	std::thread connect_thread;
+
+	ClientSocket connect();
+	void keepFilled();
+
+public:
+	ConnectionPool(boost::asio::io_context& io_context, const string& address, const string& port, const SocketSettings& settings, size_t size);
+	~ConnectionPool();
+
+	ConnectionPool(const ConnectionPool&) = delete;
+	ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+	ClientSocket take(); // a connected socket the server hasn't closed, connected now if none is ready
+};
+
+#endif
@@ -0,0 +1,260 @@
+#include "daemon.hpp"
+
+#include <map>
+#include <sstream>
+
+#ifdef HAVE_UPLOAD_DAEMON
+// The CLI may have gone away, its job still runs.
+void UploadDaemon::JobConnection::reply(const string& line) {
+	std::lock_guard<std::mutex> lock(this->write_mutex);
+	boost::system::error_code error;
+	boost::asio::write(this->sock, boost::asio::buffer(line + "\n"), error);
+}
+
+UploadDaemon::UploadDaemon(const string& socket_path, UploadRunner runner)
+	: socket_path(socket_path), runner(std::move(runner)), next_job_id(1), stopping(false) {}
+
+/** UploadDaemon::serve
+ * Reads the requests of one CLI connection until it closes.
+ *
+ * A job is answered with QUEUED before the daemon's lock is released, so the worker can't answer DONE first.
+ *
+ * @param connection The CLI's connection.
+ */
+void UploadDaemon::serve(std::shared_ptr<JobConnection> connection) {
+	boost::asio::streambuf buffer;
+	std::istream lines(&buffer);
+	for (;;) {
+		boost::system::error_code error;
+		boost::asio::read_until(connection->sock, buffer, '\n', error);
+		if (error) {
+			break;
+		}
+		string line;
+		std::getline(lines, line);
+
+		if (line.rfind("SEND ", 0) == 0 && line.size() > 5) {
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if (this->stopping) {
+				connection->reply("REFUSED shutting down");
+				continue;
+			}
+			uint64_t id = this->next_job_id++;
+			this->jobs.push_back({ id, line.substr(5), connection });
+			connection->reply("QUEUED " + std::to_string(id));
+			this->changed.notify_all();
+		}
+		else if (line == "SHUTDOWN") {
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->stopping = true;
+			}
+			this->changed.notify_all();
+			connection->reply("STOPPING");
+			// wakes the accept loop up, it sees the daemon is stopping.
+			boost::asio::io_context io_context;
+			stream_protocol::socket wakeup(io_context);
+			wakeup.connect(stream_protocol::endpoint(this->socket_path), error);
+		}
+		else {
+			connection->reply("ERROR unknown request");
+		}
+	}
+	connection->finished = true;
+}
+
+// Runs the queued jobs one after the other, until the daemon stops and the queue is empty.
+void UploadDaemon::work() {
+	for (;;) {
+		UploadJob job;
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->changed.wait(lock, [this]() { return this->stopping || !this->jobs.empty(); });
+			if (this->jobs.empty()) {
+				return;
+			}
+			job = std::move(this->jobs.front());
+			this->jobs.pop_front();
+		}
+
+		string failure = "the server didn't confirm the file";
+		bool sent = false;
+		try {
+			sent = this->runner(job.file_path);
+		}
+		catch (std::exception& e) {
+			failure = e.what();
+		}
+
+		if (sent) {
+			LOG_INFO({}, "job %llu: %s sent", static_cast<unsigned long long>(job.id), job.file_path.c_str());
+			job.connection->reply("DONE " + std::to_string(job.id) + " ok");
+		}
+		else {
+			LOG_ERROR({}, "job %llu: sending %s failed: %s", static_cast<unsigned long long>(job.id), job.file_path.c_str(), failure.c_str());
+			job.connection->reply("DONE " + std::to_string(job.id) + " failed " + failure);
+		}
+	}
+}
+
+/** UploadDaemon::run
+ * Serves the job queue until a SHUTDOWN request.
+ *
+ * This function performs the following steps:
+ * 1. Refuses to start if another daemon answers on the socket path, and removes the socket file a daemon
+ *    that didn't exit cleanly left behind otherwise.
+ * 2. Starts the worker thread, and accepts CLI connections, each read by a thread of its own. Threads of
+ *    connections that closed are joined as new ones arrive.
+ * 3. Once stopping, waits for the worker to run the queued jobs, closes the connections still open and
+ *    removes the socket file.
+ *
+ * @throws std::runtime_error if another daemon is serving the socket path.
+ */
+void UploadDaemon::run() {
+	boost::asio::io_context io_context;
+	stream_protocol::endpoint endpoint(this->socket_path);
+	{
+		boost::system::error_code error;
+		stream_protocol::socket probe(io_context);
+		probe.connect(endpoint, error);
+		if (!error) {
+			throw std::runtime_error("another daemon is serving " + this->socket_path);
+		}
+		std::error_code remove_error;
+		std::filesystem::remove(this->socket_path, remove_error);
+	}
+
+	stream_protocol::acceptor acceptor(io_context, endpoint);
+	std::thread worker(&UploadDaemon::work, this);
+	LOG_INFO({}, "accepting upload jobs on %s", this->socket_path.c_str());
+
+	for (;;) {
+		stream_protocol::socket sock(io_context);
+		boost::system::error_code error;
+		acceptor.accept(sock, error);
+
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (this->stopping) {
+			break;
+		}
+		if (error) {
+			LOG_WARNING({}, "accepting a job connection failed: %s", error.message().c_str());
+			continue;
+		}
+
+		for (size_t i = 0; i < this->connection_threads.size();) {
+			if (this->connections[i]->finished) {
+				this->connection_threads[i].join();
+				this->connection_threads.erase(this->connection_threads.begin() + i);
+				this->connections.erase(this->connections.begin() + i);
+			}
+			else {
+				i++;
+			}
+		}
+		std::shared_ptr<JobConnection> connection = std::make_shared<JobConnection>(std::move(sock));
+		this->connections.push_back(connection);
+		this->connection_threads.emplace_back(&UploadDaemon::serve, this, connection);
+	}
+
+	worker.join();
+	for (std::shared_ptr<JobConnection>& connection : this->connections) {
+		boost::system::error_code error;
+		connection->sock.shutdown(stream_protocol::socket::shutdown_both, error);
+	}
+	for (std::thread& thread : this->connection_threads) {
+		thread.join();
+	}
+	acceptor.close();
+	std::error_code remove_error;
+	std::filesystem::remove(this->socket_path, remove_error);
+	LOG_INFO({}, "stopped accepting upload jobs");
+}
+
+/** runUploadCli
+ * Queues files on a running daemon and waits until every one of them was sent.
+ *
+ * @param socket_path The daemon's socket.
+ * @param file_paths The files to send, as they would be written in 'transfer.info'.
+ * @param shutdown Whether to ask the daemon to stop once the queued jobs ran.
+ * @return 0 if every file was sent, 1 otherwise.
+ */
+int runUploadCli(const string& socket_path, const vector<string>& file_paths, bool shutdown) {
+	boost::asio::io_context io_context;
+	stream_protocol::socket sock(io_context);
+	boost::system::error_code error;
+	sock.connect(stream_protocol::endpoint(socket_path), error);
+	if (error) {
+		LOG_ERROR({}, "No daemon on %s: %s", socket_path.c_str(), error.message().c_str());
+		return 1;
+	}
+
+	string requests;
+	for (const string& file_path : file_paths) {
+		requests += "SEND " + file_path + "\n";
+	}
+	if (shutdown) {
+		requests += "SHUTDOWN\n";
+	}
+	boost::asio::write(sock, boost::asio::buffer(requests), error);
+
+	// the daemon answers the requests in order, the jobs complete later in any order.
+	size_t queued = 0;
+	size_t pending = file_paths.size() + (shutdown ? 1 : 0);
+	std::map<uint64_t, string> jobs;
+	int status = 0;
+	boost::asio::streambuf buffer;
+	std::istream lines(&buffer);
+	while (!error && pending > 0) {
+		boost::asio::read_until(sock, buffer, '\n', error);
+		if (error) {
+			break;
+		}
+		string line;
+		std::getline(lines, line);
+		std::istringstream fields(line);
+		string answer;
+		uint64_t id = 0;
+		fields >> answer >> id;
+
+		if (answer == "QUEUED") {
+			jobs[id] = file_paths[queued++];
+		}
+		else if (answer == "DONE") {
+			string result;
+			fields >> result;
+			if (result == "ok") {
+				LOG_INFO({}, "%s sent", jobs[id].c_str());
+			}
+			else {
+				string reason;
+				std::getline(fields >> std::ws, reason);
+				LOG_ERROR({}, "sending %s failed: %s", jobs[id].c_str(), reason.c_str());
+				status = 1;
+			}
+			pending--;
+		}
+		else if (answer == "STOPPING") {
+			pending--;
+		}
+		else {
+			LOG_ERROR({}, "the daemon answered: %s", line.c_str());
+			status = 1;
+			pending--;
+			if (queued < file_paths.size()) {
+				queued++;
+			}
+		}
+	}
+	if (error && pending > 0) {
+		LOG_ERROR({}, "lost the daemon before every job completed: %s", error.message().c_str());
+		status = 1;
+	}
+	return status;
+}
+#else
+int runUploadCli(const string& socket_path, const vector<string>& file_paths, bool shutdown) {
+	LOG_ERROR({}, "The upload daemon needs Unix domain sockets, which this platform doesn't have");
+	return 1;
+}
+#endif
@@ -0,0 +1,73 @@
+#ifndef DAEMON_HPP
+#define DAEMON_HPP
+#include "utils.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// The daemon's job queue is served on a Unix domain socket, where asio has them.
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+#define HAVE_UPLOAD_DAEMON 1
+#endif
+
+// Runs one upload job: the whole protocol, from the connection to the CRC confirmation.
+// Returns whether the server confirmed the file, and may throw for errors outside the protocol.
+using UploadRunner = std::function<bool(const string& file_path)>;
+
+#ifdef HAVE_UPLOAD_DAEMON
+using boost::asio::local::stream_protocol;
+
+// Accepts upload jobs on a Unix domain socket and runs them one after the other, in the order they arrived.
+// Each request is a line: "SEND <file path>" queues a file and is answered with "QUEUED <id>", and
+// "DONE <id> ok" or "DONE <id> failed <reason>" once the job ran. "SHUTDOWN" stops accepting jobs, runs the
+// queued ones and exits. Jobs run one at a time, since they share the client's me.info and session ticket.
+class UploadDaemon {
+private:
+	// A connection of the CLI, answered from the worker thread as its jobs complete.
+	struct JobConnection {
+		stream_protocol::socket sock;
+		std::mutex write_mutex;
+		std::atomic<bool> finished{ false }; // its thread stopped reading, and can be joined
+
+		explicit JobConnection(stream_protocol::socket sock) : sock(std::move(sock)) {}
+		void reply(const string& line);
+	};
+
+	struct UploadJob {
+		uint64_t id;
+		string file_path;
+		std::shared_ptr<JobConnection> connection;
+	};
+
+	string socket_path;
+	UploadRunner runner;
+
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::deque<UploadJob> jobs;
+	uint64_t next_job_id;
+	bool stopping;
+	vector<std::shared_ptr<JobConnection>> connections;
+	vector<std::thread> connection_threads;
+
+	void serve(std::shared_ptr<JobConnection> connection);
+	void work();
+
+public:
+	UploadDaemon(const string& socket_path, UploadRunner runner);
+
+	UploadDaemon(const UploadDaemon&) = delete;
+	UploadDaemon& operator=(const UploadDaemon&) = delete;
+
+	void run(); // blocks until a SHUTDOWN request, and until the jobs queued before it ran
+};
+#endif
+
+int runUploadCli(const string& socket_path, const vector<string>& file_paths, bool shutdown);
+
+#endif
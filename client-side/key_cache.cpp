@@ -0,0 +1,128 @@
+#include "key_cache.hpp"
+
+#include <sha.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+static const char KEY_CACHE_MAGIC[8] = { 'R', 'S', 'A', 'C', 'A', 'C', 'H', '2' };
+
+/** encodeInteger
+ * Writes an integer into a fixed size big-endian field of the cache record.
+ * Throws if the integer doesn't fit, so a key of an unexpected size is never cached.
+ */
+static void encodeInteger(const CryptoPP::Integer& value, char* field, size_t field_size) {
+	if (value.MinEncodedSize() > field_size) {
+		throw std::length_error("Error: RSA key parameter is too long for the key cache.");
+	}
+	value.Encode(reinterpret_cast<CryptoPP::byte*>(field), field_size);
+}
+
+static CryptoPP::Integer decodeInteger(const char* field, size_t field_size) {
+	return CryptoPP::Integer(reinterpret_cast<const CryptoPP::byte*>(field), field_size);
+}
+
+/** digestKeyBase64
+ * Computes the digest that binds the cache to the private key in 'me.info'.
+ * The line breaks are skipped, so the key hashes the same as written by the Base64 encoder and as read back
+ * (use_me_info_file joins its lines).
+ */
+static void digestKeyBase64(const string& key_base64, char* digest) {
+	CryptoPP::SHA256 sha;
+	for (char c : key_base64) {
+		if (c != '\n' && c != '\r') {
+			sha.Update(reinterpret_cast<const CryptoPP::byte*>(&c), 1);
+		}
+	}
+	sha.Final(reinterpret_cast<CryptoPP::byte*>(digest));
+}
+
+/** saveRSAKeyCache
+ * Saves the RSA private key with its CRT parameters in the binary 'priv.cache' format.
+ *
+ * @param cache_path The path of the cache file.
+ * @param uuid The UUID of the client the key belongs to, a cache of another registration is never loaded.
+ * @param key_base64 The private key as saved in 'me.info', a cache of another key is never loaded.
+ * @param rsa_wrapper The client's RSA private key.
+ *
+ * The cache is written next to 'me.info' and 'priv.key', which stay the source of truth -
+ * if the cache is missing, invalid or doesn't match 'me.info', the key is loaded from them as before.
+ */
+void saveRSAKeyCache(const string& cache_path, const UUID& uuid, const string& key_base64, const RSAPrivateWrapper& rsa_wrapper) {
+	const CryptoPP::RSA::PrivateKey& key = rsa_wrapper.getKey();
+	RSAKeyCacheRecord record;
+
+	memcpy(record.magic, KEY_CACHE_MAGIC, sizeof(record.magic));
+	std::copy(uuid.begin(), uuid.end(), record.uuid);
+	digestKeyBase64(key_base64, record.key_digest);
+	encodeInteger(key.GetModulus(), record.modulus, sizeof(record.modulus));
+	encodeInteger(key.GetPublicExponent(), record.public_exponent, sizeof(record.public_exponent));
+	encodeInteger(key.GetPrivateExponent(), record.private_exponent, sizeof(record.private_exponent));
+	encodeInteger(key.GetPrime1(), record.prime1, sizeof(record.prime1));
+	encodeInteger(key.GetPrime2(), record.prime2, sizeof(record.prime2));
+	encodeInteger(key.GetModPrime1PrivateExponent(), record.prime1_exponent, sizeof(record.prime1_exponent));
+	encodeInteger(key.GetModPrime2PrivateExponent(), record.prime2_exponent, sizeof(record.prime2_exponent));
+	encodeInteger(key.GetMultiplicativeInverseOfPrime2ModPrime1(), record.coefficient, sizeof(record.coefficient));
+
+	CryptoPP::SHA256().CalculateDigest(reinterpret_cast<CryptoPP::byte*>(record.digest),
+		reinterpret_cast<const CryptoPP::byte*>(&record), offsetof(RSAKeyCacheRecord, digest));
+
+	ofstream cache_file(cache_path, std::ios::binary | std::ios::trunc);
+	if (!cache_file.is_open()) {
+		throw std::runtime_error("Error opening the 'priv.cache' file");
+	}
+	cache_file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+	cache_file.close();
+}
+
+/** loadRSAKeyCache
+ * Builds the RSA decryptor straight from the binary key cache, without Base64 or ASN.1 parsing.
+ *
+ * @param cache_path The path of the cache file.
+ * @param uuid The UUID read from 'me.info'.
+ * @param key_base64 The private key read from 'me.info'.
+ * @return The RSA private key, or nullptr if there is no usable cache.
+ *
+ * This function performs the following steps:
+ * 1. Maps the cache file into memory and checks it is exactly one RSAKeyCacheRecord long.
+ * 2. Verifies the magic, that the cache belongs to the given UUID and to the key in 'me.info' (a stale cache
+ *    of an earlier key is ignored), and the SHA-256 digest of the record.
+ * 3. Initializes the private key directly from the cached integers.
+ */
+std::unique_ptr<RSAPrivateWrapper> loadRSAKeyCache(const string& cache_path, const UUID& uuid, const string& key_base64) {
+	if (!std::filesystem::exists(cache_path) || std::filesystem::file_size(cache_path) != sizeof(RSAKeyCacheRecord)) {
+		return nullptr;
+	}
+
+	boost::interprocess::file_mapping cache_mapping;
+	boost::interprocess::mapped_region cache_region;
+	try {
+		cache_mapping = boost::interprocess::file_mapping(cache_path.c_str(), boost::interprocess::read_only);
+		cache_region = boost::interprocess::mapped_region(cache_mapping, boost::interprocess::read_only);
+	}
+	catch (boost::interprocess::interprocess_exception& e) {
+		LOG_WARNING({}, "%s", e.what());
+		return nullptr;
+	}
+	const RSAKeyCacheRecord& record = *static_cast<const RSAKeyCacheRecord*>(cache_region.get_address());
+
+	char key_digest[KEY_CACHE_DIGEST_SIZE];
+	digestKeyBase64(key_base64, key_digest);
+	if (memcmp(record.magic, KEY_CACHE_MAGIC, sizeof(record.magic)) != 0 || !std::equal(uuid.begin(), uuid.end(), record.uuid)
+		|| memcmp(record.key_digest, key_digest, sizeof(key_digest)) != 0) {
+		return nullptr;
+	}
+	if (!CryptoPP::SHA256().VerifyDigest(reinterpret_cast<const CryptoPP::byte*>(record.digest),
+		reinterpret_cast<const CryptoPP::byte*>(&record), offsetof(RSAKeyCacheRecord, digest))) {
+		return nullptr;
+	}
+
+	return std::make_unique<RSAPrivateWrapper>(
+		decodeInteger(record.modulus, sizeof(record.modulus)),
+		decodeInteger(record.public_exponent, sizeof(record.public_exponent)),
+		decodeInteger(record.private_exponent, sizeof(record.private_exponent)),
+		decodeInteger(record.prime1, sizeof(record.prime1)),
+		decodeInteger(record.prime2, sizeof(record.prime2)),
+		decodeInteger(record.prime1_exponent, sizeof(record.prime1_exponent)),
+		decodeInteger(record.prime2_exponent, sizeof(record.prime2_exponent)),
+		decodeInteger(record.coefficient, sizeof(record.coefficient)));
+}
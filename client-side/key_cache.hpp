@@ -0,0 +1,32 @@
+#ifndef KEY_CACHE_HPP
+#define KEY_CACHE_HPP
+#include "utils.hpp"
+
+#include <memory>
+
+constexpr size_t RSA_MODULUS_SIZE = RSAPrivateWrapper::BITS / 8;
+constexpr size_t RSA_PRIME_SIZE = RSA_MODULUS_SIZE / 2;
+constexpr size_t KEY_CACHE_DIGEST_SIZE = 32;
+
+// The layout of the 'priv.cache' file - the client's RSA private key with its CRT parameters already
+// parsed into fixed size big-endian integers. Every field is a char array so the struct has no padding
+// and can be used directly over the mapped file.
+struct RSAKeyCacheRecord {
+	char magic[8];
+	char uuid[UUID_SIZE];
+	char key_digest[KEY_CACHE_DIGEST_SIZE]; // SHA-256 of the Base64 private key in 'me.info' (without line breaks)
+	char modulus[RSA_MODULUS_SIZE];
+	char public_exponent[RSA_MODULUS_SIZE];
+	char private_exponent[RSA_MODULUS_SIZE];
+	char prime1[RSA_PRIME_SIZE];
+	char prime2[RSA_PRIME_SIZE];
+	char prime1_exponent[RSA_PRIME_SIZE];
+	char prime2_exponent[RSA_PRIME_SIZE];
+	char coefficient[RSA_PRIME_SIZE];
+	char digest[KEY_CACHE_DIGEST_SIZE]; // SHA-256 of all the fields above
+};
+
+void saveRSAKeyCache(const string& cache_path, const UUID& uuid, const string& key_base64, const RSAPrivateWrapper& rsa_wrapper);
+std::unique_ptr<RSAPrivateWrapper> loadRSAKeyCache(const string& cache_path, const UUID& uuid, const string& key_base64);
+
+#endif
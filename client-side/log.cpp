@@ -0,0 +1,201 @@
+#include "log.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <boost/uuid/uuid_io.hpp>
+
+// The ring is a bounded multi-producer queue: a producer claims a slot by advancing enqueue_position, formats
+// its message into it and publishes it by bumping the slot's sequence. Only the flusher thread dequeues.
+struct LogSlot {
+	std::atomic<size_t> sequence;
+	LogRecord record;
+};
+
+static LogSlot log_ring[LOG_RING_CAPACITY];
+static std::atomic<size_t> enqueue_position(0);
+static size_t dequeue_position = 0; // only touched by the flusher
+static std::atomic<size_t> dropped_messages(0);
+
+// Set by startLogger and stopLogger, while no other thread logs. Before and after, messages are written directly.
+static bool logger_running = false;
+static std::atomic<bool> logger_stopping(false);
+static std::thread flusher_thread;
+static std::mutex flusher_mutex;
+static std::condition_variable flusher_wakeup;
+
+constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(50); // the flusher's longest sleep, if a wakeup was missed
+
+static const char* const LEVEL_PREFIXES[] = { "debug: ", "", "warning: ", "error: " };
+
+static void formatRecord(const LogRecord& record, std::string& line) {
+	line.assign(LEVEL_PREFIXES[static_cast<int>(record.level)]);
+	line.append(record.message);
+	if (record.has_uuid) {
+		line.append(" uuid=").append(boost::uuids::to_string(record.uuid));
+	}
+	if (record.code >= 0) {
+		line.append(" code=").append(std::to_string(record.code));
+	}
+	if (record.packet >= 0) {
+		line.append(" packet=").append(std::to_string(record.packet));
+	}
+	line.push_back('\n');
+}
+
+static std::ostream& streamFor(LogLevel level) {
+	return level >= LogLevel::Warning ? std::cerr : std::cout;
+}
+
+/** flushRing
+ * Writes every message published in the ring to the console and frees their slots.
+ *
+ * Info and debug messages go to stdout and warnings and errors to stderr, in the order they were logged.
+ * A stream is flushed only when the next message goes to the other one and at the end, not after every line.
+ */
+static void flushRing(std::string& line) {
+	std::ostream* current = nullptr;
+	for (;;) {
+		LogSlot& slot = log_ring[dequeue_position & (LOG_RING_CAPACITY - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != dequeue_position + 1) {
+			break;
+		}
+		formatRecord(slot.record, line);
+		std::ostream& stream = streamFor(slot.record.level);
+		slot.sequence.store(dequeue_position + LOG_RING_CAPACITY, std::memory_order_release);
+		dequeue_position++;
+
+		if (current != nullptr && current != &stream) {
+			current->flush();
+		}
+		current = &stream;
+		stream.write(line.data(), line.size());
+	}
+
+	size_t dropped = dropped_messages.exchange(0, std::memory_order_relaxed);
+	if (dropped > 0) {
+		std::cerr << "warning: the log was full, " << dropped << " messages were dropped\n";
+	}
+	if (current != nullptr) {
+		current->flush();
+	}
+}
+
+static void flusherLoop() {
+	std::string line;
+	line.reserve(LOG_MESSAGE_SIZE + 96);
+	while (!logger_stopping.load(std::memory_order_acquire)) {
+		{
+			std::unique_lock<std::mutex> lock(flusher_mutex);
+			flusher_wakeup.wait_for(lock, FLUSH_INTERVAL);
+		}
+		flushRing(line);
+	}
+	flushRing(line);
+}
+
+/** startLogger
+ * Starts the thread that writes the log to the console.
+ * Must be called before the client starts any other thread.
+ */
+void startLogger() {
+	for (size_t i = 0; i < LOG_RING_CAPACITY; i++) {
+		log_ring[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	enqueue_position.store(0, std::memory_order_relaxed);
+	dequeue_position = 0;
+	logger_stopping.store(false, std::memory_order_relaxed);
+	flusher_thread = std::thread(flusherLoop);
+	logger_running = true;
+}
+
+/** stopLogger
+ * Writes the messages still in the ring and stops the flusher thread.
+ * Must be called after the client's other threads stopped logging.
+ */
+void stopLogger() {
+	if (!logger_running) {
+		return;
+	}
+	logger_stopping.store(true, std::memory_order_release);
+	flusher_wakeup.notify_one();
+	flusher_thread.join();
+	logger_running = false;
+}
+
+static void formatMessage(LogRecord& record, LogLevel level, const LogFields& fields, const char* format, va_list arguments) {
+	record.level = level;
+	record.setFields(fields);
+	if (vsnprintf(record.message, sizeof(record.message), format, arguments) < 0) {
+		record.message[0] = '\0';
+	}
+}
+
+/** logMessage
+ * Logs a printf style message with its structured fields. Use the LOG_* macros, which compile out the levels
+ * below LOG_MIN_LEVEL.
+ *
+ * This function performs the following steps:
+ * 1. Claims the next free slot of the ring, without taking a lock. If the ring is full, a debug or info
+ *    message is dropped and counted (the flusher reports how many were lost), and a warning or error waits
+ *    for the flusher to free a slot.
+ * 2. Formats the message and copies the fields into the slot.
+ * 3. Publishes the slot and wakes the flusher thread, which writes it to the console.
+ * Before startLogger and after stopLogger the message is written to the console directly.
+ *
+ * @param level The message's level.
+ * @param fields The message's uuid, code and packet fields, any of which may be left unset.
+ * @param format The printf format of the message.
+ */
+void logMessage(LogLevel level, const LogFields& fields, const char* format, ...) {
+	va_list arguments;
+	va_start(arguments, format);
+
+	if (!logger_running) {
+		LogRecord record;
+		formatMessage(record, level, fields, format, arguments);
+		va_end(arguments);
+		std::string line;
+		formatRecord(record, line);
+		streamFor(level) << line << std::flush;
+		return;
+	}
+
+	size_t position = enqueue_position.load(std::memory_order_relaxed);
+	LogSlot* slot;
+	for (;;) {
+		slot = &log_ring[position & (LOG_RING_CAPACITY - 1)];
+		size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		if (sequence == position) {
+			if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if (sequence < position) {
+			// the flusher hasn't freed this slot yet: the ring is full. Warnings and errors wait for it.
+			if (level < LogLevel::Warning) {
+				va_end(arguments);
+				dropped_messages.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			flusher_wakeup.notify_one();
+			std::this_thread::yield();
+			position = enqueue_position.load(std::memory_order_relaxed);
+		}
+		else {
+			position = enqueue_position.load(std::memory_order_relaxed);
+		}
+	}
+
+	formatMessage(slot->record, level, fields, format, arguments);
+	va_end(arguments);
+	slot->sequence.store(position + 1, std::memory_order_release);
+	flusher_wakeup.notify_one();
+}
@@ -0,0 +1,83 @@
+#ifndef LOG_HPP
+#define LOG_HPP
+
+#include <cstdint>
+
+#include <boost/uuid/uuid.hpp>
+
+enum class LogLevel {
+	Debug,
+	Info,
+	Warning,
+	Error
+};
+
+// Messages below this level are compiled out: their arguments aren't even evaluated. Debug messages are only
+// kept in debug builds, unless the build defines LOG_MIN_LEVEL itself (0 debug, 1 info, 2 warning, 3 error).
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL 1
+#else
+#define LOG_MIN_LEVEL 0
+#endif
+#endif
+
+constexpr size_t LOG_MESSAGE_SIZE = 256;     // longer messages are cut
+constexpr size_t LOG_RING_CAPACITY = 1024;   // debug and info messages logged while the ring is full are dropped (and counted)
+static_assert((LOG_RING_CAPACITY & (LOG_RING_CAPACITY - 1)) == 0, "the ring's capacity must be a power of two");
+
+// The structured fields of a message, written after it as key=value pairs. Every field is optional.
+class LogFields {
+private:
+	boost::uuids::uuid uuid_value = {};
+	bool has_uuid = false;
+	int code = -1;        // a request or response code
+	int64_t packet = -1;  // the SendFile packet the message is about, 1-based like the packet number in its payload
+
+public:
+	LogFields& withUuid(const boost::uuids::uuid& uuid) { this->uuid_value = uuid; this->has_uuid = true; return *this; }
+	LogFields& withCode(int code) { this->code = code; return *this; }
+	LogFields& withPacket(int64_t packet) { this->packet = packet; return *this; }
+
+	friend struct LogRecord;
+};
+
+// A message waiting in the ring for the flusher thread. It's formatted in place, so logging doesn't allocate.
+struct LogRecord {
+	LogLevel level;
+	bool has_uuid;
+	boost::uuids::uuid uuid;
+	int code;
+	int64_t packet;
+	char message[LOG_MESSAGE_SIZE];
+
+	void setFields(const LogFields& fields) {
+		this->has_uuid = fields.has_uuid;
+		this->uuid = fields.uuid_value;
+		this->code = fields.code;
+		this->packet = fields.packet;
+	}
+};
+
+void startLogger();
+void stopLogger();
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((format(printf, 3, 4)))
+#endif
+void logMessage(LogLevel level, const LogFields& fields, const char* format, ...);
+
+// LOG_INFO({}, "RESPONSE CRC %lu", cksum) or LOG_WARNING(LogFields().withUuid(uuid).withCode(code), "...", ...)
+#define LOG_AT(level, fields, ...) \
+	do { \
+		if constexpr (static_cast<int>(level) >= LOG_MIN_LEVEL) { \
+			logMessage(level, fields, __VA_ARGS__); \
+		} \
+	} while (0)
+
+#define LOG_DEBUG(fields, ...) LOG_AT(LogLevel::Debug, fields, __VA_ARGS__)
+#define LOG_INFO(fields, ...) LOG_AT(LogLevel::Info, fields, __VA_ARGS__)
+#define LOG_WARNING(fields, ...) LOG_AT(LogLevel::Warning, fields, __VA_ARGS__)
+#define LOG_ERROR(fields, ...) LOG_AT(LogLevel::Error, fields, __VA_ARGS__)
+
+#endif
@@ -1,10 +1,10 @@
-#ifndef MESSAGE_HEADERS_SIZES_HPP
-#define MESSAGE_HEADERS_SIZES_HPP
-#include "utils.hpp"
-
-enum MessageHeaderSizes {
-	REQUEST_HEADER = 23,
-	RESPONSE_HEADER = 7
-};
-
+#ifndef MESSAGE_HEADERS_SIZES_HPP
+#define MESSAGE_HEADERS_SIZES_HPP
+#include "utils.hpp"
+
+enum MessageHeaderSizes {
+	REQUEST_HEADER = 23,
+	RESPONSE_HEADER = 7
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "metrics.hpp"
+#include "utils.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+constexpr auto METRICS_THROUGHPUT_WINDOW = std::chrono::milliseconds(250);
+
+TransferMetrics transfer_metrics = {};
+
+static const uint16_t METRICS_REQUEST_CODES[METRICS_REQUEST_KINDS] = {
+	Codes::REGISTRATION_CODE,
+	Codes::SENDING_PUBLIC_KEY_CODE,
+	Codes::RECONNECTION_CODE,
+	Codes::SENDING_FILE_CODE,
+	Codes::RESUMPTION_CODE,
+	Codes::RESUMPTION_TICKET_REQUEST_CODE,
+	Codes::SENDING_X25519_PUBLIC_KEY_CODE,
+	Codes::EARLY_DATA_RESUMPTION_CODE,
+	Codes::VALID_CRC_CODE,
+	Codes::SENDING_CRC_AGAIN_CODE,
+	Codes::INVALID_CRC_DONE_CODE,
+};
+
+// The last sample the throughput was computed from, shared by every reader.
+static std::mutex throughput_mutex;
+static std::chrono::steady_clock::time_point throughput_sample_time = std::chrono::steady_clock::now();
+static uint64_t throughput_sample_bytes = 0;
+static double throughput = 0;
+
+// The progress thread, between startProgressReporting and stopProgressReporting.
+static std::thread progress_thread;
+static std::mutex progress_mutex;
+static std::condition_variable progress_wakeup;
+static bool progress_stopping = false;
+
+uint16_t metricsRequestCode(size_t kind) {
+	return METRICS_REQUEST_CODES[kind];
+}
+
+/** countRetry
+ * Counts another attempt of a request whose previous attempt failed.
+ *
+ * @param request_code The request's code, other codes are ignored.
+ */
+void countRetry(uint16_t request_code) {
+	for (size_t kind = 0; kind < METRICS_REQUEST_KINDS; kind++) {
+		if (METRICS_REQUEST_CODES[kind] == request_code) {
+			transfer_metrics.retries[kind].fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+	}
+}
+
+/** readMetrics
+ * Reads the counters, and derives the current throughput and the ETA of the file's write from them.
+ *
+ * This function performs the following steps:
+ * 1. Copies every counter.
+ * 2. If at least METRICS_THROUGHPUT_WINDOW passed since the last sample, computes the throughput of the bytes
+ *    written since then and takes a new sample. Otherwise keeps the last throughput, so readers polling
+ *    faster than the window still see a smooth value.
+ * 3. Computes the ETA from what is left of the file's write at that throughput.
+ * Safe to call from any thread - it never touches the send path.
+ *
+ * @return The snapshot.
+ */
+MetricsSnapshot readMetrics() {
+	MetricsSnapshot snapshot;
+	snapshot.bytes_encrypted = transfer_metrics.bytes_encrypted.load(std::memory_order_relaxed);
+	snapshot.bytes_written = transfer_metrics.bytes_written.load(std::memory_order_relaxed);
+	snapshot.packets_sent = transfer_metrics.packets_sent.load(std::memory_order_relaxed);
+	for (size_t kind = 0; kind < METRICS_REQUEST_KINDS; kind++) {
+		snapshot.retries[kind] = transfer_metrics.retries[kind].load(std::memory_order_relaxed);
+	}
+	snapshot.crc_mismatches = transfer_metrics.crc_mismatches.load(std::memory_order_relaxed);
+	snapshot.bulk_write_bytes = transfer_metrics.bulk_write_bytes.load(std::memory_order_relaxed);
+	snapshot.bulk_write_written = std::min(transfer_metrics.bulk_write_written.load(std::memory_order_relaxed), snapshot.bulk_write_bytes);
+
+	{
+		std::lock_guard<std::mutex> lock(throughput_mutex);
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (now - throughput_sample_time >= METRICS_THROUGHPUT_WINDOW) {
+			double seconds = std::chrono::duration<double>(now - throughput_sample_time).count();
+			throughput = (snapshot.bytes_written - throughput_sample_bytes) / seconds;
+			throughput_sample_time = now;
+			throughput_sample_bytes = snapshot.bytes_written;
+		}
+		snapshot.throughput_bytes_per_second = throughput;
+	}
+
+	uint64_t remaining = snapshot.bulk_write_bytes - snapshot.bulk_write_written;
+	if (snapshot.bulk_write_bytes == 0) {
+		snapshot.eta_seconds = -1;
+	}
+	else if (remaining == 0) {
+		snapshot.eta_seconds = 0;
+	}
+	else {
+		snapshot.eta_seconds = snapshot.throughput_bytes_per_second > 0 ? remaining / snapshot.throughput_bytes_per_second : -1;
+	}
+	return snapshot;
+}
+
+/** startProgressReporting
+ * Calls a callback with a snapshot of the metrics every interval, on a thread of its own.
+ *
+ * The send path only bumps counters, so however slow the callback is it can't hold back the transfer - it
+ * only delays its own next call. The callback is called one last time by stopProgressReporting.
+ *
+ * @param callback The callback, called from the progress thread.
+ * @param interval The time between two calls.
+ */
+void startProgressReporting(ProgressCallback callback, std::chrono::milliseconds interval) {
+	stopProgressReporting();
+	progress_stopping = false;
+	progress_thread = std::thread([callback, interval]() {
+		std::unique_lock<std::mutex> lock(progress_mutex);
+		for (;;) {
+			bool stopping = progress_wakeup.wait_for(lock, interval, []() { return progress_stopping; });
+			lock.unlock();
+			callback(readMetrics());
+			lock.lock();
+			if (stopping) {
+				return;
+			}
+		}
+	});
+}
+
+/** stopProgressReporting
+ * Stops the progress thread, after a last call of the callback with the final metrics.
+ */
+void stopProgressReporting() {
+	if (!progress_thread.joinable()) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(progress_mutex);
+		progress_stopping = true;
+	}
+	progress_wakeup.notify_one();
+	progress_thread.join();
+}
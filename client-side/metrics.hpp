@@ -0,0 +1,73 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+constexpr size_t METRICS_REQUEST_KINDS = 11; // the request codes retries are counted for, see metricsRequestCode
+
+// Live counters of the client's work, for a program embedding the client to show its progress.
+// Unlike the run report they are always on: every hook below is a relaxed atomic add, and nothing else
+// happens on the send path. The throughput and the ETA are derived by whoever reads them (readMetrics).
+struct TransferMetrics {
+	std::atomic<uint64_t> bytes_encrypted;       // plaintext of the files encrypted so far
+	std::atomic<uint64_t> bytes_written;         // every request, as the socket accepts it
+	std::atomic<uint64_t> packets_sent;          // every SendFile packet counts as one, like the run report's requests
+	std::atomic<uint64_t> retries[METRICS_REQUEST_KINDS];
+	std::atomic<uint64_t> crc_mismatches;        // the server's CRC of the file differed from ours
+	std::atomic<uint64_t> bulk_write_bytes;      // gauge: the size of the write carrying the file's packets, 0 before
+	std::atomic<uint64_t> bulk_write_written;    // gauge: how much of it the socket accepted so far
+};
+
+extern TransferMetrics transfer_metrics;
+
+// A copy of the counters, each read on its own (they may be a few bytes apart), with the derived rates.
+struct MetricsSnapshot {
+	uint64_t bytes_encrypted;
+	uint64_t bytes_written;
+	uint64_t packets_sent;
+	uint64_t retries[METRICS_REQUEST_KINDS];
+	uint64_t crc_mismatches;
+	uint64_t bulk_write_bytes;
+	uint64_t bulk_write_written;
+	double throughput_bytes_per_second;          // bytes written per second, over the last METRICS_THROUGHPUT_WINDOW or more
+	double eta_seconds;                          // until the file's write is done, -1 while unknown
+};
+
+using ProgressCallback = std::function<void(const MetricsSnapshot&)>;
+
+uint16_t metricsRequestCode(size_t kind);        // the request code of retries[kind]
+MetricsSnapshot readMetrics();
+void startProgressReporting(ProgressCallback callback, std::chrono::milliseconds interval);
+void stopProgressReporting();
+void countRetry(uint16_t request_code);
+
+inline void countBytesEncrypted(size_t bytes) {
+	transfer_metrics.bytes_encrypted.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+inline void countPacketsSent(size_t packets) {
+	transfer_metrics.packets_sent.fetch_add(packets, std::memory_order_relaxed);
+}
+
+inline void countCrcMismatch() {
+	transfer_metrics.crc_mismatches.fetch_add(1, std::memory_order_relaxed);
+}
+
+// A write carrying the file's packets starts: the ETA counts down to its end.
+inline void startBulkWrite(size_t bytes) {
+	transfer_metrics.bulk_write_written.store(0, std::memory_order_relaxed);
+	transfer_metrics.bulk_write_bytes.store(bytes, std::memory_order_relaxed);
+}
+
+inline void countBytesWritten(size_t bytes, bool bulk) {
+	transfer_metrics.bytes_written.fetch_add(bytes, std::memory_order_relaxed);
+	if (bulk) {
+		transfer_metrics.bulk_write_written.fetch_add(bytes, std::memory_order_relaxed);
+	}
+}
+
+#endif
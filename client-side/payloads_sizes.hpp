@@ -1,25 +1,34 @@
-#ifndef PAYLODS_SIZES_HPP
-#define PAYLODS_SIZES_HPP
-#include "utils.hpp"
-
-// 32 bits = 4 bytes
-enum PayloadSize : uint32_t {
-	REGISTRATION_PAYLOAD_SIZE = 255,
-	SENDING_PUBLIC_KEY_PAYLOAD_SIZE = 415,
-	RECONNECTION_PAYLOAD_SIZE = 255,
-	SEND_FILE_PAYLOAD_SIZE = 1291,
-	VALID_CRC_PAYLOAD_SIZE = 255,
-	INVALID_CRC_PAYLOAD_SIZE = 255,
-	INVALID_CRC_DONE_PAYLOAD_SIZE = 255,
-
-	REGISTRATION_SUCCEEDED_PAYLOAD_SIZE = 16,
-	REGISTRATION_FAILED_PAYLOAD_SIZE = 0,
-	PUBLIC_KEY_RECEIVED_PAYLOAD_SIZE = 144,
-	FILE_RECEIVED_CRC_PAYLOAD_SIZE = 279,
-	MESSAGE_RECEIVED_PAYLOAD_SIZE = 16,
-	RECONNECTION_SUCCEEDED_PAYLOAD_SIZE_WITHOUT_AES_KEY_SIZE = 144,
-	RECONNECTION_FAILED_PAYLOAD_SIZE = 16,
-	GENERAL_ERROR_PAYLOAD_SIZE = 0
-};
-
+#ifndef PAYLODS_SIZES_HPP
+#define PAYLODS_SIZES_HPP
+#include "utils.hpp"
+
+// 32 bits = 4 bytes
+enum PayloadSize : uint32_t {
+	REGISTRATION_PAYLOAD_SIZE = 255,
+	SENDING_PUBLIC_KEY_PAYLOAD_SIZE = 415,
+	RECONNECTION_PAYLOAD_SIZE = 255,
+	SEND_FILE_PAYLOAD_SIZE = 1291,
+	VALID_CRC_PAYLOAD_SIZE = 255,
+	INVALID_CRC_PAYLOAD_SIZE = 255,
+	INVALID_CRC_DONE_PAYLOAD_SIZE = 255,
+	RESUMPTION_PAYLOAD_SIZE = 383,
+	RESUMPTION_TICKET_REQUEST_PAYLOAD_SIZE = 255,
+	SENDING_X25519_PUBLIC_KEY_PAYLOAD_SIZE = 287,
+	EARLY_DATA_RESUMPTION_PAYLOAD_SIZE = 387,
+
+	REGISTRATION_SUCCEEDED_PAYLOAD_SIZE = 16,
+	REGISTRATION_FAILED_PAYLOAD_SIZE = 0,
+	PUBLIC_KEY_RECEIVED_PAYLOAD_SIZE = 144,
+	FILE_RECEIVED_CRC_PAYLOAD_SIZE = 279,
+	MESSAGE_RECEIVED_PAYLOAD_SIZE = 16,
+	RECONNECTION_SUCCEEDED_PAYLOAD_SIZE_WITHOUT_AES_KEY_SIZE = 144,
+	RECONNECTION_FAILED_PAYLOAD_SIZE = 16,
+	GENERAL_ERROR_PAYLOAD_SIZE = 0,
+	RESUMPTION_SUCCEEDED_PAYLOAD_SIZE = 144,
+	RESUMPTION_FAILED_PAYLOAD_SIZE = 16,
+	RESUMPTION_TICKET_PAYLOAD_SIZE = 128,
+	X25519_PUBLIC_KEY_RECEIVED_PAYLOAD_SIZE = 48,
+	RECONNECTION_X25519_SUCCEEDED_PAYLOAD_SIZE = 48
+};
+
 #endif
\ No newline at end of file
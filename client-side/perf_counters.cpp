@@ -0,0 +1,334 @@
+#include "perf_counters.hpp"
+#include "run_report.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+
+#ifdef HAVE_PERF_EVENTS
+#include <cerrno>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+bool profiling_enabled = false;
+
+static string profile_path;
+static string unavailable_reason;               // why the profile has no counters, empty when it has them
+static bool kernel_counted = true;              // false when the kernel only lets us count user space
+static bool counter_opened[PERF_COUNTERS] = {}; // the counters the PMU has, every thread opens the same ones
+
+// The counters of every phase, summed over every time it ran and every thread it ran on.
+struct PhaseCounters {
+	std::atomic<uint64_t> count;
+	std::atomic<uint64_t> values[PERF_COUNTERS];
+};
+static PhaseCounters phase_counters[static_cast<size_t>(RunPhase::Count)] = {};
+
+static const char* const COUNTER_NAMES[] = {
+	"cycles",
+	"instructions",
+	"cache_misses",
+	"branch_misses",
+};
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == PERF_COUNTERS, "every counter needs a name in the profile");
+
+#ifdef HAVE_PERF_EVENTS
+static const uint64_t COUNTER_CONFIGS[] = {
+	PERF_COUNT_HW_CPU_CYCLES,
+	PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_CACHE_MISSES,
+	PERF_COUNT_HW_BRANCH_MISSES,
+};
+static_assert(sizeof(COUNTER_CONFIGS) / sizeof(COUNTER_CONFIGS[0]) == PERF_COUNTERS, "every counter needs a perf event");
+
+static int openCounter(uint64_t config, int group_fd, bool count_kernel) {
+	perf_event_attr attr = {};
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = config;
+	attr.disabled = group_fd == -1; // the leader is enabled once the whole group is open
+	attr.exclude_kernel = !count_kernel;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	// pid 0 and cpu -1: the calling thread, on whatever cpu it runs.
+	return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+}
+
+// The counters of one thread, opened as a group so the kernel schedules (and multiplexes) them together
+// and a single read returns all of them.
+class PerfGroup {
+private:
+	int fds[PERF_COUNTERS];
+	int leader;
+
+public:
+	PerfGroup() : leader(-1) {
+		std::fill(std::begin(this->fds), std::end(this->fds), -1);
+	}
+
+	~PerfGroup() {
+		for (int fd : this->fds) {
+			if (fd >= 0) {
+				close(fd);
+			}
+		}
+	}
+
+	PerfGroup(const PerfGroup&) = delete;
+	PerfGroup& operator=(const PerfGroup&) = delete;
+
+	/** open
+	 * Opens the group's counters on the calling thread and starts them.
+	 *
+	 * @param count_kernel Whether to count what the kernel does on the thread's behalf (the sends' system calls).
+	 * @param probe True on the first thread: counters the PMU doesn't have are left out of counter_opened
+	 *              instead of failing the group. The other threads open what the first one could.
+	 * @return 0, or the errno of the counter that couldn't be opened.
+	 */
+	int open(bool count_kernel, bool probe) {
+		for (size_t i = 0; i < PERF_COUNTERS; i++) {
+			if (!probe && !counter_opened[i]) {
+				continue;
+			}
+			this->fds[i] = openCounter(COUNTER_CONFIGS[i], this->leader, count_kernel);
+			if (this->fds[i] < 0) {
+				int error = errno;
+				if (probe && (error == ENOENT || error == EOPNOTSUPP || error == EINVAL)) {
+					counter_opened[i] = false;
+					continue;
+				}
+				return error;
+			}
+			if (probe) {
+				counter_opened[i] = true;
+			}
+			if (this->leader == -1) {
+				this->leader = this->fds[i];
+			}
+		}
+		if (this->leader == -1) {
+			return ENOENT;
+		}
+		if (ioctl(this->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) != 0) {
+			return errno;
+		}
+		return 0;
+	}
+
+	void read(PerfReading& reading) const {
+		// nr, time_enabled, time_running, then a value per counter in the order they were opened.
+		uint64_t buffer[3 + PERF_COUNTERS];
+		reading.valid = this->leader >= 0 && ::read(this->leader, buffer, sizeof(buffer)) > 0;
+		if (!reading.valid) {
+			return;
+		}
+		reading.time_enabled = buffer[1];
+		reading.time_running = buffer[2];
+		size_t slot = 3;
+		for (size_t i = 0; i < PERF_COUNTERS; i++) {
+			reading.values[i] = counter_opened[i] ? buffer[slot++] : 0;
+		}
+	}
+};
+
+// The calling thread's group, opened the first time the thread reads its counters and closed when it exits.
+// A thread whose group couldn't be opened keeps it, so it doesn't retry on every phase.
+static thread_local std::unique_ptr<PerfGroup> thread_perf_group;
+
+static string perfEventParanoid() {
+	ifstream paranoid_file("/proc/sys/kernel/perf_event_paranoid");
+	string level;
+	paranoid_file >> level;
+	return level;
+}
+
+// Opens the calling thread's group, and returns why it can't be used (empty if it can).
+static string probeCounters() {
+	thread_perf_group = std::make_unique<PerfGroup>();
+	int error = thread_perf_group->open(true, true);
+	if (error == EACCES || error == EPERM) {
+		// kernel.perf_event_paranoid 2 still allows counting user space.
+		thread_perf_group = std::make_unique<PerfGroup>();
+		error = thread_perf_group->open(false, true);
+		kernel_counted = false;
+	}
+	if (error == 0) {
+		return "";
+	}
+
+	thread_perf_group.reset();
+	string reason = string("perf_event_open failed: ") + strerror(error);
+	if (error == EACCES || error == EPERM) {
+		string paranoid = perfEventParanoid();
+		reason += paranoid.empty() ? " (perf events may be blocked by a seccomp profile)" : " (kernel.perf_event_paranoid is " + paranoid + ")";
+	}
+	else if (error == ENOENT) {
+		reason += " (the CPU exposes no hardware counters, as in many VMs)";
+	}
+	return reason;
+}
+#else
+static string probeCounters() {
+	return "hardware counters need perf_event_open, which this platform doesn't have";
+}
+#endif
+
+/** startProfiling
+ * Turns the profile on if the TRANSFER_PROFILE environment variable names a file to write it to.
+ *
+ * This function performs the following steps:
+ * 1. Opens the cycles, instructions, cache misses and branch misses counters on the calling thread, counting
+ *    the kernel's work too when it's allowed to and only user space otherwise. Counters the CPU doesn't
+ *    have (some VMs expose only a few) are left out.
+ * 2. If none can be opened, logs why and leaves the phase timers untouched: the profile then only holds
+ *    the reason, and the run goes on as usual.
+ * Must be called before the client starts any other thread.
+ */
+void startProfiling() {
+	profile_path = getEnvironmentVariable("TRANSFER_PROFILE");
+	if (profile_path.empty()) {
+		return;
+	}
+	unavailable_reason = probeCounters();
+	profiling_enabled = unavailable_reason.empty();
+	if (!profiling_enabled) {
+		LOG_WARNING({}, "Profiling without hardware counters: %s", unavailable_reason.c_str());
+	}
+	else if (!kernel_counted) {
+		LOG_INFO({}, "Profiling user space only, the kernel doesn't allow counting its side");
+	}
+}
+
+// Reads the calling thread's counters, opening them if it's the thread's first read.
+void readPerfCounters(PerfReading& reading) {
+	reading.valid = false;
+#ifdef HAVE_PERF_EVENTS
+	if (!thread_perf_group) {
+		thread_perf_group = std::make_unique<PerfGroup>();
+		if (thread_perf_group->open(kernel_counted, false) != 0) {
+			// a group missing some of the counters would be read as the wrong ones, keep none.
+			thread_perf_group = std::make_unique<PerfGroup>();
+		}
+	}
+	thread_perf_group->read(reading);
+#endif
+}
+
+/** recordPhaseCounters
+ * Adds what the calling thread's counters counted since start to the phase.
+ *
+ * When the kernel multiplexed the counters the difference is scaled by the time the group was enabled
+ * over the time it actually counted, like perf stat does.
+ *
+ * @param phase The RunPhase, as an index.
+ * @param start The thread's counters when the phase started.
+ */
+void recordPhaseCounters(size_t phase, const PerfReading& start) {
+	if (!start.valid) {
+		return;
+	}
+	PerfReading end;
+	readPerfCounters(end);
+	uint64_t running = end.time_running - start.time_running;
+	if (!end.valid || running == 0) {
+		return;
+	}
+	double scale = static_cast<double>(end.time_enabled - start.time_enabled) / running;
+	for (size_t i = 0; i < PERF_COUNTERS; i++) {
+		uint64_t value = static_cast<uint64_t>((end.values[i] - start.values[i]) * scale);
+		phase_counters[phase].values[i].fetch_add(value, std::memory_order_relaxed);
+	}
+	phase_counters[phase].count.fetch_add(1, std::memory_order_relaxed);
+}
+
+// The bytes a phase went through, for its cycles per byte: the file for the phases that walk it, its
+// ciphertext for the packing and the send. 0 for the control-plane phases.
+static uint64_t phaseBytes(RunPhase phase) {
+	switch (phase) {
+	case RunPhase::FileRead:
+	case RunPhase::LocalCrc:
+	case RunPhase::Encryption:
+		return run_counters.file_size.load();
+	case RunPhase::PacketPack:
+	case RunPhase::PacketSend:
+		return run_counters.encrypted_file_size.load();
+	default:
+		return 0;
+	}
+}
+
+/** writeProfile
+ * Appends the hardware counter profile of the run to the TRANSFER_PROFILE file, as one JSON object per line.
+ *
+ * For every phase that ran, the profile holds its counters summed over the threads it ran on, its IPC, and
+ * for the phases that walk the file its cycles per byte. Counters the CPU doesn't have are null. When no
+ * counter could be opened the object only holds "available":false and the reason.
+ */
+void writeProfile() {
+	if (profile_path.empty()) {
+		return;
+	}
+
+	std::ostringstream profile;
+	profile << std::fixed << std::setprecision(3);
+	if (!profiling_enabled) {
+		profile << "{\"available\":false,\"reason\":\"" << unavailable_reason << "\"}\n";
+	}
+	else {
+		profile << "{\"available\":true,\"kernel_counted\":" << (kernel_counted ? "true" : "false") << ",\"phases\":{";
+		bool first = true;
+		for (size_t phase = 0; phase < static_cast<size_t>(RunPhase::Count); phase++) {
+			const PhaseCounters& counters = phase_counters[phase];
+			if (counters.count.load() == 0) {
+				continue;
+			}
+			uint64_t bytes = phaseBytes(static_cast<RunPhase>(phase));
+			profile << (first ? "" : ",") << "\"" << runPhaseName(static_cast<RunPhase>(phase)) << "\":{\"count\":" << counters.count.load()
+				<< ",\"bytes\":" << bytes;
+			first = false;
+			for (size_t i = 0; i < PERF_COUNTERS; i++) {
+				profile << ",\"" << COUNTER_NAMES[i] << "\":";
+				if (counter_opened[i]) {
+					profile << counters.values[i].load();
+				}
+				else {
+					profile << "null";
+				}
+			}
+
+			size_t cycles = static_cast<size_t>(PerfCounter::Cycles);
+			size_t instructions = static_cast<size_t>(PerfCounter::Instructions);
+			profile << ",\"ipc\":";
+			if (counter_opened[cycles] && counter_opened[instructions] && counters.values[cycles].load() > 0) {
+				profile << static_cast<double>(counters.values[instructions].load()) / counters.values[cycles].load();
+			}
+			else {
+				profile << "null";
+			}
+			profile << ",\"cycles_per_byte\":";
+			if (counter_opened[cycles] && bytes > 0) {
+				profile << static_cast<double>(counters.values[cycles].load()) / bytes;
+			}
+			else {
+				profile << "null";
+			}
+			profile << "}";
+		}
+		profile << "}}\n";
+	}
+
+	ofstream profile_file(profile_path, std::ios::app);
+	if (!profile_file) {
+		LOG_WARNING({}, "Couldn't write the profile to %s", profile_path.c_str());
+		return;
+	}
+	profile_file << profile.str();
+}
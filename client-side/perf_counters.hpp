@@ -0,0 +1,41 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Hardware counters are only built where the kernel headers have perf_event_open. Everywhere else (and where
+// the kernel refuses to open them, see kernel.perf_event_paranoid) the profile only says why it's missing.
+#if defined(__linux__) && __has_include(<linux/perf_event.h>)
+#define HAVE_PERF_EVENTS 1
+#endif
+
+enum class PerfCounter {
+	Cycles,
+	Instructions,
+	CacheMisses,
+	BranchMisses,
+	Count
+};
+
+constexpr size_t PERF_COUNTERS = static_cast<size_t>(PerfCounter::Count);
+
+// The counters of the calling thread at some point, as the kernel reports them: the raw counts, and how long
+// the group was enabled and actually counting (they differ when the PMU is shared and the kernel multiplexes).
+struct PerfReading {
+	bool valid;
+	uint64_t values[PERF_COUNTERS];
+	uint64_t time_enabled;
+	uint64_t time_running;
+};
+
+// Set once by startProfiling, before the client starts any other thread. When it's false a phase timer
+// doesn't touch the counters at all.
+extern bool profiling_enabled;
+
+void startProfiling();
+void readPerfCounters(PerfReading& reading);
+void recordPhaseCounters(size_t phase, const PerfReading& start);
+void writeProfile();
+
+#endif
@@ -1,49 +1,64 @@
-#ifndef REQUEST_HPP
-#define REQUEST_HPP
-#include "utils.hpp"
-
-class RequestHeader {
-protected:
-	UUID uuid;
-	uint8_t version;
-	uint16_t code;
-	uint32_t payload_size;
-
-public:
-	RequestHeader(UUID uuid, uint16_t code, uint32_t payload_size);
-	UUID getUUID() const;
-
-	uint8_t getVersion() const;
-	uint16_t getCode() const;
-	uint32_t getPayloadSize() const;
-
-	void setUUIDFromRawBytes(const Bytes& uuid_bytes);
-
-	Bytes pack_header() const;
-};
-
-class Payload {
-public:
-//	virtual Bytes pack_payload() const = 0;
-	virtual ~Payload() = default; // Virtual destructor
-};
-
-class Request {
-protected:
-	RequestHeader header;
-
-public:
-	Request(RequestHeader header);
-
-	RequestHeader getHeader() const;
-	RequestHeader& getHeaderReference();
-
-	// Pure virtual function that returns a pointer to Payload to avoid object slicing
-	virtual const Payload* getPayload() const = 0;
-
-	// Pure Virtual function, each request derived class will implement this function.
-//	virtual Bytes pack_request() const = 0;
-	virtual int run(tcp::socket& sock) = 0;
-};
-
+#ifndef REQUEST_HPP
+#define REQUEST_HPP
+#include "utils.hpp"
+#include "response_reader.hpp"
+#include "socket_policy.hpp"
+
+class RequestHeader {
+protected:
+	UUID uuid;
+	uint8_t version;
+	uint16_t code;
+	uint32_t payload_size;
+
+public:
+	RequestHeader(UUID uuid, uint16_t code, uint32_t payload_size);
+	UUID getUUID() const;
+
+	uint8_t getVersion() const;
+	uint16_t getCode() const;
+	uint32_t getPayloadSize() const;
+
+	void setUUIDFromRawBytes(const Byte* uuid_bytes);
+
+	Bytes pack_header() const;
+	void pack_header(Byte* destination) const; // into REQUEST_HEADER_SIZE bytes, without allocating
+};
+
+class Payload {
+public:
+//	virtual Bytes pack_payload() const = 0;
+	virtual ~Payload() = default; // Virtual destructor
+};
+
+class Request {
+protected:
+	RequestHeader header;
+	Bytes packed_request; // packed once by getPackedRequest, every attempt writes the same bytes
+
+public:
+	Request(RequestHeader header);
+	virtual ~Request() = default;
+
+	RequestHeader getHeader() const;
+	RequestHeader& getHeaderReference();
+
+	// Pure virtual function that returns a pointer to Payload to avoid object slicing
+	virtual const Payload* getPayload() const = 0;
+
+	// Pure Virtual function, each request derived class will implement this function.
+	virtual Bytes pack_request() const = 0;
+	const Bytes& getPackedRequest();
+	// The number of protocol requests the packed request holds - more than one for the requests that carry the file's packets.
+	virtual size_t packetCount() const;
+
+	// Called by the transaction engine with a response that matched the request's row in the transaction table,
+	// and the result that row gives it. Throwing makes the engine count the attempt as failed.
+	virtual void handleResponse(const ResponseView& response, int result);
+
+	// Runs the request through the transaction engine (see transaction.hpp).
+	// The responses are received through the connection's reader, so bytes it read ahead aren't lost between requests.
+	virtual int run(ClientSocket& sock, ResponseReader& reader);
+};
+
 #endif 
\ No newline at end of file
@@ -1,653 +1,418 @@
-#include "utils.hpp"
-#include "requests.hpp"
-
-RegisterRequest::RegisterRequest(RequestHeader header, RegistrationPayload payload)
-	: Request(header), payload(payload) {}
-
-const RegistrationPayload* RegisterRequest::getPayload() const {
-	return &payload;  // Returning a pointer to payload
-}
-
-
-/*
-	This method packs the header and payload for the registration request in a form of uint8_t vector
-	All numeric fields are ordered by little endian order
-*/
-Bytes RegisterRequest::pack_request() const {
-	Bytes packed_header = this->getHeader().pack_header();
-	Bytes packed_payload = this->getPayload()->pack_payload();
-	Bytes request = packed_header + packed_payload;
-	return request;
-}
-
-
-/** RegisterRequest::run
- * Sends a registration request to the server and handles the response.
- *
- * This function performs the following steps:
- * 1. Packs the registration request fields into a byte vector.
- * 2. Attempts to send the request to the server via the provided socket.
- * 3. Receives the response header from the server, extracting the response code
- *    and the size of the response payload.
- * 4. Receives the response payload and checks for errors in the response.
- *    - If the response code indicates failure or if the payload size is incorrect,
- *      an exception is thrown.
- * 5. If the registration is successful, it sets the UUID from the server's response.
- * 6. The function will retry sending the request up to a maximum number of attempts
- *    defined by `MAX_REQUEST_FAILS`.
- * 7. Returns `SUCCESS` if the registration was successful, or `FAILURE` if the maximum
- *    number of attempts is reached without a successful registration.
- *
- * @param sock A reference to the TCP socket used for communication with the server.
- * @return An integer indicating the result of the registration attempt (SUCCESS or FAILURE).
- */
-
-int RegisterRequest::run(tcp::socket& sock) {
-	// Pack request fields into vector and initialize parameter times_sent to 0
-	int times_sent = 1;
-	Bytes request = this->pack_request();
-
-	while (times_sent <= MAX_REQUEST_FAILS) {
-		try {
-			// Send the request to the server via the provided socket
-			boost::asio::write(sock, boost::asio::buffer(request));
-
-			// Receiving the header from the server, extracting response code and header_extras_size
-			Bytes response_header(RESPONSE_HEADER_SIZE);
-			boost::asio::read(sock, boost::asio::buffer(response_header, RESPONSE_HEADER_SIZE));
-			uint16_t response_code = extractCodeFromResponseHeader(response_header);
-			uint32_t response_payload_size = extractPayloadSizeFromResponseHeader(response_header);
-
-			// Receiving the payload from the server and saving the num of bytes received from it
-			Bytes response_payload(response_payload_size);
-			size_t num_of_bytes_received_from_server = boost::asio::read(sock, boost::asio::buffer(response_payload, response_payload_size));
-
-			// If the code is wrong or we didn't receive enough bytes or the payload size we got is wrong
-			if (response_code != Codes::REGISTRATION_SUCCEEDED_CODE || response_payload_size != PayloadSize::REGISTRATION_SUCCEEDED_PAYLOAD_SIZE || num_of_bytes_received_from_server != response_payload_size) {
-				throw std::invalid_argument("server responded with an error");
-			}
-			// The Registration succeeded, set the uuid to the id the server responded with
-			this->header.setUUIDFromRawBytes(response_payload);
-			//this->getHeaderReference().setUUIDFromRawBytes(response_payload);
-
-			break; // Existing the loop Registration was successful
-		}
-		catch (std::exception& e) {
-			std::cerr << e.what() << std::endl;
-		}
-
-		times_sent++; // Meaning we failed registering 1 time because we catched an exception 
-	}
-
-	// If the times_sent reached MAX_REQUEST_FAILS, returning false
-	if (times_sent >= MAX_REQUEST_FAILS) {
-		return FAILURE;
-	}
-	// If the the registration succeeded, return true
-	return SUCCESS;
-}
-
-
-SendPublicKeyRequest::SendPublicKeyRequest(RequestHeader header, SendPublicKeyPayload payload)
-	: Request(header), payload(payload) {}
-
-const SendPublicKeyPayload* SendPublicKeyRequest::getPayload() const {
-	return &payload;  // Returning a pointer to payload
-}
-
-string SendPublicKeyRequest::getEncryptedAESKey() const {
-	return payload.getEncryptedAESKey();
-}
-void SendPublicKeyRequest::updateEncryptedAESKey(const Bytes& encrypted_aes_key) {
-	string encrypted_ase_key_string = string(encrypted_aes_key.begin(), encrypted_aes_key.end());
-	this->payload.setEncryptedAESKey(encrypted_ase_key_string);
-}
-
-
-Bytes SendPublicKeyRequest::pack_request() const {
-	Bytes packed_header = this->getHeader().pack_header();
-	Bytes packed_payload = this->getPayload()->pack_payload();
-	Bytes request = packed_header + packed_payload;
-	return request;
-}
-
-/** SendPublicKeyRequest::run
- * Sends a public key to the server and processes the server's response.
- *
- * This function performs the following steps:
- * 1. Packs the public key request fields into a byte vector.
- * 2. Attempts to send the request to the server via the provided socket.
- * 3. Receives the response header from the server, extracting the response code
- *    and the size of the response payload.
- * 4. Receives the response payload and checks for errors in the response.
- *    - If the response code indicates failure, or if the payload size is incorrect,
- *      an exception is thrown.
- * 5. Validates that the UUID in the response matches the client's UUID.
- * 6. Extracts the encrypted AES key from the response payload.
- * 7. Handles cases where the length of the extracted key does not match the expected size.
- * 8. The function will retry sending the request up to a maximum number of attempts
- *    defined by `MAX_REQUEST_FAILS`.
- * 9. Returns `SUCCESS` if the request was successful, or `FAILURE` if the maximum
- *    number of attempts is reached without success.
- *
- * @param sock A reference to the TCP socket used for communication with the server.
- * @return An integer indicating the result of the public key sending attempt (SUCCESS or FAILURE).
- */
-
-int SendPublicKeyRequest::run(tcp::socket& sock) {
-	// Pack request fields into vector and initialize parameter times_sent to 0
-	int times_sent = 1;
-	Bytes request = pack_request();
-
-	while (times_sent <= MAX_REQUEST_FAILS) {
-		try {
-			// Send the request to the server via the provided socket
-			boost::asio::write(sock, boost::asio::buffer(request));
-
-			// Receive header from the server, get response code and header_extras_size
-			Bytes response_header(RESPONSE_HEADER_SIZE);
-			boost::asio::read(sock, boost::asio::buffer(response_header, RESPONSE_HEADER_SIZE));
-			uint16_t response_code = extractCodeFromResponseHeader(response_header);
-			uint32_t response_payload_size = extractPayloadSizeFromResponseHeader(response_header);
-
-			// Receive payload from the server, save it's length in parameter length
-			Bytes response_payload(response_payload_size);
-			size_t length = boost::asio::read(sock, boost::asio::buffer(response_payload, response_payload_size));
-
-			// If the code is not success, the header_extras_size for the code is not the same as the size received in the header, or the length of the payload is not the wanted length, print error
-			if (response_code != Codes::PUBLIC_KEY_RECEIVED_CODE || length != response_payload_size || response_payload_size != PayloadSize::PUBLIC_KEY_RECEIVED_PAYLOAD_SIZE) {
-				throw std::invalid_argument("server responded with an error");
-			}
-
-			// Copy the id from the payload, and check if it's the correct client id
-			Bytes payload_uuid(UUID_SIZE);
-			std::copy(response_payload.begin(), response_payload.begin() + UUID_SIZE, payload_uuid.begin());
-
-			if (!are_uuids_equal(payload_uuid, this->getHeader().getUUID())) {
-				throw std::invalid_argument("server responded with an error");
-			}
-
-			Bytes encrypted_aes_key(ENCRYPTED_AES_KEY_LENGTH);
-			std::copy(response_payload.begin() + UUID_SIZE, response_payload.end(), encrypted_aes_key.begin());
-
-			// If the copied key is smaller than expected, handle it here
-			if (encrypted_aes_key.size() != ENCRYPTED_AES_KEY_LENGTH) {
-				throw std::out_of_range("Not enough bytes or too many bytes to fill the encrypted AES key");
-			}
-
-			updateEncryptedAESKey(encrypted_aes_key);
-
-			break; // Existing the loop SendPublicKeyRequest::run was successful
-		}
-		catch (std::exception& e) {
-			std::cerr << e.what() << std::endl;
-		}
-		// Increment the i by 1 each iteration.
-		times_sent++;
-	}
-	// If the times_sent reached MAX_REQUEST_FAILS, returning false
-	if (times_sent >= MAX_REQUEST_FAILS) {
-		return FAILURE;
-	}
-	// If the the SendPublicKeyRequest::run succeeded, return true
-	return SUCCESS;
-}
-
-
-
-ReconnectRequest::ReconnectRequest(RequestHeader header, ReconnectionPayload payload)
-	: Request(header), payload(payload) {}
-
-const ReconnectionPayload* ReconnectRequest::getPayload() const {
-	return &payload;  // Returning a pointer to payload
-}
-
-Bytes ReconnectRequest::pack_request() const { //todo :not done
-	Bytes packed_header = this->getHeader().pack_header();
-	Bytes packed_payload = this->getPayload()->pack_payload();
-	Bytes request = packed_header + packed_payload;
-	return request;
-}
-
-
-void ReconnectRequest::updateEncryptedAESKey(const Bytes& encrypted_aes_key) {
-	this->payload.setEncryptedAESKey(reinterpret_cast<const char*>(encrypted_aes_key.data()), encrypted_aes_key.size());
-}
-
-/** ReconnectRequest::run
- * Sends a reconnection request to the server and processes the server's response.
- *
- * This function performs the following steps:
- * 1. Packs the reconnection request fields into a byte vector.
- * 2. Attempts to send the request to the server via the provided socket.
- * 3. Receives the response header from the server, extracting the response code
- *    and the size of the response payload.
- * 4. Receives the response payload and checks for errors in the response.
- *    - If the response indicates a failure (RECONNECTION_FAILED_CODE), it updates
- *      the client's UUID from the response payload and returns REGISTERED_NOT_RECONNECTED.
- *    - If the response indicates success (RECONNECTION_SUCCEEDED_CODE), it validates
- *      that the UUID matches the client's UUID and extracts the encrypted AES key.
- * 5. Handles exceptions and retries sending the request up to a maximum number of attempts
- *    defined by `MAX_REQUEST_FAILS`.
- * 6. Returns `SUCCESS` if the reconnection was successful, or `FAILURE` if the maximum
- *    number of attempts is reached without success.
- *
- * @param sock A reference to the TCP socket used for communication with the server.
- * @return An integer indicating the result of the reconnection attempt (SUCCESS, FAILURE, or REGISTERED_NOT_RECONNECTED).
- */
-int ReconnectRequest::run(tcp::socket& sock) {
-	// Pack request fields into vector and initialize parameter times_sent to 1
-	int times_sent = 1;
-	Bytes request = pack_request();
-
-	while (times_sent <= MAX_REQUEST_FAILS) {
-		cout << "times sent = " << times_sent << "\n";
-		try {
-			// Send the request to the server via the provided socket
-			boost::asio::write(sock, boost::asio::buffer(request));
-
-			// Receive header from the server, get response code and header_extras_size
-			Bytes response_header(RESPONSE_HEADER_SIZE);
-			boost::asio::read(sock, boost::asio::buffer(response_header, RESPONSE_HEADER_SIZE));
-			uint16_t response_code = extractCodeFromResponseHeader(response_header);
-			uint32_t response_payload_size = extractPayloadSizeFromResponseHeader(response_header);
-			// Receive payload from the server, save it's length in a parameter length
-			Bytes response_payload(response_payload_size);
-			size_t length = boost::asio::read(sock, boost::asio::buffer(response_payload, response_payload_size));
-			// The reconnection FAILED, so it registerd a new user and returned us a new uuid
-			if (response_code == Codes::RECONNECTION_FAILED_CODE && response_payload_size == PayloadSize::RECONNECTION_FAILED_PAYLOAD_SIZE && length == response_payload_size) {
-				this->getHeaderReference().setUUIDFromRawBytes(response_payload);
-				return REGISTERED_NOT_RECONNECTED;
-			}
-			// If the code is not success, or other problem occurred
-			else if (response_code != Codes::RECONNECTION_SUCCEEDED_CODE || response_payload_size != PayloadSize::RECONNECTION_SUCCEEDED_PAYLOAD_SIZE_WITHOUT_AES_KEY_SIZE || length != response_payload_size) {
-				throw std::invalid_argument("server responded with an error");
-			}
-			Bytes payload_uuid(UUID_SIZE);
-			std::copy(response_payload.begin(), response_payload.begin() + UUID_SIZE, payload_uuid.begin());
-			if (!are_uuids_equal(payload_uuid, this->getHeader().getUUID())) {
-				throw std::invalid_argument("server responded with an error");
-			}
-			Bytes encrypted_aes_key(ENCRYPTED_AES_KEY_LENGTH);
-			std::copy(response_payload.begin() + UUID_SIZE, response_payload.end(), encrypted_aes_key.begin());
-			// Copy the encrypted aes key content from the response_payload vector into the parameter encrypted_aes_key, then break from the loop.
-			updateEncryptedAESKey(encrypted_aes_key);
-			break;
-		}
-		catch (std::exception& e) {
-			std::cerr << e.what() << std::endl;
-		}
-		// Increment the i by 1 each iteration.
-		times_sent++;
-	}
-	// If the times_sent reached MAX_REQUEST_FAILS, returning FAILURE
-	if (times_sent >= MAX_REQUEST_FAILS) {
-		return FAILURE;
-	}
-	// If the the SendPublicKeyRequest::run succeeded, return SUCCESS
-	return SUCCESS;
-}
-
-
-
-ValidCrcRequest::ValidCrcRequest(RequestHeader header, ValidCrcPayload payload)
-	: Request(header), payload(payload) {}
-
-
-const ValidCrcPayload* ValidCrcRequest::getPayload() const {
-	return &payload;
-}
-
-Bytes ValidCrcRequest::pack_request() const {
-	Bytes packed_header = this->getHeader().pack_header();
-	Bytes packed_payload = this->getPayload()->pack_payload();
-	Bytes request = packed_header + packed_payload;
-	return request;
-}
-/** ValidCrcRequest::run
- * Sends a valid CRC request to the server and processes the server's response.
- *
- * This function performs the following actions:
- * 1. Packs the valid CRC request fields into a byte vector.
- * 2. Attempts to send the request to the server using the provided socket.
- * 3. Receives the response header from the server, extracting the response code
- *    and the size of the response payload.
- * 4. Receives the response payload and checks for errors in the response:
- *    - If the response code indicates success, and the payload size matches the expected size,
- *      it validates that the UUID in the payload matches the client's UUID.
- * 5. Handles exceptions and retries sending the request up to a maximum number of attempts
- *    defined by `MAX_REQUEST_FAILS`.
- * 6. Returns `SUCCESS` if the request was successful, or `FAILURE` if the maximum
- *    number of attempts is reached without success.
- *
- * @param sock A reference to the TCP socket used for communication with the server.
- * @return An integer indicating the result of the CRC validation request (SUCCESS or FAILURE).
- */
-int ValidCrcRequest::run(tcp::socket& sock) {
-	int times_sent = 0;
-	Bytes request = pack_request();
-
-	while (times_sent < MAX_REQUEST_FAILS) {
-		try {
-			// Send the request to the server via the provided socket.
-			boost::asio::write(sock, boost::asio::buffer(request));
-
-			// Receive header from the server, get response code and payload_size
-			Bytes response_header(RESPONSE_HEADER_SIZE);
-			boost::asio::read(sock, boost::asio::buffer(response_header, RESPONSE_HEADER_SIZE));
-			uint16_t response_code = extractCodeFromResponseHeader(response_header);
-			uint32_t response_payload_size = extractPayloadSizeFromResponseHeader(response_header);
-
-			// Receive payload from the server, save it's length in a parameter length.
-			Bytes response_payload(response_payload_size);
-			size_t length = boost::asio::read(sock, boost::asio::buffer(response_payload, response_payload_size));
-
-			// If the code is not success, the payload_size for the code is not the same as the size received in the header, or the length of the payload is not the wanted length, print error.
-			if (response_code != Codes::FILE_RECEIVED_CRC_CODE || response_payload_size != PayloadSize::FILE_RECEIVED_CRC_PAYLOAD_SIZE || length != response_payload_size) {
-				throw std::invalid_argument("server responded with an error");
-			}
-
-			//// Copy the id from the payload, and check if it's the correct client id.
-			Bytes payload_uuid(UUID_SIZE);
-			std::copy(response_payload.begin(), response_payload.begin() + UUID_SIZE, payload_uuid.begin());
-
-			if (!are_uuids_equal(payload_uuid, this->getHeader().getUUID())) {
-				throw std::invalid_argument("server responded with an error");
-			}
-
-			// If the id provided by the server is correct, break from the loop and return SUCCESS.
-			break;
-		}
-		catch (std::exception& e) {
-			std::cerr << e.what() << std::endl;
-		}
-		// Increment by 1 each iteration.
-		times_sent++;
-	}
-	// If reached 3, return FAILURE.
-	if (times_sent > MAX_REQUEST_FAILS) {
-		return FAILURE;
-	}
-	// If the client succeeded, return SUCCESS.
-	return SUCCESS;
-}
-
-
-InvalidCrcRequest::InvalidCrcRequest(RequestHeader header, InvalidCrcPayload payload)
-	: Request(header), payload(payload) {}
-
-const InvalidCrcPayload* InvalidCrcRequest::getPayload() const {
-	return &payload;
-}
-
-Bytes InvalidCrcRequest::pack_request() const {
-	Bytes packed_header = this->getHeader().pack_header();
-	Bytes packed_payload = this->getPayload()->pack_payload();
-	Bytes request = packed_header + packed_payload;
-	return request;
-}
-/** InvalidCrcRequest::run
- * Sends an invalid CRC request to the server.
- *
- * This function performs the following actions:
- * 1. Packs the invalid CRC request fields into a byte vector.
- * 2. Attempts to send the request to the server using the provided socket.
- * 3. If the request is successfully sent, it returns `SUCCESS`.
- * 4. If an exception occurs during the send operation, it catches the exception,
- *    logs the error message, and returns `FAILURE`.
- *
- * @param sock A reference to the TCP socket used for communication with the server.
- * @return An integer indicating the result of the invalid CRC request (SUCCESS or FAILURE).
- */
-
-int InvalidCrcRequest::run(tcp::socket& sock) {
-	// Pack request fields into vector.
-	Bytes request = pack_request();
-
-	try {
-		// Send the request to the server via the provided socket.
-		boost::asio::write(sock, boost::asio::buffer(request));
-	}
-	catch (std::exception& e) {
-		std::cerr << e.what() << std::endl;
-		return FAILURE;
-	}
-
-	return SUCCESS;
-}
-
-
-
-InvalidCrcDoneRequest::InvalidCrcDoneRequest(RequestHeader header, InvalidCrcDonePayload payload)
-	: Request(header), payload(payload) {}
-
-const InvalidCrcDonePayload* InvalidCrcDoneRequest::getPayload() const {
-	return &payload;
-}
-
-Bytes InvalidCrcDoneRequest::pack_request() const {
-	Bytes packed_header = this->getHeader().pack_header();
-	Bytes packed_payload = this->getPayload()->pack_payload();
-	Bytes request = packed_header + packed_payload;
-	return request;
-}
-/** InvalidCrcDoneRequest::run
- * Sends an invalid CRC done request to the server and waits for a response.
- *
- * This function executes the following steps:
- * 1. Packs the invalid CRC done request fields into a byte vector.
- * 2. Attempts to send the request to the server using the provided socket.
- * 3. Enters a loop to handle retries if the response is not successful.
- * 4. Receives the header from the server, extracting the response code and payload size.
- * 5. Receives the payload from the server and checks if it matches the expected sizes.
- * 6. Validates the UUID from the response payload against the client's UUID.
- * 7. Returns `SUCCESS` if the request was successful and the UUIDs match; otherwise, returns `FAILURE` after the maximum retries.
- *
- * @param sock A reference to the TCP socket used for communication with the server.
- * @return An integer indicating the result of the invalid CRC done request (SUCCESS or FAILURE).
- */
-int InvalidCrcDoneRequest::run(tcp::socket& sock) {
-	int times_sent = 1;
-	Bytes request = pack_request();
-
-	while (times_sent <= MAX_REQUEST_FAILS) {
-		try {
-			// Send the request to the server via the provided socket.
-			boost::asio::write(sock, boost::asio::buffer(request));
-
-			// Receive header from the server, get response code and payload_size
-			Bytes response_header(RESPONSE_HEADER_SIZE);
-			boost::asio::read(sock, boost::asio::buffer(response_header, RESPONSE_HEADER_SIZE));
-			uint16_t response_code = extractCodeFromResponseHeader(response_header);
-			uint32_t response_payload_size = extractPayloadSizeFromResponseHeader(response_header);
-
-			// Receive payload from the server, save it's length in a parameter length.
-			Bytes response_payload(response_payload_size);
-			size_t length = boost::asio::read(sock, boost::asio::buffer(response_payload, response_payload_size));
-
-			// If the code is not success, the payload_size for the code is not the same as the size received in the header, or the length of the payload is not the wanted length, print error.
-			if (response_code != Codes::FILE_RECEIVED_CRC_CODE || response_payload_size != PayloadSize::FILE_RECEIVED_CRC_PAYLOAD_SIZE || length != response_payload_size) {
-				throw std::invalid_argument("server responded with an error");
-			}
-
-			//// Copy the id from the payload, and check if it's the correct client id.
-			Bytes payload_uuid(UUID_SIZE);
-			std::copy(response_payload.begin(), response_payload.begin() + UUID_SIZE, payload_uuid.begin());
-
-			if (!are_uuids_equal(payload_uuid, this->getHeader().getUUID())) {
-				throw std::invalid_argument("server responded with an error");
-			}
-
-			// If the id provided by the server is correct, break from the loop and return SUCCESS.
-			break;
-		}
-		catch (std::exception& e) {
-			std::cerr << e.what() << std::endl;
-		}
-		// Increment by 1 each iteration.
-		times_sent++;
-	}
-	// If reached 3, return FAILURE.
-	if (times_sent >= MAX_REQUEST_FAILS) {
-		return FAILURE;
-	}
-	// If the client succeeded, return SUCCESS.
-	return SUCCESS;
-}
-
-
-
-SendFileRequest::SendFileRequest(RequestHeader header, SendFilePayload payload)
-	: Request(header), payload(payload) {}
-
-const SendFilePayload* SendFileRequest::getPayload() const {
-	return &payload;
-}
-
-SendFilePayload& SendFileRequest::getPayloadReference() {
-	return payload; // Return a reference to the payload
-}
-
-
-//This is a special request where I need to send the request in chunks of data because
-// the file could be too big
-Bytes SendFileRequest::pack_request(const Bytes message_content) const {
-	Bytes packed_header = this->getHeader().pack_header();
-	Bytes packed_payload = this->getPayload()->pack_payload(message_content);
-	Bytes request = packed_header + packed_payload;
-	return request;
-}
-
-/** SendFileRequest::sendFileData
- * Sends the encrypted file data to the server in packets.
- *
- * This function executes the following steps:
- * 1. Retrieves the encrypted file content and its size.
- * 2. Iterates over the total number of packets to be sent.
- * 3. For each packet:
- *    - Calculates the starting and ending positions for the current packet in the file data.
- *    - Copies the relevant portion of the file content into a byte array.
- *    - Packs the packet and sends it to the server using the provided socket.
- * 4. If an exception occurs during the sending process, it logs the error and increments the attempt counter.
- * 5. If the maximum number of send attempts is reached without success, it returns `FAILURE`.
- * 6. If all packets are sent successfully, it returns `SUCCESS`.
- *
- * @param sock A reference to the TCP socket used for communication with the server.
- * @return An integer indicating the result of the file sending operation (SUCCESS or FAILURE).
- */
-int SendFileRequest::sendFileData(tcp::socket& sock) {
-	// Pack request fields into vector and initialize parameter times_sent to 1
-	int times_sent = 1;
-	string file_to_send = this->getPayload()->get_encrypted_file_content();
-	size_t file_size = file_to_send.size();
-
-	try {
-		for (int packet_number = 0; packet_number < this->getPayload()->get_total_packets(); packet_number++) {
-			// Calculate the starting position for the current packet
-			size_t start = packet_number * CONTENT_SIZE_PER_PACKET;
-
-			size_t end = std::min(start + CONTENT_SIZE_PER_PACKET, file_size);
-			Bytes message_content(CONTENT_SIZE_PER_PACKET);
-			std::copy(file_to_send.begin() + start, file_to_send.begin() + end, message_content.begin());
-			// Bytes message_content(file_to_send.begin() + start, file_to_send.begin() + start + CONTENT_SIZE_PER_PACKET); // Extract the message content for the current packet
-			this->getPayloadReference().set_packet_number(packet_number);
-			Bytes request_packet = pack_request(message_content);
-			boost::asio::write(sock, boost::asio::buffer(request_packet));
-		}
-	}
-	catch (std::exception& error) {
-		std::cerr << "Error sending data: " << error.what() << std::endl;
-		++times_sent;
-	}
-	// If the times_sent reached MAX_REQUEST_FAILS, returning FAILURE
-	if (times_sent >= MAX_REQUEST_FAILS) {
-		return FAILURE;
-	}
-	// If the the sendFileData succeeded, return SUCCESS
-	return SUCCESS;
-
-}
-
-/** SendFileRequest::run
- * Executes the file sending request to the server.
- *
- * This function performs the following steps:
- * 1. Attempts to send the file data to the server up to a maximum number of retries.
- * 2. After sending the file, it waits for a response from the server.
- * 3. Validates the response header and payload to ensure the file was received correctly.
- * 4. Checks the UUID and content size from the response to confirm successful processing.
- * 5. Extracts the file name and checksum from the response.
- * 6. Returns `FAILURE` if the maximum number of attempts is reached or if any validation fails; otherwise, returns `SUCCESS`.
- *
- * @param sock A reference to the TCP socket used for communication with the server.
- * @return An integer indicating the result of the file sending operation (SUCCESS or FAILURE).
- */
-int SendFileRequest::run(tcp::socket& sock)
-{
-	int times_sent = 1;
-	int sent_file;
-
-	while (times_sent <= MAX_REQUEST_FAILS) {
-		try {
-			sent_file = sendFileData(sock);
-
-			if (sent_file == FAILURE) {
-				throw std::invalid_argument("Error sending file to server");
-			}
-
-			Bytes response_header(RESPONSE_HEADER_SIZE);
-			boost::asio::read(sock, boost::asio::buffer(response_header, RESPONSE_HEADER_SIZE));
-			uint16_t response_code = extractCodeFromResponseHeader(response_header);
-			uint32_t response_payload_size = extractPayloadSizeFromResponseHeader(response_header);
-
-			// Receive payload from the server, save it's length in a parameter length.
-			Bytes response_payload(response_payload_size);
-			size_t length = boost::asio::read(sock, boost::asio::buffer(response_payload, response_payload_size));
-
-			// If the code is not success, the payload_size for the code is not the same as the size received in the header, or the length of the payload is not the wanted length, print error.
-			if (response_code != Codes::FILE_RECEIVED_CRC_CODE || response_payload_size != PayloadSize::FILE_RECEIVED_CRC_PAYLOAD_SIZE || length != response_payload_size) {
-				throw std::invalid_argument("server responded with an error");
-			}
-
-			Bytes payload_uuid(UUID_SIZE);
-			std::copy(response_payload.begin(), response_payload.begin() + UUID_SIZE, payload_uuid.begin());
-
-			if (!are_uuids_equal(payload_uuid, this->getHeader().getUUID())) {
-				throw std::invalid_argument("server responded with an error");
-			}
-
-			uint32_t response_content_size = extractPayloadContentSize(response_payload);
-			if (this->getPayload()->get_content_size() != response_content_size) {
-				throw std::invalid_argument("server responded with an error");
-			}
-
-			// std::string response_file_name(response_payload.begin() + sizeof(uuid) + sizeof(content_size), response_payload.begin() + sizeof(uuid) + sizeof(content_size) + sizeof(file_name));
-			string response_file_name = extractSendFileResponseFileName(response_payload);
-			if (response_file_name != string(this->getPayload()->get_file_name())) {
-				throw std::invalid_argument("server responded with an error");
-			}
-
-			// Copy the cksum content from the response_payload vector into the parameter cksum.
-			unsigned long response_cksum = extractSendFileResponseCksum(response_payload);
-
-			this->getPayloadReference().setCksum(response_cksum);
-
-			// continue here to get the responses
-			break;
-		}
-		catch (std::exception& e) {
-			std::cerr << e.what() << std::endl;
-			++times_sent;
-		}
-	}
-
-
-
-	// If the times_sent reached MAX_REQUEST_FAILS, returning FAILURE
-	if (times_sent >= MAX_REQUEST_FAILS) {
-		return FAILURE;
-	}
-	// If the the SendPublicKeyRequest::run succeeded, return SUCCESS
-	return SUCCESS;
-}
-
+#include "utils.hpp"
+#include "requests.hpp"
+#include "transaction.hpp"
+
+RegisterRequest::RegisterRequest(RequestHeader header, RegistrationPayload payload)
+	: Request(header), payload(payload) {}
+
+const RegistrationPayload* RegisterRequest::getPayload() const {
+	return &payload;  // Returning a pointer to payload
+}
+
+
+/*
+	This method packs the header and payload for the registration request in a form of uint8_t vector
+	All numeric fields are ordered by little endian order
+*/
+Bytes RegisterRequest::pack_request() const {
+	Bytes packed_header = this->getHeader().pack_header();
+	Bytes packed_payload = this->getPayload()->pack_payload();
+	Bytes request = packed_header + packed_payload;
+	return request;
+}
+
+
+/** RegisterRequest::handleResponse
+ * Handles the server's answer to the registration request.
+ *
+ * The transaction engine already checked the response code and the payload size (see TRANSACTION_TABLE),
+ * so the payload holds the 16 bytes of the id the server gave the new client.
+ *
+ * @param response A view of the response in the reader's buffer.
+ * @param result The result the transaction table gives the response (SUCCESS).
+ */
+
+void RegisterRequest::handleResponse(const ResponseView& response, [[maybe_unused]] int result) {
+	// The Registration succeeded, set the uuid to the id the server responded with
+	this->header.setUUIDFromRawBytes(response.payload);
+}
+
+
+SendPublicKeyRequest::SendPublicKeyRequest(RequestHeader header, SendPublicKeyPayload payload)
+	: Request(header), payload(payload) {}
+
+const SendPublicKeyPayload* SendPublicKeyRequest::getPayload() const {
+	return &payload;  // Returning a pointer to payload
+}
+
+string SendPublicKeyRequest::getEncryptedAESKey() const {
+	return payload.getEncryptedAESKey();
+}
+void SendPublicKeyRequest::updateEncryptedAESKey(const char* encrypted_aes_key) {
+	this->payload.setEncryptedAESKey(encrypted_aes_key, ENCRYPTED_AES_KEY_LENGTH);
+}
+
+
+Bytes SendPublicKeyRequest::pack_request() const {
+	Bytes packed_header = this->getHeader().pack_header();
+	Bytes packed_payload = this->getPayload()->pack_payload();
+	Bytes request = packed_header + packed_payload;
+	return request;
+}
+
+/** SendPublicKeyRequest::handleResponse
+ * Handles the server's answer to the public key, once the engine matched its code, size and uuid.
+ *
+ * @param response A view of the response in the reader's buffer.
+ * @param result The result the transaction table gives the response (SUCCESS).
+ */
+
+void SendPublicKeyRequest::handleResponse(const ResponseView& response, [[maybe_unused]] int result) {
+	// The payload size was checked, so the key is exactly ENCRYPTED_AES_KEY_LENGTH bytes
+	updateEncryptedAESKey(EncryptedAESKeyView(response).encryptedAESKey());
+}
+
+
+
+ReconnectRequest::ReconnectRequest(RequestHeader header, ReconnectionPayload payload)
+	: Request(header), payload(payload) {}
+
+const ReconnectionPayload* ReconnectRequest::getPayload() const {
+	return &payload;  // Returning a pointer to payload
+}
+
+Bytes ReconnectRequest::pack_request() const {
+	Bytes packed_header = this->getHeader().pack_header();
+	Bytes packed_payload = this->getPayload()->pack_payload();
+	Bytes request = packed_header + packed_payload;
+	return request;
+}
+
+
+void ReconnectRequest::updateEncryptedAESKey(const char* encrypted_aes_key) {
+	this->payload.setEncryptedAESKey(encrypted_aes_key, ENCRYPTED_AES_KEY_LENGTH);
+}
+
+void ReconnectRequest::updateServerPublicKey(const char* server_public_key) {
+	this->payload.setServerPublicKey(server_public_key, X25519_KEY_LENGTH);
+}
+
+/** ReconnectRequest::handleResponse
+ * Handles the server's answer to the reconnection request.
+ *
+ * The reconnection has three possible answers in the transaction table:
+ * - RECONNECTION_FAILED_CODE (REGISTERED_NOT_RECONNECTED): the server registered a new user, the payload is its new uuid.
+ * - RECONNECTION_X25519_SUCCEEDED_CODE (RECONNECTED_WITH_X25519): the client registered an x25519 key, the payload
+ *   holds the server's ephemeral public key.
+ * - RECONNECTION_SUCCEEDED_CODE (SUCCESS): the payload holds the AES key encrypted with the client's RSA key.
+ *
+ * @param response A view of the response in the reader's buffer.
+ * @param result The result the transaction table gives the response.
+ */
+void ReconnectRequest::handleResponse(const ResponseView& response, int result) {
+	if (result == REGISTERED_NOT_RECONNECTED) {
+		this->getHeaderReference().setUUIDFromRawBytes(response.payload);
+	}
+	else if (result == RECONNECTED_WITH_X25519) {
+		updateServerPublicKey(ServerPublicKeyView(response).serverPublicKey());
+	}
+	else {
+		updateEncryptedAESKey(EncryptedAESKeyView(response).encryptedAESKey());
+	}
+}
+
+
+
+SendX25519PublicKeyRequest::SendX25519PublicKeyRequest(RequestHeader header, SendX25519PublicKeyPayload payload)
+	: Request(header), payload(payload) {}
+
+const SendX25519PublicKeyPayload* SendX25519PublicKeyRequest::getPayload() const {
+	return &payload;
+}
+
+Bytes SendX25519PublicKeyRequest::pack_request() const {
+	Bytes packed_header = this->getHeader().pack_header();
+	Bytes packed_payload = this->getPayload()->pack_payload();
+	Bytes request = packed_header + packed_payload;
+	return request;
+}
+
+/** SendX25519PublicKeyRequest::handleResponse
+ * Saves the server's ephemeral x25519 public key from its answer to the client's public key.
+ *
+ * This is the x25519 counterpart of SendPublicKeyRequest: instead of an AES key encrypted with RSA,
+ * the server answers with its ephemeral public key, and both sides derive the AES key from the agreed secret.
+ *
+ * @param response A view of the response in the reader's buffer.
+ * @param result The result the transaction table gives the response (SUCCESS).
+ */
+void SendX25519PublicKeyRequest::handleResponse(const ResponseView& response, [[maybe_unused]] int result) {
+	// uuid (16 bytes) | server's ephemeral public key (32 bytes)
+	this->payload.setServerPublicKey(ServerPublicKeyView(response).serverPublicKey(), X25519_KEY_LENGTH);
+}
+
+
+
+ValidCrcRequest::ValidCrcRequest(RequestHeader header, ValidCrcPayload payload)
+	: Request(header), payload(payload) {}
+
+
+const ValidCrcPayload* ValidCrcRequest::getPayload() const {
+	return &payload;
+}
+
+// The server answers with MESSAGE_RECEIVED_CODE, there is nothing to handle beyond the engine's checks.
+Bytes ValidCrcRequest::pack_request() const {
+	Bytes packed_header = this->getHeader().pack_header();
+	Bytes packed_payload = this->getPayload()->pack_payload();
+	Bytes request = packed_header + packed_payload;
+	return request;
+}
+
+
+InvalidCrcRequest::InvalidCrcRequest(RequestHeader header, InvalidCrcPayload payload)
+	: Request(header), payload(payload) {}
+
+const InvalidCrcPayload* InvalidCrcRequest::getPayload() const {
+	return &payload;
+}
+
+// The server doesn't answer this request, the engine only sends it.
+Bytes InvalidCrcRequest::pack_request() const {
+	Bytes packed_header = this->getHeader().pack_header();
+	Bytes packed_payload = this->getPayload()->pack_payload();
+	Bytes request = packed_header + packed_payload;
+	return request;
+}
+
+
+
+InvalidCrcDoneRequest::InvalidCrcDoneRequest(RequestHeader header, InvalidCrcDonePayload payload)
+	: Request(header), payload(payload) {}
+
+const InvalidCrcDonePayload* InvalidCrcDoneRequest::getPayload() const {
+	return &payload;
+}
+
+// The server answers with MESSAGE_RECEIVED_CODE, there is nothing to handle beyond the engine's checks.
+Bytes InvalidCrcDoneRequest::pack_request() const {
+	Bytes packed_header = this->getHeader().pack_header();
+	Bytes packed_payload = this->getPayload()->pack_payload();
+	Bytes request = packed_header + packed_payload;
+	return request;
+}
+
+
+
+ResumeRequest::ResumeRequest(RequestHeader header, ResumptionPayload payload)
+	: Request(header), payload(payload) {}
+
+const ResumptionPayload* ResumeRequest::getPayload() const {
+	return &payload;
+}
+
+Bytes ResumeRequest::pack_request() const {
+	Bytes packed_header = this->getHeader().pack_header();
+	Bytes packed_payload = this->getPayload()->pack_payload();
+	Bytes request = packed_header + packed_payload;
+	return request;
+}
+/** ResumeRequest::handleResponse
+ * Handles the server's answer to the resumption ticket.
+ *
+ * If the server rejected the ticket (RESUMPTION_FAILED_CODE) the engine returns RESUMPTION_REJECTED and the
+ * caller falls back to the RSA reconnection. If it accepted it, saves the server nonce and the new ticket.
+ *
+ * @param response A view of the response in the reader's buffer.
+ * @param result The result the transaction table gives the response (SUCCESS or RESUMPTION_REJECTED).
+ */
+void ResumeRequest::handleResponse(const ResponseView& response, int result) {
+	if (result != SUCCESS) {
+		return;
+	}
+	ResumptionSucceededView resumption(response);
+	this->payload.setServerNonce(resumption.serverNonce(), SESSION_NONCE_LENGTH);
+	this->payload.setNewTicket(resumption.newTicket(), TICKET_LENGTH);
+}
+
+
+
+ResumptionTicketRequest::ResumptionTicketRequest(RequestHeader header, ResumptionTicketRequestPayload payload)
+	: Request(header), payload(payload) {}
+
+const ResumptionTicketRequestPayload* ResumptionTicketRequest::getPayload() const {
+	return &payload;
+}
+
+Bytes ResumptionTicketRequest::pack_request() const {
+	Bytes packed_header = this->getHeader().pack_header();
+	Bytes packed_payload = this->getPayload()->pack_payload();
+	Bytes request = packed_header + packed_payload;
+	return request;
+}
+/** ResumptionTicketRequest::handleResponse
+ * Saves the resumption ticket the server issued for the session that was just set up.
+ *
+ * @param response A view of the response in the reader's buffer.
+ * @param result The result the transaction table gives the response (SUCCESS).
+ */
+void ResumptionTicketRequest::handleResponse(const ResponseView& response, [[maybe_unused]] int result) {
+	this->payload.setTicket(ResumptionTicketView(response).ticket(), TICKET_LENGTH);
+}
+
+
+
+SendFileRequest::SendFileRequest(RequestHeader header, SendFilePayload&& payload)
+	: Request(header), payload(std::move(payload)) {}
+
+const SendFilePayload* SendFileRequest::getPayload() const {
+	return &payload;
+}
+
+SendFilePayload& SendFileRequest::getPayloadReference() {
+	return payload; // Return a reference to the payload
+}
+
+
+//This is a special request where I need to send the request in chunks of data because
+// the file could be too big. Every packet is packed in place, at destination.
+void SendFileRequest::pack_packet(Byte* destination, uint16_t packet_number) const {
+	const TransferString& file_to_send = this->getPayload()->get_encrypted_file_content();
+	// Calculate the position of the current packet in the file, the last packet is padded with zeros
+	size_t start = packet_number * CONTENT_SIZE_PER_PACKET;
+	size_t end = std::min(start + CONTENT_SIZE_PER_PACKET, file_to_send.size());
+
+	this->header.pack_header(destination);
+	this->getPayload()->pack_payload(destination + REQUEST_HEADER_SIZE, file_to_send.data() + start, end - start, packet_number);
+}
+
+/** SendFileRequest::pack_request
+ * Packs every packet of the file into one byte array.
+ *
+ * The packets are packed once, so resending the file after an error writes the same buffer again,
+ * and the whole file goes out in a single write. The buffer is sized for every packet up front and each
+ * packet is packed straight into it, so the loop doesn't allocate (checked in allocation tracking builds,
+ * see alloc_tracking.hpp).
+ *
+ * @return A vector of bytes with all the packed SendFile requests, one after the other.
+ */
+Bytes SendFileRequest::pack_request() const {
+	PhaseTimer pack_timer(RunPhase::PacketPack);
+	uint16_t total_packets = this->getPayload()->get_total_packets();
+	constexpr size_t packet_size = REQUEST_HEADER_SIZE + PayloadSize::SEND_FILE_PAYLOAD_SIZE;
+
+	Bytes packets(total_packets * packet_size);
+	AllocationFreeCheck allocation_free("packing the file's packets");
+	for (uint16_t packet_number = 0; packet_number < total_packets; packet_number++) {
+		pack_packet(packets.data() + packet_number * packet_size, packet_number);
+	}
+	return packets;
+}
+
+// Every packet of the file is a request of its own on the wire.
+size_t SendFileRequest::packetCount() const {
+	return this->getPayload()->get_total_packets();
+}
+
+/** SendFileRequest::handleResponse
+ * Handles the server's answer to the file.
+ *
+ * This function performs the following steps:
+ * 1. Checks the content size and the file name in the response match the file that was sent.
+ * 2. Saves the cksum the server computed, for the caller to compare with the file's cksum.
+ *
+ * @param response A view of the response in the reader's buffer.
+ * @param result The result the transaction table gives the response (SUCCESS).
+ * @throws std::invalid_argument if the response is about another file.
+ */
+void SendFileRequest::handleResponse(const ResponseView& response, [[maybe_unused]] int result) {
+	FileReceivedCrcView file_received(response);
+	if (this->getPayload()->get_content_size() != file_received.contentSize()) {
+		throw std::invalid_argument("server responded with an error");
+	}
+
+	// The file name is compared in place, without copying it out of the reader's buffer.
+	if (file_received.fileName() != this->getPayload()->get_file_name()) {
+		throw std::invalid_argument("server responded with an error");
+	}
+
+	this->getPayloadReference().setCksum(file_received.cksum());
+}
+
+
+
+EarlyDataResumeRequest::EarlyDataResumeRequest(RequestHeader header, EarlyDataResumptionPayload payload, SendFileRequest& early_data)
+	: Request(header), payload(payload), early_data(early_data) {}
+
+const EarlyDataResumptionPayload* EarlyDataResumeRequest::getPayload() const {
+	return &payload;
+}
+
+// The resumption request is followed by all the packets of the file, so everything goes out in one write.
+Bytes EarlyDataResumeRequest::pack_request() const {
+	Bytes packed_header = this->getHeader().pack_header();
+	Bytes packed_payload = this->getPayload()->pack_payload();
+	Bytes request = packed_header + packed_payload + this->early_data.pack_request();
+	return request;
+}
+
+// The resumption request, followed by every packet of the file.
+size_t EarlyDataResumeRequest::packetCount() const {
+	return 1 + this->early_data.packetCount();
+}
+
+// Same as ResumeRequest::handleResponse: saves the server nonce and the new ticket if the ticket was accepted.
+void EarlyDataResumeRequest::handleResponse(const ResponseView& response, int result) {
+	if (result != SUCCESS) {
+		return;
+	}
+	ResumptionSucceededView resumption(response);
+	this->payload.setServerNonce(resumption.serverNonce(), SESSION_NONCE_LENGTH);
+	this->payload.setNewTicket(resumption.newTicket(), TICKET_LENGTH);
+}
+
+/** EarlyDataResumeRequest::run
+ * Presents a resumption ticket together with a small file (0-RTT) and processes the server's responses.
+ *
+ * This function performs the following steps:
+ * 1. Runs the resumption request (with every packet of the file, encrypted with the early data key) through
+ *    the transaction engine. Its row allows a single attempt - the file would reach the server twice.
+ *    - If the server rejected the ticket (RESUMPTION_FAILED_CODE), it has discarded the file, returns RESUMPTION_REJECTED
+ *      so the caller can fall back to the RSA reconnection.
+ *    - If the server accepted it (RESUMPTION_SUCCEEDED_CODE), the server nonce and the new ticket are saved.
+ * 2. Receives the server's answer to the file, matched against EARLY_DATA_ANSWER_RULE:
+ *    - MESSAGE_RECEIVED_CODE means the server's CRC matched the client's cksum and the file is saved, returns SUCCESS.
+ *    - FILE_RECEIVED_CRC_CODE means it didn't, saves the server's cksum and returns EARLY_DATA_NOT_CONFIRMED so
+ *      the caller continues with the usual CRC handling.
+ *    - Any other answer means the server couldn't receive the file, returns EARLY_DATA_NOT_RECEIVED: the new
+ *      ticket is still valid, and the caller falls back to the reconnection and sends the file as usual.
+ *
+ * @param sock A reference to the TCP socket used for communication with the server.
+ * @param reader The connection's response reader, the server's two answers usually arrive in one read.
+ * @return An integer indicating the result (SUCCESS, EARLY_DATA_NOT_CONFIRMED, EARLY_DATA_NOT_RECEIVED,
+ *         RESUMPTION_REJECTED or FAILURE).
+ */
+int EarlyDataResumeRequest::run(ClientSocket& sock, ResponseReader& reader) {
+	int result = runTransaction(sock, reader, *this);
+	if (result != SUCCESS) {
+		return result;
+	}
+
+	try {
+		ResponseView response;
+		const ExpectedResponse& expected = receiveExpectedResponse(sock, reader, EARLY_DATA_ANSWER_RULE, this->getHeader().getUUID(), response);
+
+		if (expected.result == EARLY_DATA_NOT_CONFIRMED) {
+			FileReceivedCrcView file_received(response);
+			if (file_received.contentSize() != this->early_data.getPayload()->get_content_size()) {
+				throw std::invalid_argument("server responded with an error");
+			}
+			this->early_data.getPayloadReference().setCksum(file_received.cksum());
+		}
+		return expected.result;
+	}
+	catch (std::exception& e) {
+		LOG_WARNING(LogFields().withUuid(this->getHeader().getUUID()).withCode(this->getHeader().getCode()), "%s", e.what());
+	}
+	return EARLY_DATA_NOT_RECEIVED;
+}
@@ -1,112 +1,169 @@
-#ifndef REQUESTS_HPP
-#define REQUESTS_HPP
-
-#include "request.hpp"
-#include "requests.hpp"
-#include "requests_payloads.hpp"
-
-
-class RegisterRequest : public Request {
-protected:
-	RegistrationPayload payload;
-
-public:
-	RegisterRequest(RequestHeader header, RegistrationPayload payload);
-	const RegistrationPayload* getPayload() const override;
-
-	Bytes pack_request() const;
-	int run(tcp::socket& sock);
-};
-
-
-class SendPublicKeyRequest : public Request {
-private:
-	SendPublicKeyPayload payload;
-
-public:
-	SendPublicKeyRequest(RequestHeader header, SendPublicKeyPayload payload);
-	const SendPublicKeyPayload* getPayload() const override;
-
-	string getEncryptedAESKey() const;
-	void updateEncryptedAESKey(const Bytes& encrypted_aes_key);
-
-
-	Bytes pack_request() const;
-	int run(tcp::socket& sock);
-};
-
-
-
-class ReconnectRequest : public Request {
-private:
-	ReconnectionPayload payload;
-
-public:
-	ReconnectRequest(RequestHeader header, ReconnectionPayload payload);
-	const ReconnectionPayload* getPayload() const override;
-	void updateEncryptedAESKey(const Bytes& encrypted_aes_key);
-
-	Bytes pack_request() const;
-	int run(tcp::socket& sock);
-};
-
-
-
-class ValidCrcRequest : public Request {
-private:
-	ValidCrcPayload payload;
-
-public:
-	ValidCrcRequest(RequestHeader header, ValidCrcPayload payload);
-	const ValidCrcPayload* getPayload() const override;
-
-	Bytes pack_request() const;
-	int run(tcp::socket& sock);
-};
-
-
-
-class InvalidCrcRequest : public Request {
-private:
-	InvalidCrcPayload payload;
-
-public:
-	InvalidCrcRequest(RequestHeader header, InvalidCrcPayload payload);
-	const InvalidCrcPayload* getPayload() const override;
-
-	Bytes pack_request() const;
-	int run(tcp::socket& sock);
-};
-
-
-
-class InvalidCrcDoneRequest : public Request {
-private:
-	InvalidCrcDonePayload payload;
-
-public:
-	InvalidCrcDoneRequest(RequestHeader header, InvalidCrcDonePayload payload);
-	const InvalidCrcDonePayload* getPayload() const override;
-
-	Bytes pack_request() const;
-	int run(tcp::socket& sock);
-};
-
-
-
-class SendFileRequest : public Request {
-private:
-	SendFilePayload payload;
-
-public:
-	SendFileRequest(RequestHeader header, SendFilePayload payload);
-	const SendFilePayload* getPayload() const override;
-	SendFilePayload& getPayloadReference();
-
-	Bytes pack_request(const Bytes message_content) const;
-	int sendFileData(tcp::socket& sock);
-
-	int run(tcp::socket& sock);
-};
-
+#ifndef REQUESTS_HPP
+#define REQUESTS_HPP
+
+#include "request.hpp"
+#include "requests.hpp"
+#include "requests_payloads.hpp"
+
+
+class RegisterRequest : public Request {
+protected:
+	RegistrationPayload payload;
+
+public:
+	RegisterRequest(RequestHeader header, RegistrationPayload payload);
+	const RegistrationPayload* getPayload() const override;
+
+	Bytes pack_request() const override;
+	void handleResponse(const ResponseView& response, int result) override;
+};
+
+
+class SendPublicKeyRequest : public Request {
+private:
+	SendPublicKeyPayload payload;
+
+public:
+	SendPublicKeyRequest(RequestHeader header, SendPublicKeyPayload payload);
+	const SendPublicKeyPayload* getPayload() const override;
+
+	string getEncryptedAESKey() const;
+	void updateEncryptedAESKey(const char* encrypted_aes_key);
+
+
+	Bytes pack_request() const override;
+	void handleResponse(const ResponseView& response, int result) override;
+};
+
+
+
+class ReconnectRequest : public Request {
+private:
+	ReconnectionPayload payload;
+
+public:
+	ReconnectRequest(RequestHeader header, ReconnectionPayload payload);
+	const ReconnectionPayload* getPayload() const override;
+	void updateEncryptedAESKey(const char* encrypted_aes_key);
+	void updateServerPublicKey(const char* server_public_key);
+
+	Bytes pack_request() const override;
+	void handleResponse(const ResponseView& response, int result) override;
+};
+
+
+
+class SendX25519PublicKeyRequest : public Request {
+private:
+	SendX25519PublicKeyPayload payload;
+
+public:
+	SendX25519PublicKeyRequest(RequestHeader header, SendX25519PublicKeyPayload payload);
+	const SendX25519PublicKeyPayload* getPayload() const override;
+
+	Bytes pack_request() const override;
+	void handleResponse(const ResponseView& response, int result) override;
+};
+
+
+
+class ValidCrcRequest : public Request {
+private:
+	ValidCrcPayload payload;
+
+public:
+	ValidCrcRequest(RequestHeader header, ValidCrcPayload payload);
+	const ValidCrcPayload* getPayload() const override;
+
+	Bytes pack_request() const override;
+};
+
+
+
+class InvalidCrcRequest : public Request {
+private:
+	InvalidCrcPayload payload;
+
+public:
+	InvalidCrcRequest(RequestHeader header, InvalidCrcPayload payload);
+	const InvalidCrcPayload* getPayload() const override;
+
+	Bytes pack_request() const override;
+};
+
+
+
+class InvalidCrcDoneRequest : public Request {
+private:
+	InvalidCrcDonePayload payload;
+
+public:
+	InvalidCrcDoneRequest(RequestHeader header, InvalidCrcDonePayload payload);
+	const InvalidCrcDonePayload* getPayload() const override;
+
+	Bytes pack_request() const override;
+};
+
+
+
+class ResumeRequest : public Request {
+private:
+	ResumptionPayload payload;
+
+public:
+	ResumeRequest(RequestHeader header, ResumptionPayload payload);
+	const ResumptionPayload* getPayload() const override;
+
+	Bytes pack_request() const override;
+	void handleResponse(const ResponseView& response, int result) override;
+};
+
+
+
+class ResumptionTicketRequest : public Request {
+private:
+	ResumptionTicketRequestPayload payload;
+
+public:
+	ResumptionTicketRequest(RequestHeader header, ResumptionTicketRequestPayload payload);
+	const ResumptionTicketRequestPayload* getPayload() const override;
+
+	Bytes pack_request() const override;
+	void handleResponse(const ResponseView& response, int result) override;
+};
+
+
+
+class SendFileRequest : public Request {
+private:
+	SendFilePayload payload;
+
+public:
+	SendFileRequest(RequestHeader header, SendFilePayload&& payload);
+	const SendFilePayload* getPayload() const override;
+	SendFilePayload& getPayloadReference();
+
+	void pack_packet(Byte* destination, uint16_t packet_number) const;
+	Bytes pack_request() const override;
+	size_t packetCount() const override;
+	void handleResponse(const ResponseView& response, int result) override;
+};
+
+
+
+class EarlyDataResumeRequest : public Request {
+private:
+	EarlyDataResumptionPayload payload;
+	SendFileRequest& early_data;
+
+public:
+	EarlyDataResumeRequest(RequestHeader header, EarlyDataResumptionPayload payload, SendFileRequest& early_data);
+	const EarlyDataResumptionPayload* getPayload() const override;
+
+	Bytes pack_request() const override;
+	size_t packetCount() const override;
+	void handleResponse(const ResponseView& response, int result) override;
+	int run(ClientSocket& sock, ResponseReader& reader) override;
+};
+
 #endif
\ No newline at end of file
@@ -1,274 +1,473 @@
-#include "requests_payloads.hpp"
-#include "utils.hpp"
-
-RegistrationPayload::RegistrationPayload(const string& username) {
-	// Attempt to copy the username
-	errno_t result = strcpy_s(this->username, MAX_USERNAME_LENGTH, username.c_str());
-	if (result != 0) {
-		std::cerr << "Error copying username in RegistrationPayload: source is too long!" << std::endl;
-		// Handle the error appropriately, e.g., set username to an empty string
-		this->username[0] = '\0'; // Ensure username is empty on error
-	}
-}
-
-string RegistrationPayload::getUsername() const { return username; }
-
-Bytes RegistrationPayload::pack_payload() const
-{
-	Bytes packed_payload(REGISTRATION_PAYLOAD_SIZE, 0); // Initialize with zeroes the packed_payload
-
-	// Get the actual length of the username string (up to 255)
-	size_t username_length = std::strlen(this->username);
-
-	// Copy the username into the vector
-	std::copy(this->username, this->username + std::min(username_length, size_t(REGISTRATION_PAYLOAD_SIZE)), packed_payload.begin());
-	return packed_payload;
-}
-
-
-SendPublicKeyPayload::SendPublicKeyPayload(const string& username, const string& public_key) {
-	// Copy the username
-	errno_t result = strcpy_s(this->username, MAX_USERNAME_LENGTH, username.c_str());
-	if (result != 0) {
-		std::cerr << "Error copying username in SendPublicKeyPayload: source is too long!" << std::endl;
-		this->username[0] = '\0'; // Ensure username is empty on error
-	}
-
-	// Copy the public key
-	if (public_key.size() > PUBLIC_KEY_LENGTH) {
-		std::cerr << "Error copying username in public key in SendPublicKeyPayload: source is too long!" << std::endl;
-	}
-	memcpy(this->public_key, public_key.c_str(), public_key.size());
-
-	// Initialize encrypted_aes_key to an empty string
-	this->encrypted_aes_key[0] = '\0';
-}
-
-string SendPublicKeyPayload::getUsername() const { return username; }
-
-string SendPublicKeyPayload::getPublicKey() const { return public_key; }
-
-string SendPublicKeyPayload::getEncryptedAESKey() const {
-	string str_aes_key(encrypted_aes_key, encrypted_aes_key + sizeof(encrypted_aes_key));
-	return str_aes_key;
-}
-
-void SendPublicKeyPayload::setEncryptedAESKey(string encrypted_aes_key) {
-	if (encrypted_aes_key.size() > ENCRYPTED_AES_KEY_LENGTH) {
-		throw std::out_of_range("Encrypted AES key is too long");
-	}
-
-	// Use memcpy to copy the string into the char array
-	std::memcpy(this->encrypted_aes_key, encrypted_aes_key.c_str(), encrypted_aes_key.size());
-}
-
-
-Bytes SendPublicKeyPayload::pack_payload() const {
-
-	constexpr size_t NUM_OF_BYTES_OF_USERNAME = 255;
-	constexpr size_t NUM_OF_BYTES_OF_PUBLIC_KEY = 160;
-
-	// Initialize the packed payload with zeroes and in the correct size
-	Bytes packed_payload(NUM_OF_BYTES_OF_USERNAME + NUM_OF_BYTES_OF_PUBLIC_KEY, 0);
-
-	// Get the actual length of the username string
-	size_t name_length = std::strlen(this->username);
-
-	// Copy the username into the vector, limiting to the maximum size
-	std::copy(this->username, this->username + std::min(name_length, size_t(NUM_OF_BYTES_OF_USERNAME)), packed_payload.begin());
-
-	// Copy the public key into the vector (160 bytes)
-	std::copy(this->public_key, this->public_key + NUM_OF_BYTES_OF_PUBLIC_KEY, packed_payload.begin() + NUM_OF_BYTES_OF_USERNAME);
-
-	return packed_payload;
-}
-
-
-ReconnectionPayload::ReconnectionPayload(const std::string& username) {
-	// Copy the username with error handling
-	errno_t result = strcpy_s(this->username, MAX_USERNAME_LENGTH, username.c_str());
-	if (result != 0) {
-		std::cerr << "Error copying username in ReconnectionPayload: source is too long!" << std::endl;
-		this->username[0] = '\0'; // Ensure username is empty on error
-	}
-
-	// Initialize encrypted_aes_key as an empty string
-	this->encrypted_aes_key[0] = '\0';
-}
-const string ReconnectionPayload::getEncryptedAESKey() const {
-	string str_aes_key(this->encrypted_aes_key, this->encrypted_aes_key + sizeof(this->encrypted_aes_key));
-	return str_aes_key;
-}
-
-
-string ReconnectionPayload::getUsername() const { return username; }
-
-void ReconnectionPayload::setEncryptedAESKey(const char* encrypted_aes_key, const size_t key_length) {
-	if (key_length <= ENCRYPTED_AES_KEY_LENGTH) {
-		std::copy(encrypted_aes_key, encrypted_aes_key + key_length, this->encrypted_aes_key);
-	}
-	else {
-		throw std::length_error("Key length exceeds ENCRYPTED_AES_KEY_LENGTH");
-	}
-}
-
-
-Bytes ReconnectionPayload::pack_payload() const {
-	Bytes packed_payload(RECONNECTION_PAYLOAD_SIZE, 0); // Initialize with zeroes the packed_payload
-
-	// Get the actual length of the username string (up to 255)
-	size_t username_length = std::strlen(this->username);
-
-	// Copy the username into the vector
-	std::copy(this->username, this->username + std::min(username_length, size_t(RECONNECTION_PAYLOAD_SIZE)), packed_payload.begin());
-
-	return packed_payload;
-}
-
-
-
-ValidCrcPayload::ValidCrcPayload(const std::string& file_name) {
-	memset(this->file_name, 0, sizeof(this->file_name));
-	memcpy(this->file_name, file_name.c_str(), std::min(file_name.size(), static_cast<size_t>(MAX_FILE_NAME_LENGTH)));
-}
-
-string ValidCrcPayload::getFileName() const { return file_name; }
-
-Bytes ValidCrcPayload::pack_payload() const {
-	Bytes packed_payload(VALID_CRC_PAYLOAD_SIZE, 0); // Initialize with zeroes the packed_payload
-
-	// Get the actual length of the file name string (up to VALID_CRC_PAYLOAD_SIZE)
-	size_t file_name_length = std::strlen(this->file_name);
-
-	// Copy the file_name into the vector
-	std::copy(this->file_name, this->file_name + std::min(file_name_length, size_t(VALID_CRC_PAYLOAD_SIZE)), packed_payload.begin());
-	return packed_payload;
-}
-
-
-
-InvalidCrcPayload::InvalidCrcPayload(const string& file_name) {
-	memset(this->file_name, 0, sizeof(this->file_name));
-	memcpy(this->file_name, file_name.c_str(), std::min(file_name.size(), static_cast<size_t>(MAX_FILE_NAME_LENGTH)));
-}
-
-string InvalidCrcPayload::getFileName() const { return file_name; }
-
-Bytes InvalidCrcPayload::pack_payload() const {
-	Bytes packed_payload(INVALID_CRC_PAYLOAD_SIZE, 0); // Initialize with zeroes the packed_payload
-
-	// Get the actual length of the file name string (up to INVALID_CRC_PAYLOAD_SIZE)
-	size_t file_name_length = std::strlen(this->file_name);
-
-	// Copy the file_name into the vector
-	std::copy(this->file_name, this->file_name + std::min(file_name_length, size_t(INVALID_CRC_PAYLOAD_SIZE)), packed_payload.begin());
-
-	return packed_payload;
-}
-
-
-
-InvalidCrcDonePayload::InvalidCrcDonePayload(const string& file_name) {
-	memset(this->file_name, 0, sizeof(this->file_name));
-	memcpy(this->file_name, file_name.c_str(), std::min(file_name.size(), static_cast<size_t>(MAX_FILE_NAME_LENGTH)));
-}
-
-string InvalidCrcDonePayload::getFileName() const { return file_name; }
-
-Bytes InvalidCrcDonePayload::pack_payload() const {
-	Bytes packed_payload(INVALID_CRC_DONE_PAYLOAD_SIZE, 0); // Initialize with zeroes the packed_payload
-
-	// Get the actual length of the file name string (up to INVALID_CRC_DONE_PAYLOAD_SIZE)
-	size_t file_name_length = std::strlen(this->file_name);
-
-	// Copy the file_name into the vector using std::copy
-	std::copy(this->file_name, this->file_name + std::min(file_name_length, size_t(INVALID_CRC_DONE_PAYLOAD_SIZE)), packed_payload.begin());
-
-	return packed_payload;
-}
-
-
-
-
-SendFilePayload::SendFilePayload(uint32_t content_size, uint32_t orig_file_size, uint16_t total_packets, const string& file_name, const string& encrypted_file_content)
-	: content_size(content_size), orig_file_size(orig_file_size), packet_number(0), total_packets(total_packets), encrypted_file_content(encrypted_file_content),  cksum(0) {
-	// Attempt to copy the file name
-	memset(this->file_name, 0, sizeof(this->file_name));
-	memcpy(this->file_name, file_name.c_str(), std::min(file_name.size(), static_cast<size_t>(MAX_FILE_NAME_LENGTH)));
-}
-
-// Setting the cksum to the given unsigned long variable
-void SendFilePayload::setCksum(unsigned long cksum) {
-	this->cksum = cksum;
-}
-// Getting the cksum received by the server
-unsigned long SendFilePayload::getCksum() const {
-	return this->cksum;
-}
-
-uint32_t SendFilePayload::get_content_size() const {
-	return content_size;
-}
-
-uint32_t SendFilePayload::get_orig_file_size() const {
-	return orig_file_size;
-}
-
-uint16_t SendFilePayload::get_packet_number() const {
-	return packet_number;
-}
-void SendFilePayload::set_packet_number(const int packet_number) {
-	this->packet_number =packet_number;
-}
-
-uint16_t SendFilePayload::get_total_packets() const {
-	return total_packets;
-}
-
-string SendFilePayload::get_file_name() const { return file_name; }
-
-const string& SendFilePayload::get_encrypted_file_content() const {
-	return encrypted_file_content;
-}
-
-Bytes SendFilePayload::pack_payload(const Bytes message_content) const {
-	Bytes packed_payload(SEND_FILE_PAYLOAD_SIZE, 0);
-
-	// Iterator for filling the vector
-	auto it = packed_payload.begin();
-
-	// Convert and copy content_size (4 bytes) in little-endian
-	uint32_t little_endian_content_size = htole32(this->content_size);
-
-	it = std::copy(reinterpret_cast<const uint8_t*>(&little_endian_content_size),
-		reinterpret_cast<const uint8_t*>(&little_endian_content_size) + sizeof(little_endian_content_size), it);
-	
-	// Convert and copy orig_file_size (4 bytes) in little-endian
-	uint32_t little_endian_orig_file_size = htole32(this->orig_file_size);
-
-	it = std::copy(reinterpret_cast<const uint8_t*>(&little_endian_orig_file_size),
-		reinterpret_cast<const uint8_t*>(&little_endian_orig_file_size) + sizeof(little_endian_orig_file_size), it);
-
-	// Convert and copy packet_number (2 bytes) in little-endian
-	uint16_t little_endian_packet_number = htole16(this->packet_number);
-	it = std::copy(reinterpret_cast<const uint8_t*>(&little_endian_packet_number),
-		reinterpret_cast<const uint8_t*>(&little_endian_packet_number) + sizeof(little_endian_packet_number), it);
-
-	// Convert and copy total_packets (2 bytes) in little-endian
-	uint16_t little_endian_total_packets = htole16(this->total_packets);
-	it = std::copy(reinterpret_cast<const uint8_t*>(&little_endian_total_packets),
-		reinterpret_cast<const uint8_t*>(&little_endian_total_packets) + sizeof(little_endian_total_packets), it);
-
-	// Copy the file_name (MAX_FILE_NAME_LENGTH bytes)
-	it = std::copy(reinterpret_cast<const uint8_t*>(this->file_name),
-		reinterpret_cast<const uint8_t*>(this->file_name) + MAX_FILE_NAME_LENGTH, it);
-
-	it = std::copy(message_content.begin(), message_content.end(), it);
-
-	// Ensure we don't overflow the packed_payload size 
-	if (it > packed_payload.end()) {
-		throw std::overflow_error("Packed payload size exceeded.");
-	}
-
-	return packed_payload;
+#include "requests_payloads.hpp"
+#include "utils.hpp"
+
+RegistrationPayload::RegistrationPayload(const string& username) {
+	// Attempt to copy the username
+	errno_t result = strcpy_s(this->username, MAX_USERNAME_LENGTH, username.c_str());
+	if (result != 0) {
+		LOG_ERROR({}, "Error copying username in RegistrationPayload: source is too long!");
+		// Handle the error appropriately, e.g., set username to an empty string
+		this->username[0] = '\0'; // Ensure username is empty on error
+	}
+}
+
+string RegistrationPayload::getUsername() const { return username; }
+
+Bytes RegistrationPayload::pack_payload() const
+{
+	Bytes packed_payload(REGISTRATION_PAYLOAD_SIZE, 0); // Initialize with zeroes the packed_payload
+
+	// Get the actual length of the username string (up to 255)
+	size_t username_length = std::strlen(this->username);
+
+	// Copy the username into the vector
+	std::copy(this->username, this->username + std::min(username_length, size_t(REGISTRATION_PAYLOAD_SIZE)), packed_payload.begin());
+	return packed_payload;
+}
+
+
+SendPublicKeyPayload::SendPublicKeyPayload(const string& username, const string& public_key) {
+	// Copy the username
+	errno_t result = strcpy_s(this->username, MAX_USERNAME_LENGTH, username.c_str());
+	if (result != 0) {
+		LOG_ERROR({}, "Error copying username in SendPublicKeyPayload: source is too long!");
+		this->username[0] = '\0'; // Ensure username is empty on error
+	}
+
+	// Copy the public key
+	if (public_key.size() > PUBLIC_KEY_LENGTH) {
+		LOG_ERROR({}, "Error copying username in public key in SendPublicKeyPayload: source is too long!");
+	}
+	memcpy(this->public_key, public_key.c_str(), public_key.size());
+
+	// Initialize encrypted_aes_key to an empty string
+	this->encrypted_aes_key[0] = '\0';
+}
+
+string SendPublicKeyPayload::getUsername() const { return username; }
+
+string SendPublicKeyPayload::getPublicKey() const { return public_key; }
+
+string SendPublicKeyPayload::getEncryptedAESKey() const {
+	string str_aes_key(encrypted_aes_key, encrypted_aes_key + sizeof(encrypted_aes_key));
+	return str_aes_key;
+}
+
+void SendPublicKeyPayload::setEncryptedAESKey(const char* encrypted_aes_key, const size_t key_length) {
+	if (key_length > ENCRYPTED_AES_KEY_LENGTH) {
+		throw std::out_of_range("Encrypted AES key is too long");
+	}
+
+	// Use memcpy to copy the key into the char array
+	std::memcpy(this->encrypted_aes_key, encrypted_aes_key, key_length);
+}
+
+
+Bytes SendPublicKeyPayload::pack_payload() const {
+
+	constexpr size_t NUM_OF_BYTES_OF_USERNAME = 255;
+	constexpr size_t NUM_OF_BYTES_OF_PUBLIC_KEY = 160;
+
+	// Initialize the packed payload with zeroes and in the correct size
+	Bytes packed_payload(NUM_OF_BYTES_OF_USERNAME + NUM_OF_BYTES_OF_PUBLIC_KEY, 0);
+
+	// Get the actual length of the username string
+	size_t name_length = std::strlen(this->username);
+
+	// Copy the username into the vector, limiting to the maximum size
+	std::copy(this->username, this->username + std::min(name_length, size_t(NUM_OF_BYTES_OF_USERNAME)), packed_payload.begin());
+
+	// Copy the public key into the vector (160 bytes)
+	std::copy(this->public_key, this->public_key + NUM_OF_BYTES_OF_PUBLIC_KEY, packed_payload.begin() + NUM_OF_BYTES_OF_USERNAME);
+
+	return packed_payload;
+}
+
+
+ReconnectionPayload::ReconnectionPayload(const std::string& username) {
+	// Copy the username with error handling
+	errno_t result = strcpy_s(this->username, MAX_USERNAME_LENGTH, username.c_str());
+	if (result != 0) {
+		LOG_ERROR({}, "Error copying username in ReconnectionPayload: source is too long!");
+		this->username[0] = '\0'; // Ensure username is empty on error
+	}
+
+	// Initialize encrypted_aes_key as an empty string
+	this->encrypted_aes_key[0] = '\0';
+
+	// Only filled in when the server answers with an x25519 key
+	memset(this->server_public_key, 0, sizeof(this->server_public_key));
+}
+const string ReconnectionPayload::getEncryptedAESKey() const {
+	string str_aes_key(this->encrypted_aes_key, this->encrypted_aes_key + sizeof(this->encrypted_aes_key));
+	return str_aes_key;
+}
+
+
+string ReconnectionPayload::getUsername() const { return username; }
+
+void ReconnectionPayload::setEncryptedAESKey(const char* encrypted_aes_key, const size_t key_length) {
+	if (key_length <= ENCRYPTED_AES_KEY_LENGTH) {
+		std::copy(encrypted_aes_key, encrypted_aes_key + key_length, this->encrypted_aes_key);
+	}
+	else {
+		throw std::length_error("Key length exceeds ENCRYPTED_AES_KEY_LENGTH");
+	}
+}
+
+
+string ReconnectionPayload::getServerPublicKey() const {
+	return string(this->server_public_key, this->server_public_key + sizeof(this->server_public_key));
+}
+
+void ReconnectionPayload::setServerPublicKey(const char* server_public_key, const size_t key_length) {
+	if (key_length != X25519_KEY_LENGTH) {
+		throw std::length_error("Key length is not X25519_KEY_LENGTH");
+	}
+	std::copy(server_public_key, server_public_key + key_length, this->server_public_key);
+}
+
+
+Bytes ReconnectionPayload::pack_payload() const {
+	Bytes packed_payload(RECONNECTION_PAYLOAD_SIZE, 0); // Initialize with zeroes the packed_payload
+
+	// Get the actual length of the username string (up to 255)
+	size_t username_length = std::strlen(this->username);
+
+	// Copy the username into the vector
+	std::copy(this->username, this->username + std::min(username_length, size_t(RECONNECTION_PAYLOAD_SIZE)), packed_payload.begin());
+
+	return packed_payload;
+}
+
+
+
+SendX25519PublicKeyPayload::SendX25519PublicKeyPayload(const string& username, const string& public_key) {
+	// Copy the username
+	errno_t result = strcpy_s(this->username, MAX_USERNAME_LENGTH, username.c_str());
+	if (result != 0) {
+		LOG_ERROR({}, "Error copying username in SendX25519PublicKeyPayload: source is too long!");
+		this->username[0] = '\0'; // Ensure username is empty on error
+	}
+
+	if (public_key.size() != X25519_KEY_LENGTH) {
+		throw std::length_error("Public key length is not X25519_KEY_LENGTH");
+	}
+	memcpy(this->public_key, public_key.c_str(), X25519_KEY_LENGTH);
+
+	// The server's key is filled in from the server's response
+	memset(this->server_public_key, 0, sizeof(this->server_public_key));
+}
+
+string SendX25519PublicKeyPayload::getUsername() const { return username; }
+
+string SendX25519PublicKeyPayload::getPublicKey() const {
+	return string(this->public_key, this->public_key + sizeof(this->public_key));
+}
+
+string SendX25519PublicKeyPayload::getServerPublicKey() const {
+	return string(this->server_public_key, this->server_public_key + sizeof(this->server_public_key));
+}
+
+void SendX25519PublicKeyPayload::setServerPublicKey(const char* server_public_key, const size_t key_length) {
+	if (key_length != X25519_KEY_LENGTH) {
+		throw std::length_error("Key length is not X25519_KEY_LENGTH");
+	}
+	std::copy(server_public_key, server_public_key + key_length, this->server_public_key);
+}
+
+Bytes SendX25519PublicKeyPayload::pack_payload() const {
+	// Initialize the packed payload with zeroes and in the correct size
+	Bytes packed_payload(SENDING_X25519_PUBLIC_KEY_PAYLOAD_SIZE, 0);
+
+	// Get the actual length of the username string
+	size_t name_length = std::strlen(this->username);
+
+	// Copy the username into the vector, limiting to the maximum size
+	std::copy(this->username, this->username + std::min(name_length, size_t(MAX_USERNAME_LENGTH)), packed_payload.begin());
+
+	// Copy the public key into the vector (32 bytes) right after the 255 bytes of the username
+	std::copy(this->public_key, this->public_key + X25519_KEY_LENGTH, packed_payload.begin() + MAX_USERNAME_LENGTH);
+
+	return packed_payload;
+}
+
+
+
+ValidCrcPayload::ValidCrcPayload(const std::string& file_name) {
+	memset(this->file_name, 0, sizeof(this->file_name));
+	memcpy(this->file_name, file_name.c_str(), std::min(file_name.size(), static_cast<size_t>(MAX_FILE_NAME_LENGTH)));
+}
+
+string ValidCrcPayload::getFileName() const { return file_name; }
+
+Bytes ValidCrcPayload::pack_payload() const {
+	Bytes packed_payload(VALID_CRC_PAYLOAD_SIZE, 0); // Initialize with zeroes the packed_payload
+
+	// Get the actual length of the file name string (up to VALID_CRC_PAYLOAD_SIZE)
+	size_t file_name_length = std::strlen(this->file_name);
+
+	// Copy the file_name into the vector
+	std::copy(this->file_name, this->file_name + std::min(file_name_length, size_t(VALID_CRC_PAYLOAD_SIZE)), packed_payload.begin());
+	return packed_payload;
+}
+
+
+
+InvalidCrcPayload::InvalidCrcPayload(const string& file_name) {
+	memset(this->file_name, 0, sizeof(this->file_name));
+	memcpy(this->file_name, file_name.c_str(), std::min(file_name.size(), static_cast<size_t>(MAX_FILE_NAME_LENGTH)));
+}
+
+string InvalidCrcPayload::getFileName() const { return file_name; }
+
+Bytes InvalidCrcPayload::pack_payload() const {
+	Bytes packed_payload(INVALID_CRC_PAYLOAD_SIZE, 0); // Initialize with zeroes the packed_payload
+
+	// Get the actual length of the file name string (up to INVALID_CRC_PAYLOAD_SIZE)
+	size_t file_name_length = std::strlen(this->file_name);
+
+	// Copy the file_name into the vector
+	std::copy(this->file_name, this->file_name + std::min(file_name_length, size_t(INVALID_CRC_PAYLOAD_SIZE)), packed_payload.begin());
+
+	return packed_payload;
+}
+
+
+
+InvalidCrcDonePayload::InvalidCrcDonePayload(const string& file_name) {
+	memset(this->file_name, 0, sizeof(this->file_name));
+	memcpy(this->file_name, file_name.c_str(), std::min(file_name.size(), static_cast<size_t>(MAX_FILE_NAME_LENGTH)));
+}
+
+string InvalidCrcDonePayload::getFileName() const { return file_name; }
+
+Bytes InvalidCrcDonePayload::pack_payload() const {
+	Bytes packed_payload(INVALID_CRC_DONE_PAYLOAD_SIZE, 0); // Initialize with zeroes the packed_payload
+
+	// Get the actual length of the file name string (up to INVALID_CRC_DONE_PAYLOAD_SIZE)
+	size_t file_name_length = std::strlen(this->file_name);
+
+	// Copy the file_name into the vector using std::copy
+	std::copy(this->file_name, this->file_name + std::min(file_name_length, size_t(INVALID_CRC_DONE_PAYLOAD_SIZE)), packed_payload.begin());
+
+	return packed_payload;
+}
+
+
+
+
+ResumptionPayload::ResumptionPayload(const string& username, const string& client_nonce, const string& ticket) {
+	// Copy the username with error handling
+	errno_t result = strcpy_s(this->username, MAX_USERNAME_LENGTH, username.c_str());
+	if (result != 0) {
+		LOG_ERROR({}, "Error copying username in ResumptionPayload: source is too long!");
+		this->username[0] = '\0'; // Ensure username is empty on error
+	}
+
+	if (client_nonce.size() != SESSION_NONCE_LENGTH || ticket.size() != TICKET_LENGTH) {
+		throw std::length_error("Invalid client nonce or ticket length in ResumptionPayload");
+	}
+	memcpy(this->client_nonce, client_nonce.c_str(), SESSION_NONCE_LENGTH);
+	memcpy(this->ticket, ticket.c_str(), TICKET_LENGTH);
+
+	// The server nonce and the new ticket are filled in from the server's response
+	memset(this->server_nonce, 0, sizeof(this->server_nonce));
+	memset(this->new_ticket, 0, sizeof(this->new_ticket));
+}
+
+string ResumptionPayload::getUsername() const { return username; }
+
+string ResumptionPayload::getClientNonce() const {
+	return string(this->client_nonce, this->client_nonce + sizeof(this->client_nonce));
+}
+
+string ResumptionPayload::getServerNonce() const {
+	return string(this->server_nonce, this->server_nonce + sizeof(this->server_nonce));
+}
+
+string ResumptionPayload::getNewTicket() const {
+	return string(this->new_ticket, this->new_ticket + sizeof(this->new_ticket));
+}
+
+void ResumptionPayload::setServerNonce(const char* server_nonce, const size_t nonce_length) {
+	if (nonce_length != SESSION_NONCE_LENGTH) {
+		throw std::length_error("Nonce length is not SESSION_NONCE_LENGTH");
+	}
+	std::copy(server_nonce, server_nonce + nonce_length, this->server_nonce);
+}
+
+void ResumptionPayload::setNewTicket(const char* new_ticket, const size_t ticket_length) {
+	if (ticket_length != TICKET_LENGTH) {
+		throw std::length_error("Ticket length is not TICKET_LENGTH");
+	}
+	std::copy(new_ticket, new_ticket + ticket_length, this->new_ticket);
+}
+
+Bytes ResumptionPayload::pack_payload() const {
+	Bytes packed_payload(RESUMPTION_PAYLOAD_SIZE, 0); // Initialize with zeroes the packed_payload
+
+	// Get the actual length of the username string (up to 255)
+	size_t username_length = std::strlen(this->username);
+
+	// Copy the username, then the client nonce and the ticket right after the 255 bytes of the username
+	auto it = packed_payload.begin();
+	std::copy(this->username, this->username + std::min(username_length, size_t(MAX_USERNAME_LENGTH)), it);
+	it += MAX_USERNAME_LENGTH;
+	it = std::copy(this->client_nonce, this->client_nonce + SESSION_NONCE_LENGTH, it);
+	std::copy(this->ticket, this->ticket + TICKET_LENGTH, it);
+
+	return packed_payload;
+}
+
+
+
+EarlyDataResumptionPayload::EarlyDataResumptionPayload(const string& username, const string& client_nonce, const string& ticket, unsigned long cksum)
+	: ResumptionPayload(username, client_nonce, ticket), cksum(cksum) {}
+
+unsigned long EarlyDataResumptionPayload::getCksum() const { return cksum; }
+
+Bytes EarlyDataResumptionPayload::pack_payload() const {
+	Bytes packed_payload = ResumptionPayload::pack_payload();
+
+	// The cksum goes right after the ticket, in little endian order like the header fields
+	uint32_t cksum_in_little_endian = native_to_little(static_cast<uint32_t>(this->cksum));
+	uint8_t* cksum_in_little_endian_ptr = reinterpret_cast<uint8_t*>(&cksum_in_little_endian);
+	packed_payload.insert(packed_payload.end(), cksum_in_little_endian_ptr, cksum_in_little_endian_ptr + sizeof(cksum_in_little_endian));
+
+	return packed_payload;
+}
+
+
+
+ResumptionTicketRequestPayload::ResumptionTicketRequestPayload(const string& username) {
+	// Copy the username with error handling
+	errno_t result = strcpy_s(this->username, MAX_USERNAME_LENGTH, username.c_str());
+	if (result != 0) {
+		LOG_ERROR({}, "Error copying username in ResumptionTicketRequestPayload: source is too long!");
+		this->username[0] = '\0'; // Ensure username is empty on error
+	}
+
+	// The ticket is filled in from the server's response
+	memset(this->ticket, 0, sizeof(this->ticket));
+}
+
+string ResumptionTicketRequestPayload::getUsername() const { return username; }
+
+string ResumptionTicketRequestPayload::getTicket() const {
+	return string(this->ticket, this->ticket + sizeof(this->ticket));
+}
+
+void ResumptionTicketRequestPayload::setTicket(const char* ticket, const size_t ticket_length) {
+	if (ticket_length != TICKET_LENGTH) {
+		throw std::length_error("Ticket length is not TICKET_LENGTH");
+	}
+	std::copy(ticket, ticket + ticket_length, this->ticket);
+}
+
+Bytes ResumptionTicketRequestPayload::pack_payload() const {
+	Bytes packed_payload(RESUMPTION_TICKET_REQUEST_PAYLOAD_SIZE, 0); // Initialize with zeroes the packed_payload
+
+	// Get the actual length of the username string (up to 255)
+	size_t username_length = std::strlen(this->username);
+
+	// Copy the username into the vector
+	std::copy(this->username, this->username + std::min(username_length, size_t(RESUMPTION_TICKET_REQUEST_PAYLOAD_SIZE)), packed_payload.begin());
+
+	return packed_payload;
+}
+
+
+
+
+SendFilePayload::SendFilePayload(uint32_t content_size, uint32_t orig_file_size, uint16_t total_packets, const string& file_name, const TransferString& encrypted_file_content)
+	: content_size(content_size), orig_file_size(orig_file_size), packet_number(0), total_packets(total_packets), encrypted_file_content(encrypted_file_content),  cksum(0) {
+	// Attempt to copy the file name
+	memset(this->file_name, 0, sizeof(this->file_name));
+	memcpy(this->file_name, file_name.c_str(), std::min(file_name.size(), static_cast<size_t>(MAX_FILE_NAME_LENGTH)));
+}
+
+// Setting the cksum to the given unsigned long variable
+void SendFilePayload::setCksum(unsigned long cksum) {
+	this->cksum = cksum;
+}
+// Getting the cksum received by the server
+unsigned long SendFilePayload::getCksum() const {
+	return this->cksum;
+}
+
+uint32_t SendFilePayload::get_content_size() const {
+	return content_size;
+}
+
+uint32_t SendFilePayload::get_orig_file_size() const {
+	return orig_file_size;
+}
+
+uint16_t SendFilePayload::get_packet_number() const {
+	return packet_number;
+}
+void SendFilePayload::set_packet_number(const int packet_number) {
+	this->packet_number =packet_number;
+}
+
+uint16_t SendFilePayload::get_total_packets() const {
+	return total_packets;
+}
+
+string SendFilePayload::get_file_name() const { return file_name; }
+
+const TransferString& SendFilePayload::get_encrypted_file_content() const {
+	return encrypted_file_content;
+}
+
+Bytes SendFilePayload::pack_payload(const Bytes& message_content, uint16_t packet_number) const {
+	if (message_content.size() > CONTENT_SIZE_PER_PACKET) {
+		throw std::overflow_error("Packed payload size exceeded.");
+	}
+	Bytes packed_payload(SEND_FILE_PAYLOAD_SIZE);
+	pack_payload(packed_payload.data(), reinterpret_cast<const char*>(message_content.data()), message_content.size(), packet_number);
+	return packed_payload;
+}
+
+/** SendFilePayload::pack_payload
+ * Packs the payload of one SendFile packet into SEND_FILE_PAYLOAD_SIZE bytes the caller owns.
+ *
+ * @param destination Where to pack the payload.
+ * @param content The packet's part of the encrypted file, at most CONTENT_SIZE_PER_PACKET bytes.
+ * @param content_length Its length, the rest of the packet's content is padded with zeros.
+ * @param packet_number The packet's number, 0-based.
+ */
+void SendFilePayload::pack_payload(Byte* destination, const char* content, size_t content_length, uint16_t packet_number) const {
+	Byte* it = destination;
+
+	// Convert and copy content_size (4 bytes) in little-endian
+	uint32_t little_endian_content_size = htole32(this->content_size);
+
+	it = std::copy(reinterpret_cast<const uint8_t*>(&little_endian_content_size),
+		reinterpret_cast<const uint8_t*>(&little_endian_content_size) + sizeof(little_endian_content_size), it);
+	
+	// Convert and copy orig_file_size (4 bytes) in little-endian
+	uint32_t little_endian_orig_file_size = htole32(this->orig_file_size);
+
+	it = std::copy(reinterpret_cast<const uint8_t*>(&little_endian_orig_file_size),
+		reinterpret_cast<const uint8_t*>(&little_endian_orig_file_size) + sizeof(little_endian_orig_file_size), it);
+
+	// Convert and copy packet_number (2 bytes) in little-endian
+	uint16_t little_endian_packet_number = htole16(packet_number);
+	it = std::copy(reinterpret_cast<const uint8_t*>(&little_endian_packet_number),
+		reinterpret_cast<const uint8_t*>(&little_endian_packet_number) + sizeof(little_endian_packet_number), it);
+
+	// Convert and copy total_packets (2 bytes) in little-endian
+	uint16_t little_endian_total_packets = htole16(this->total_packets);
+	it = std::copy(reinterpret_cast<const uint8_t*>(&little_endian_total_packets),
+		reinterpret_cast<const uint8_t*>(&little_endian_total_packets) + sizeof(little_endian_total_packets), it);
+
+	// Copy the file_name (MAX_FILE_NAME_LENGTH bytes)
+	it = std::copy(reinterpret_cast<const uint8_t*>(this->file_name),
+		reinterpret_cast<const uint8_t*>(this->file_name) + MAX_FILE_NAME_LENGTH, it);
+
+	// Copy the content, and pad the last packet with zeros
+	it = std::copy(reinterpret_cast<const uint8_t*>(content), reinterpret_cast<const uint8_t*>(content) + content_length, it);
+	std::fill(it, destination + SEND_FILE_PAYLOAD_SIZE, 0);
 }
\ No newline at end of file
@@ -1,124 +1,205 @@
-#ifndef REQUEST_PAYLOADS_HPP
-#define REQUEST_PAYLOADS_HPP
-#include "request.hpp"
-#include "utils.hpp"
-
-class RegistrationPayload : public Payload {
-protected:
-    char username[MAX_USERNAME_LENGTH];
-public:
-    RegistrationPayload(const string& username);
-
-    string getUsername() const;
-
-    Bytes pack_payload() const;
-};
-
-
-class SendPublicKeyPayload : public Payload {
-protected:
-    char username[MAX_USERNAME_LENGTH];
-    char public_key[PUBLIC_KEY_LENGTH];
-    char encrypted_aes_key[ENCRYPTED_AES_KEY_LENGTH];
-
-public:
-
-    SendPublicKeyPayload(const string& username, const string& public_key);
-
-    string getUsername() const;
-    string getPublicKey() const;
-    string getEncryptedAESKey() const;
-
-    void setEncryptedAESKey(string encrypted_aes_key);
-
-    Bytes pack_payload() const;
-};
-
-
-
-class ReconnectionPayload : public Payload {
-private:
-    char username[MAX_USERNAME_LENGTH];
-    char encrypted_aes_key[ENCRYPTED_AES_KEY_LENGTH];
-
-public:
-    ReconnectionPayload(const string& username);
-
-    string getUsername() const;
-    const string getEncryptedAESKey() const;
-
-    void setEncryptedAESKey(const char* encrypted_aes_key, const size_t key_length);
-
-    Bytes pack_payload() const;
-};
-
-
-
-class ValidCrcPayload : public Payload {
-protected:
-    char file_name[MAX_FILE_NAME_LENGTH];
-
-public:
-    ValidCrcPayload(const string& file_name);
-
-    string getFileName() const;
-
-    Bytes pack_payload() const;
-};
-
-
-
-
-class InvalidCrcPayload : public Payload {
-protected:
-    char file_name[MAX_FILE_NAME_LENGTH];
-
-public:
-    InvalidCrcPayload(const string& file_name);
-    string getFileName() const;
-
-    Bytes pack_payload() const;
-};
-
-
-
-class InvalidCrcDonePayload : public Payload {
-protected:
-    char file_name[MAX_FILE_NAME_LENGTH];
-
-public:
-    InvalidCrcDonePayload(const string& file_name);
-    string getFileName() const;
-
-    Bytes pack_payload() const;
-};
-
-
-
-class SendFilePayload : public Payload {
-protected:
-    uint32_t content_size; // 4 bytes = 32 bits
-    uint32_t orig_file_size; // 4 bytes = 32 bits
-    uint16_t packet_number; // 2 bytes = 16 bits
-    uint16_t total_packets; // 2 bytes = 16 bits
-    char file_name[MAX_FILE_NAME_LENGTH];
-    string encrypted_file_content;
-    unsigned long cksum;
-public:
-    SendFilePayload(uint32_t content_size, uint32_t orig_file_size, uint16_t total_packets, const string& file_name, const string& encrypted_file_content);
-    uint32_t get_content_size() const;
-    uint32_t get_orig_file_size() const;
-    uint16_t get_packet_number() const;
-    uint16_t get_total_packets() const;
-    void set_packet_number(const int packet_number);
-    string get_file_name() const;
-    const string& get_encrypted_file_content() const;
-    void setCksum(unsigned long cksum);
-    unsigned long getCksum() const;
-
-    Bytes pack_payload(const Bytes message_content) const;
-};
-
-
-
+#ifndef REQUEST_PAYLOADS_HPP
+#define REQUEST_PAYLOADS_HPP
+#include "request.hpp"
+#include "utils.hpp"
+
+class RegistrationPayload : public Payload {
+protected:
+    char username[MAX_USERNAME_LENGTH];
+public:
+    RegistrationPayload(const string& username);
+
+    string getUsername() const;
+
+    Bytes pack_payload() const;
+};
+
+
+class SendPublicKeyPayload : public Payload {
+protected:
+    char username[MAX_USERNAME_LENGTH];
+    char public_key[PUBLIC_KEY_LENGTH];
+    char encrypted_aes_key[ENCRYPTED_AES_KEY_LENGTH];
+
+public:
+
+    SendPublicKeyPayload(const string& username, const string& public_key);
+
+    string getUsername() const;
+    string getPublicKey() const;
+    string getEncryptedAESKey() const;
+
+    void setEncryptedAESKey(const char* encrypted_aes_key, const size_t key_length);
+
+    Bytes pack_payload() const;
+};
+
+
+
+class ReconnectionPayload : public Payload {
+private:
+    char username[MAX_USERNAME_LENGTH];
+    char encrypted_aes_key[ENCRYPTED_AES_KEY_LENGTH];
+    char server_public_key[X25519_KEY_LENGTH];
+
+public:
+    ReconnectionPayload(const string& username);
+
+    string getUsername() const;
+    const string getEncryptedAESKey() const;
+    string getServerPublicKey() const;
+
+    void setEncryptedAESKey(const char* encrypted_aes_key, const size_t key_length);
+    void setServerPublicKey(const char* server_public_key, const size_t key_length);
+
+    Bytes pack_payload() const;
+};
+
+
+
+class SendX25519PublicKeyPayload : public Payload {
+protected:
+    char username[MAX_USERNAME_LENGTH];
+    char public_key[X25519_KEY_LENGTH];
+    char server_public_key[X25519_KEY_LENGTH];
+
+public:
+    SendX25519PublicKeyPayload(const string& username, const string& public_key);
+
+    string getUsername() const;
+    string getPublicKey() const;
+    string getServerPublicKey() const;
+
+    void setServerPublicKey(const char* server_public_key, const size_t key_length);
+
+    Bytes pack_payload() const;
+};
+
+
+
+class ValidCrcPayload : public Payload {
+protected:
+    char file_name[MAX_FILE_NAME_LENGTH];
+
+public:
+    ValidCrcPayload(const string& file_name);
+
+    string getFileName() const;
+
+    Bytes pack_payload() const;
+};
+
+
+
+
+class InvalidCrcPayload : public Payload {
+protected:
+    char file_name[MAX_FILE_NAME_LENGTH];
+
+public:
+    InvalidCrcPayload(const string& file_name);
+    string getFileName() const;
+
+    Bytes pack_payload() const;
+};
+
+
+
+class InvalidCrcDonePayload : public Payload {
+protected:
+    char file_name[MAX_FILE_NAME_LENGTH];
+
+public:
+    InvalidCrcDonePayload(const string& file_name);
+    string getFileName() const;
+
+    Bytes pack_payload() const;
+};
+
+
+
+class ResumptionPayload : public Payload {
+private:
+    char username[MAX_USERNAME_LENGTH];
+    char client_nonce[SESSION_NONCE_LENGTH];
+    char ticket[TICKET_LENGTH];
+    char server_nonce[SESSION_NONCE_LENGTH];
+    char new_ticket[TICKET_LENGTH];
+
+public:
+    ResumptionPayload(const string& username, const string& client_nonce, const string& ticket);
+
+    string getUsername() const;
+    string getClientNonce() const;
+    string getServerNonce() const;
+    string getNewTicket() const;
+
+    void setServerNonce(const char* server_nonce, const size_t nonce_length);
+    void setNewTicket(const char* new_ticket, const size_t ticket_length);
+
+    Bytes pack_payload() const;
+};
+
+
+
+// A resumption request carrying a file: the cksum lets the server confirm the file in the same response.
+class EarlyDataResumptionPayload : public ResumptionPayload {
+private:
+    unsigned long cksum;
+
+public:
+    EarlyDataResumptionPayload(const string& username, const string& client_nonce, const string& ticket, unsigned long cksum);
+
+    unsigned long getCksum() const;
+
+    Bytes pack_payload() const;
+};
+
+
+
+class ResumptionTicketRequestPayload : public Payload {
+private:
+    char username[MAX_USERNAME_LENGTH];
+    char ticket[TICKET_LENGTH];
+
+public:
+    ResumptionTicketRequestPayload(const string& username);
+
+    string getUsername() const;
+    string getTicket() const;
+
+    void setTicket(const char* ticket, const size_t ticket_length);
+
+    Bytes pack_payload() const;
+};
+
+
+
+class SendFilePayload : public Payload {
+protected:
+    uint32_t content_size; // 4 bytes = 32 bits
+    uint32_t orig_file_size; // 4 bytes = 32 bits
+    uint16_t packet_number; // 2 bytes = 16 bits
+    uint16_t total_packets; // 2 bytes = 16 bits
+    char file_name[MAX_FILE_NAME_LENGTH];
+    const TransferString& encrypted_file_content; // the caller's, it isn't copied and has to outlive the payload
+    unsigned long cksum;
+public:
+    SendFilePayload(uint32_t content_size, uint32_t orig_file_size, uint16_t total_packets, const string& file_name, const TransferString& encrypted_file_content);
+    uint32_t get_content_size() const;
+    uint32_t get_orig_file_size() const;
+    uint16_t get_packet_number() const;
+    uint16_t get_total_packets() const;
+    void set_packet_number(const int packet_number);
+    string get_file_name() const;
+    const TransferString& get_encrypted_file_content() const;
+    void setCksum(unsigned long cksum);
+    unsigned long getCksum() const;
+
+    Bytes pack_payload(const Bytes& message_content, uint16_t packet_number) const;
+    void pack_payload(Byte* destination, const char* content, size_t content_length, uint16_t packet_number) const;
+};
+
+
+
 #endif
\ No newline at end of file
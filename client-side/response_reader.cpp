@@ -0,0 +1,141 @@
+#include "response_reader.hpp"
+#include "wire_capture.hpp"
+
+bool ResponseView::is(uint16_t expected_code, uint32_t expected_payload_size) const {
+	return this->code == expected_code && this->payload_size == expected_payload_size;
+}
+
+bool ResponseView::isFor(const UUID& uuid) const {
+	return this->payload_size >= UUID_SIZE && are_uuids_equal(this->payload, uuid);
+}
+
+
+EncryptedAESKeyView::EncryptedAESKeyView(const ResponseView& response)
+	: payload(response.payload) {}
+
+const char* EncryptedAESKeyView::encryptedAESKey() const {
+	return reinterpret_cast<const char*>(this->payload + UUID_SIZE);
+}
+
+
+ServerPublicKeyView::ServerPublicKeyView(const ResponseView& response)
+	: payload(response.payload) {}
+
+const char* ServerPublicKeyView::serverPublicKey() const {
+	return reinterpret_cast<const char*>(this->payload + UUID_SIZE);
+}
+
+
+FileReceivedCrcView::FileReceivedCrcView(const ResponseView& response)
+	: payload(response.payload), payload_size(response.payload_size) {}
+
+uint32_t FileReceivedCrcView::contentSize() const {
+	return extractPayloadContentSize(this->payload);
+}
+
+std::string_view FileReceivedCrcView::fileName() const {
+	return extractSendFileResponseFileName(this->payload, this->payload_size);
+}
+
+unsigned long FileReceivedCrcView::cksum() const {
+	return extractSendFileResponseCksum(this->payload);
+}
+
+
+ResumptionSucceededView::ResumptionSucceededView(const ResponseView& response)
+	: payload(response.payload) {}
+
+const char* ResumptionSucceededView::serverNonce() const {
+	return reinterpret_cast<const char*>(this->payload + UUID_SIZE);
+}
+
+const char* ResumptionSucceededView::newTicket() const {
+	return reinterpret_cast<const char*>(this->payload + UUID_SIZE + SESSION_NONCE_LENGTH);
+}
+
+
+ResumptionTicketView::ResumptionTicketView(const ResponseView& response)
+	: payload(response.payload) {}
+
+const char* ResumptionTicketView::ticket() const {
+	return reinterpret_cast<const char*>(this->payload + UUID_SIZE);
+}
+
+
+ResponseReader::ResponseReader()
+	: buffer(RECEIVE_BUFFER_SIZE), begin(0), end(0), consumed(0), broken(false) {}
+
+/** ResponseReader::fill
+ * Makes sure at least `needed` bytes that weren't handed out yet are in the buffer.
+ *
+ * This function performs the following steps:
+ * 1. If the bytes don't fit after `begin`, moves the unconsumed bytes to the front of the buffer.
+ * 2. Reads from the socket until enough bytes arrived. Each read asks for all the free space in the buffer,
+ *    so whatever the server already sent is fetched with the same syscall.
+ *
+ * @param sock A reference to the TCP socket used for communication with the server.
+ * @param needed The number of bytes needed, at most RECEIVE_BUFFER_SIZE.
+ */
+void ResponseReader::fill(tcp::socket& sock, size_t needed) {
+	if (this->begin + needed > this->buffer.size()) {
+		std::memmove(this->buffer.data(), this->buffer.data() + this->begin, this->end - this->begin);
+		this->end -= this->begin;
+		this->begin = 0;
+	}
+
+	while (this->end - this->begin < needed) {
+		size_t received = sock.read_some(boost::asio::buffer(this->buffer.data() + this->end, this->buffer.size() - this->end));
+		countBytesReceived(received);
+		if (capture_enabled) {
+			captureReceived(this->buffer.data() + this->end, received);
+		}
+		this->end += received;
+	}
+}
+
+/** ResponseReader::next
+ * Receives the next response from the server.
+ *
+ * This function performs the following steps:
+ * 1. Releases the response handed out by the previous call, its view must not be used anymore.
+ * 2. Makes sure the header is in the buffer and extracts the response code and the payload size.
+ * 3. Makes sure the whole payload is in the buffer - usually it arrived with the header.
+ * 4. Returns a view pointing at the payload inside the buffer.
+ *
+ * A payload that can't fit in the buffer isn't read, so the reader doesn't know where the next response
+ * starts. It stays broken from then on: every later call throws too, and the connection has to be dropped
+ * instead of retrying on it.
+ *
+ * @param sock A reference to the TCP socket used for communication with the server.
+ * @return A ResponseView of the response, valid until the next call.
+ * @throws std::length_error if the server announced a payload that can't fit in the buffer, now or before.
+ */
+ResponseView ResponseReader::next(tcp::socket& sock) {
+	AllocationFreeCheck allocation_free("receiving a response");
+	if (this->broken) {
+		throw std::length_error("the connection is out of sync after a payload that was too long");
+	}
+	this->begin += this->consumed;
+	this->consumed = 0;
+	if (this->begin == this->end) {
+		this->begin = this->end = 0;
+	}
+
+	fill(sock, RESPONSE_HEADER_SIZE);
+	const Byte* header = this->buffer.data() + this->begin;
+
+	ResponseView response;
+	response.code = extractCodeFromResponseHeader(header);
+	response.payload_size = extractPayloadSizeFromResponseHeader(header);
+
+	if (response.payload_size > RECEIVE_BUFFER_SIZE - RESPONSE_HEADER_SIZE) {
+		this->broken = true;
+		throw std::length_error("server responded with a payload that is too long");
+	}
+
+	fill(sock, RESPONSE_HEADER_SIZE + response.payload_size);
+	response.payload = this->buffer.data() + this->begin + RESPONSE_HEADER_SIZE;
+	this->consumed = RESPONSE_HEADER_SIZE + response.payload_size;
+
+	return response;
+}
@@ -0,0 +1,88 @@
+#ifndef RESPONSE_READER_HPP
+#define RESPONSE_READER_HPP
+#include "utils.hpp"
+
+#include <string_view>
+
+constexpr size_t RECEIVE_BUFFER_SIZE = 4096; // the largest response (FILE_RECEIVED_CRC) is 286 bytes, so several fit
+
+// A response as it sits in the reader's buffer - nothing is copied out of it.
+// The view is only valid until the next call to ResponseReader::next.
+struct ResponseView {
+	uint16_t code;
+	uint32_t payload_size;
+	const Byte* payload;
+
+	bool is(uint16_t expected_code, uint32_t expected_payload_size) const;
+	bool isFor(const UUID& uuid) const; // every response payload starts with the client's uuid
+};
+
+// Typed views over the payloads of the responses that carry more than a uuid.
+// Like ResponseView they point into the reader's buffer and don't own anything.
+
+// PUBLIC_KEY_RECEIVED, RECONNECTION_SUCCEEDED: uuid (16 bytes) | encrypted AES key (128 bytes)
+struct EncryptedAESKeyView {
+	const Byte* payload;
+
+	explicit EncryptedAESKeyView(const ResponseView& response);
+	const char* encryptedAESKey() const;
+};
+
+// X25519_PUBLIC_KEY_RECEIVED, RECONNECTION_X25519_SUCCEEDED: uuid (16 bytes) | server public key (32 bytes)
+struct ServerPublicKeyView {
+	const Byte* payload;
+
+	explicit ServerPublicKeyView(const ResponseView& response);
+	const char* serverPublicKey() const;
+};
+
+// FILE_RECEIVED_CRC: uuid (16 bytes) | content size (4 bytes) | file name (255 bytes) | cksum (4 bytes)
+struct FileReceivedCrcView {
+	const Byte* payload;
+	uint32_t payload_size;
+
+	explicit FileReceivedCrcView(const ResponseView& response);
+	uint32_t contentSize() const;
+	std::string_view fileName() const;
+	unsigned long cksum() const;
+};
+
+// RESUMPTION_SUCCEEDED: uuid (16 bytes) | server nonce (16 bytes) | new ticket (TICKET_LENGTH bytes)
+struct ResumptionSucceededView {
+	const Byte* payload;
+
+	explicit ResumptionSucceededView(const ResponseView& response);
+	const char* serverNonce() const;
+	const char* newTicket() const;
+};
+
+// RESUMPTION_TICKET: uuid (16 bytes) | ticket (TICKET_LENGTH bytes)
+struct ResumptionTicketView {
+	const Byte* payload;
+
+	explicit ResumptionTicketView(const ResponseView& response);
+	const char* ticket() const;
+};
+
+
+// Reads the server's responses into one reusable buffer.
+// Every read asks the socket for as much as fits in the buffer, so the header and the payload of a response
+// (and often the response after it) arrive in a single read. Bytes read ahead stay in the buffer for the next
+// call, so one reader has to be used for every response of a connection.
+class ResponseReader {
+private:
+	Bytes buffer;
+	size_t begin;    // the first byte that wasn't handed out yet
+	size_t end;      // one past the last byte received from the socket
+	size_t consumed; // the size of the response handed out by the last call to next
+	bool broken;     // a response couldn't be read whole, the bytes after it can't be told apart from it
+
+	void fill(tcp::socket& sock, size_t needed);
+
+public:
+	ResponseReader();
+
+	ResponseView next(tcp::socket& sock);
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include "run_report.hpp"
+#include "utils.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+bool run_report_enabled = false;
+RunCounters run_counters = {};
+
+static string report_path;
+static string run_outcome = "completed";
+static std::chrono::steady_clock::time_point run_start;
+static std::chrono::system_clock::time_point run_start_wall_clock;
+
+static const char* const PHASE_NAMES[] = {
+	"connect",
+	"registration",
+	"rsa_key_generation",
+	"key_exchange",
+	"reconnection",
+	"resumption",
+	"file_read",
+	"local_crc",
+	"encryption",
+	"packet_pack",
+	"packet_send",
+	"crc_wait",
+};
+static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) == static_cast<size_t>(RunPhase::Count), "every phase needs a name in the report");
+
+/** startRunReport
+ * Turns the report on if the TRANSFER_REPORT environment variable names a file to write it to.
+ * Must be called before the client starts any other thread.
+ */
+void startRunReport() {
+	report_path = getEnvironmentVariable("TRANSFER_REPORT");
+	run_report_enabled = !report_path.empty();
+	run_start = std::chrono::steady_clock::now();
+	run_start_wall_clock = std::chrono::system_clock::now();
+}
+
+const char* runPhaseName(RunPhase phase) {
+	return PHASE_NAMES[static_cast<size_t>(phase)];
+}
+
+// How the run ended, "completed" unless a request failed or an error stopped the client.
+void setRunOutcome(const std::string& outcome) {
+	if (run_report_enabled) {
+		run_outcome = outcome;
+	}
+}
+
+static string jsonEscape(const string& text) {
+	std::ostringstream escaped;
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			escaped << '\\' << c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20) {
+			escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+		}
+		else {
+			escaped << c;
+		}
+	}
+	return escaped.str();
+}
+
+/** writeRunReport
+ * Appends the report of the run to the TRANSFER_REPORT file, as one JSON object per line.
+ *
+ * The report holds the run's outcome, its start time (unix milliseconds) and total duration, the time spent
+ * in every phase and how many times it ran, and the bytes and requests that went over the connection.
+ * Durations are in milliseconds. Allocation tracking builds add the allocations made in every phase, and
+ * outside of them ("other").
+ */
+void writeRunReport() {
+	if (!run_report_enabled) {
+		return;
+	}
+
+	auto milliseconds = [](uint64_t nanoseconds) { return static_cast<double>(nanoseconds) / 1e6; };
+	uint64_t total_nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - run_start).count();
+	long long started_at = std::chrono::duration_cast<std::chrono::milliseconds>(run_start_wall_clock.time_since_epoch()).count();
+
+	std::ostringstream report;
+	report << std::fixed << std::setprecision(3);
+	report << "{\"outcome\":\"" << jsonEscape(run_outcome) << "\""
+		<< ",\"started_at_unix_ms\":" << started_at
+		<< ",\"total_ms\":" << milliseconds(total_nanoseconds)
+		<< ",\"phases\":{";
+	for (size_t i = 0; i < static_cast<size_t>(RunPhase::Count); i++) {
+		report << (i == 0 ? "" : ",") << "\"" << PHASE_NAMES[i] << "\":{\"ms\":"
+			<< milliseconds(run_counters.phase_nanoseconds[i].load()) << ",\"count\":" << run_counters.phase_count[i].load() << "}";
+	}
+	report << "}"
+		<< ",\"bytes_sent\":" << run_counters.bytes_sent.load()
+		<< ",\"bytes_received\":" << run_counters.bytes_received.load()
+		<< ",\"requests_sent\":" << run_counters.requests_sent.load()
+		<< ",\"file_size\":" << run_counters.file_size.load()
+		<< ",\"encrypted_file_size\":" << run_counters.encrypted_file_size.load();
+#ifdef TRACK_ALLOCATIONS
+	report << ",\"allocations\":{";
+	for (size_t i = 0; i <= static_cast<size_t>(RunPhase::Count); i++) {
+		uint64_t count, bytes;
+		readAllocations(i, count, bytes);
+		report << (i == 0 ? "" : ",") << "\"" << (i < static_cast<size_t>(RunPhase::Count) ? PHASE_NAMES[i] : "other")
+			<< "\":{\"count\":" << count << ",\"bytes\":" << bytes << "}";
+	}
+	report << "}";
+#endif
+	report << "}\n";
+
+	ofstream report_file(report_path, std::ios::app);
+	if (!report_file) {
+		LOG_WARNING({}, "Couldn't write the run report to %s", report_path.c_str());
+		return;
+	}
+	report_file << report.str();
+}
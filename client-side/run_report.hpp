@@ -0,0 +1,142 @@
+#ifndef RUN_REPORT_HPP
+#define RUN_REPORT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "alloc_tracking.hpp"
+#include "perf_counters.hpp"
+
+// The phases of a run the report times. Some of them overlap: the file is read and its cksum computed on a
+// background thread, and the RSA key pair is generated while the registration request is running.
+enum class RunPhase {
+	Connect,
+	Registration,
+	RSAKeyGeneration,
+	KeyExchange,
+	Reconnection,
+	Resumption,
+	FileRead,
+	LocalCrc,
+	Encryption,
+	PacketPack,
+	PacketSend,
+	CrcWait,
+	Count
+};
+
+struct RunCounters {
+	std::atomic<uint64_t> phase_nanoseconds[static_cast<size_t>(RunPhase::Count)];
+	std::atomic<uint64_t> phase_count[static_cast<size_t>(RunPhase::Count)];
+	std::atomic<uint64_t> bytes_sent;
+	std::atomic<uint64_t> bytes_received;
+	std::atomic<uint64_t> requests_sent; // every SendFile packet counts as a request
+	std::atomic<uint64_t> file_size;
+	std::atomic<uint64_t> encrypted_file_size;
+};
+
+// Set once by startRunReport, before the client starts any other thread. When it's false every hook below
+// is a single branch - no clock is read and no counter is touched.
+extern bool run_report_enabled;
+extern RunCounters run_counters;
+
+void startRunReport();
+void setRunOutcome(const std::string& outcome);
+const char* runPhaseName(RunPhase phase);
+void writeRunReport();
+
+inline void recordPhase(RunPhase phase, std::chrono::steady_clock::duration elapsed) {
+	if (run_report_enabled) {
+		size_t index = static_cast<size_t>(phase);
+		run_counters.phase_nanoseconds[index].fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+		run_counters.phase_count[index].fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+inline void countBytesSent(size_t bytes) {
+	if (run_report_enabled) {
+		run_counters.bytes_sent.fetch_add(bytes, std::memory_order_relaxed);
+	}
+}
+
+inline void countBytesReceived(size_t bytes) {
+	if (run_report_enabled) {
+		run_counters.bytes_received.fetch_add(bytes, std::memory_order_relaxed);
+	}
+}
+
+inline void countRequestsSent(size_t requests) {
+	if (run_report_enabled) {
+		run_counters.requests_sent.fetch_add(requests, std::memory_order_relaxed);
+	}
+}
+
+// The profile needs them too, for the cycles per byte of the phases that walk the file.
+inline void reportFileSizes(size_t file_size, size_t encrypted_file_size) {
+	if (run_report_enabled || profiling_enabled) {
+		run_counters.file_size.store(file_size, std::memory_order_relaxed);
+		run_counters.encrypted_file_size.store(encrypted_file_size, std::memory_order_relaxed);
+	}
+}
+
+// Times a phase from its construction until stop() or its destruction, whichever comes first. When profiling
+// is on it also counts the phase's hardware events on the calling thread (see perf_counters.hpp), and in
+// allocation tracking builds the thread's allocations are attributed to the phase (see alloc_tracking.hpp).
+class PhaseTimer {
+private:
+	RunPhase phase;
+	bool running;
+	bool profiled;
+	std::chrono::steady_clock::time_point start;
+	PerfReading start_counters;
+#ifdef TRACK_ALLOCATIONS
+	bool attributing;
+	size_t previous_allocation_phase;
+#endif
+
+public:
+	explicit PhaseTimer(RunPhase phase, bool timed = true)
+		: phase(phase), running(timed && run_report_enabled), profiled(timed && profiling_enabled) {
+		if (this->running) {
+			this->start = std::chrono::steady_clock::now();
+		}
+		if (this->profiled) {
+			readPerfCounters(this->start_counters);
+		}
+#ifdef TRACK_ALLOCATIONS
+		this->attributing = timed;
+		if (this->attributing) {
+			this->previous_allocation_phase = enterAllocationPhase(static_cast<size_t>(phase));
+		}
+#endif
+	}
+
+	~PhaseTimer() {
+		stop();
+	}
+
+	void stop() {
+#ifdef TRACK_ALLOCATIONS
+		if (this->attributing) {
+			leaveAllocationPhase(this->previous_allocation_phase);
+			this->attributing = false;
+		}
+#endif
+		if (this->profiled) {
+			recordPhaseCounters(static_cast<size_t>(this->phase), this->start_counters);
+			this->profiled = false;
+		}
+		if (this->running) {
+			recordPhase(this->phase, std::chrono::steady_clock::now() - this->start);
+			this->running = false;
+		}
+	}
+
+	PhaseTimer(const PhaseTimer&) = delete;
+	PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
+
+#endif
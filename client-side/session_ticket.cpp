@@ -0,0 +1,53 @@
+#include "session_ticket.hpp"
+#include "HMACWrapper.hpp"
+
+#include <osrng.h>
+
+/** deriveResumptionSecret
+ * Derives the resumption secret bound to an AES session key.
+ *
+ * Both sides compute it from the AES key they just agreed on, so the secret itself never
+ * goes over the wire - the server wraps its copy inside the ticket it issues.
+ *
+ * @param aes_key The AES key of the current session.
+ * @return A RESUMPTION_SECRET_LENGTH bytes long secret.
+ */
+string deriveResumptionSecret(const string& aes_key) {
+	return HMACWrapper::sign(aes_key, "resumption");
+}
+
+/** deriveResumedAESKey
+ * Derives the AES key of a resumed session.
+ *
+ * @param resumption_secret The secret stored alongside the ticket that was presented.
+ * @param client_nonce The nonce the client sent in the resumption request.
+ * @param server_nonce The nonce the server answered with.
+ * @return A fresh AESWrapper::DEFAULT_KEYLENGTH bytes long AES key.
+ */
+string deriveResumedAESKey(const string& resumption_secret, const string& client_nonce, const string& server_nonce) {
+	return HMACWrapper::sign(resumption_secret, "session key" + client_nonce + server_nonce);
+}
+
+/** deriveEarlyDataKey
+ * Derives the AES key of the file sent along with the resumption request, before the server's nonce is known.
+ *
+ * Only the client's nonce is mixed in, so the server can't make this key fresh - a replayed request
+ * can only upload the same file again, and the rest of the session uses the key from deriveResumedAESKey.
+ *
+ * @param resumption_secret The secret stored alongside the ticket that is presented.
+ * @param client_nonce The nonce the client sends in the resumption request.
+ * @return A AESWrapper::DEFAULT_KEYLENGTH bytes long AES key.
+ */
+string deriveEarlyDataKey(const string& resumption_secret, const string& client_nonce) {
+	return HMACWrapper::sign(resumption_secret, "early data key" + client_nonce);
+}
+
+/** generateSessionNonce
+ * Generates a random SESSION_NONCE_LENGTH bytes long nonce for a resumption request.
+ */
+string generateSessionNonce() {
+	CryptoPP::AutoSeededRandomPool rng;
+	string nonce(SESSION_NONCE_LENGTH, '\0');
+	rng.GenerateBlock(reinterpret_cast<CryptoPP::byte*>(&nonce[0]), nonce.size());
+	return nonce;
+}
@@ -0,0 +1,17 @@
+#ifndef SESSION_TICKET_HPP
+#define SESSION_TICKET_HPP
+#include "utils.hpp"
+
+// A resumption ticket issued by the server together with the secret it wraps.
+// The ticket itself is opaque to the client, only the server can open it.
+struct SessionTicket {
+	string resumption_secret;
+	string ticket;
+};
+
+string deriveResumptionSecret(const string& aes_key);
+string deriveResumedAESKey(const string& resumption_secret, const string& client_nonce, const string& server_nonce);
+string deriveEarlyDataKey(const string& resumption_secret, const string& client_nonce);
+string generateSessionNonce();
+
+#endif
@@ -0,0 +1,232 @@
+#include "socket_policy.hpp"
+#include "metrics.hpp"
+#include "uring_io.hpp"
+#include "trace.hpp"
+#include "wire_capture.hpp"
+
+#include <algorithm>
+#include <climits>
+
+// The buffers of a write, without owning them. asio copies the buffer sequence it writes, and copying the
+// vector would allocate on every write.
+struct BufferSequenceView {
+	using value_type = boost::asio::const_buffer;
+	using const_iterator = const boost::asio::const_buffer*;
+
+	const_iterator first;
+	const_iterator last;
+
+	const_iterator begin() const { return this->first; }
+	const_iterator end() const { return this->last; }
+};
+
+#ifdef TCP_CORK
+using cork_option = boost::asio::detail::socket_option::boolean<IPPROTO_TCP, TCP_CORK>;
+#endif
+#ifdef TCP_NOTSENT_LOWAT
+using notsent_lowat_option = boost::asio::detail::socket_option::integer<IPPROTO_TCP, TCP_NOTSENT_LOWAT>;
+#endif
+
+/** SocketSettings::sendBufferSize
+ * Returns the SO_SNDBUF the connection should use.
+ *
+ * The send buffer has to hold everything that was sent but not acknowledged yet, so a link is only kept busy
+ * if it can hold the bandwidth-delay product: bandwidth (bytes per ms) times the round trip time (ms).
+ *
+ * @return send_buffer_size if it was set, otherwise the bandwidth-delay product, or 0 to leave the OS default.
+ */
+uint32_t SocketSettings::sendBufferSize() const {
+	if (this->send_buffer_size != 0) {
+		return this->send_buffer_size;
+	}
+	uint64_t bdp = static_cast<uint64_t>(this->bandwidth_mbit) * 125 * this->rtt_ms; // 1 Mbit/s = 125 bytes/ms
+	return static_cast<uint32_t>(std::min<uint64_t>(bdp, INT_MAX));
+}
+
+/** loadSocketSettings
+ * Reads the socket settings from a file of "name=value" lines.
+ *
+ * This function performs the following steps:
+ * 1. If the file doesn't exist, returns the default settings.
+ * 2. Skips empty lines and lines starting with '#'.
+ * 3. Sets every known setting to its value. A line with an unknown name or a value that isn't a
+ *    non-negative integer is reported and ignored - a bad line never stops the transfer.
+ *
+ * @param settings_path The path to the 'socket.info' file.
+ * @return The settings read from the file, with defaults for the settings it doesn't have.
+ */
+SocketSettings loadSocketSettings(const string& settings_path) {
+	SocketSettings settings;
+	ifstream settings_file(settings_path);
+	string line;
+
+	if (!settings_file.is_open()) {
+		return settings;
+	}
+
+	while (getline(settings_file, line)) {
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+
+		size_t separator = line.find('=');
+		string name = line.substr(0, separator);
+		string value = separator == string::npos ? "" : line.substr(separator + 1);
+		if (!is_integer(value) || value[0] == '-' || value.size() > 9) {
+			LOG_WARNING({}, "socket.info: ignoring '%s'", line.c_str());
+			continue;
+		}
+		uint32_t number = static_cast<uint32_t>(std::stoul(value));
+
+		if (name == "no_delay") {
+			settings.no_delay = number != 0;
+		}
+		else if (name == "bandwidth_mbit") {
+			settings.bandwidth_mbit = number;
+		}
+		else if (name == "rtt_ms") {
+			settings.rtt_ms = number;
+		}
+		else if (name == "send_buffer_size") {
+			settings.send_buffer_size = number;
+		}
+		else if (name == "notsent_lowat") {
+			settings.notsent_lowat = number;
+		}
+		else if (name == "cork") {
+			settings.cork = number != 0;
+		}
+		else if (name == "io_uring") {
+			settings.io_uring = number != 0;
+		}
+		else {
+			LOG_WARNING({}, "socket.info: ignoring '%s'", line.c_str());
+		}
+	}
+
+	settings_file.close();
+	return settings;
+}
+
+/** applySocketSettings
+ * Tunes a connected socket, keeps the settings with it and puts it in the control phase.
+ *
+ * This function performs the following steps:
+ * 1. Sets SO_SNDBUF to the size the settings ask for, if any.
+ * 2. Sets TCP_NOTSENT_LOWAT, if asked for and the OS has it, so the kernel doesn't queue much more than the
+ *    link can carry and the write returns as soon as the tail of the file can be handed to it.
+ * 3. Sets TCP_NODELAY as the settings ask.
+ * An option the OS refuses is reported and skipped - the defaults still work, only slower.
+ *
+ * @param sock A reference to the connected TCP socket.
+ * @param settings The settings read by loadSocketSettings.
+ */
+void applySocketSettings(ClientSocket& sock, const SocketSettings& settings) {
+	boost::system::error_code error;
+	sock.settings = settings;
+
+	uint32_t send_buffer_size = settings.sendBufferSize();
+	if (send_buffer_size != 0) {
+		sock.set_option(boost::asio::socket_base::send_buffer_size(static_cast<int>(send_buffer_size)), error);
+		if (error) {
+			LOG_WARNING({}, "Couldn't set the send buffer size: %s", error.message().c_str());
+		}
+	}
+
+#ifdef TCP_NOTSENT_LOWAT
+	if (settings.notsent_lowat != 0) {
+		sock.set_option(notsent_lowat_option(static_cast<int>(settings.notsent_lowat)), error);
+		if (error) {
+			LOG_WARNING({}, "Couldn't set TCP_NOTSENT_LOWAT: %s", error.message().c_str());
+		}
+	}
+#endif
+
+	sock.set_option(tcp::no_delay(settings.no_delay), error);
+	if (error) {
+		LOG_WARNING({}, "Couldn't set TCP_NODELAY: %s", error.message().c_str());
+	}
+	sock.phase = SocketPhase::Control;
+}
+
+/** setSocketPhase
+ * Switches the socket between the control and the bulk phase.
+ *
+ * In the bulk phase the socket is corked (TCP_CORK, where the OS has it), so the request headers and the
+ * packets' payloads are only sent as full segments. Going back to the control phase uncorks it, which sends
+ * whatever is left right away - small requests then go out immediately thanks to TCP_NODELAY.
+ * Without TCP_CORK both phases are the same, and the file is still sent in a single write.
+ *
+ * @param sock A reference to the connected TCP socket.
+ * @param phase The phase to switch to.
+ */
+void setSocketPhase(ClientSocket& sock, SocketPhase phase) {
+	if (phase == sock.phase) {
+		return;
+	}
+	sock.phase = phase;
+
+#ifdef TCP_CORK
+	if (sock.settings.cork) {
+		boost::system::error_code error;
+		sock.set_option(cork_option(phase == SocketPhase::Bulk), error);
+		if (error) {
+			LOG_WARNING({}, "Couldn't set TCP_CORK: %s", error.message().c_str());
+		}
+	}
+#endif
+}
+
+/** writeInPhase
+ * Writes buffers on the socket in the given phase, and switches back to the control phase.
+ *
+ * In the bulk phase, when the settings ask for io_uring, the buffers are sent through it (see uringSend);
+ * if io_uring isn't available they are written with asio like every other write, corked.
+ * The bytes the socket accepts are counted in the metrics after every system call, so a long write of the
+ * file's packets shows its progress while it is still going.
+ *
+ * @param sock A reference to the connected TCP socket.
+ * @param buffers The buffers to write, in order.
+ * @param phase The phase to write them in.
+ */
+void writeInPhase(ClientSocket& sock, const vector<boost::asio::const_buffer>& buffers, SocketPhase phase) {
+	size_t bytes = boost::asio::buffer_size(buffers);
+	TraceSpan span(phase == SocketPhase::Bulk ? "write packets" : "write", static_cast<int64_t>(bytes));
+	PhaseTimer send_timer(RunPhase::PacketSend, phase == SocketPhase::Bulk);
+	countBytesSent(bytes);
+	if (capture_enabled) {
+		captureSent(buffers);
+	}
+	if (phase == SocketPhase::Bulk) {
+		startBulkWrite(bytes);
+	}
+
+	// io_uring sends aren't corked: a zero copy send completes only once its data is on the wire, and a corked
+	// tail would wait for the cork timeout. They coalesce the buffers with MSG_MORE instead.
+	if (phase == SocketPhase::Bulk && sock.settings.io_uring && uringSend(sock, buffers)) {
+		return;
+	}
+	SocketPhaseScope scope(sock, phase);
+	AllocationFreeCheck allocation_free(phase == SocketPhase::Bulk ? "writing the file's packets" : "writing a request");
+	// the completion condition runs before every system call, the bytes of the last one are counted after the write.
+	size_t counted = 0;
+	boost::asio::write(sock, BufferSequenceView{ buffers.data(), buffers.data() + buffers.size() }, [&](const boost::system::error_code& error, size_t written) {
+		countBytesWritten(written - counted, phase == SocketPhase::Bulk);
+		counted = written;
+		return boost::asio::transfer_all()(error, written);
+	});
+	countBytesWritten(bytes - counted, phase == SocketPhase::Bulk);
+}
+
+
+SocketPhaseScope::SocketPhaseScope(ClientSocket& sock, SocketPhase phase)
+	: sock(sock) {
+	setSocketPhase(sock, phase);
+}
+
+SocketPhaseScope::~SocketPhaseScope() {
+	setSocketPhase(this->sock, SocketPhase::Control);
+}
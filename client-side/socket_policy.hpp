@@ -0,0 +1,55 @@
+#ifndef SOCKET_POLICY_HPP
+#define SOCKET_POLICY_HPP
+#include "utils.hpp"
+
+// The socket options of the connection, read from the optional 'socket.info' file next to 'transfer.info'.
+// Every setting can be left out of the file, and the file itself is optional - the defaults are used instead.
+struct SocketSettings {
+	bool no_delay = true;          // no_delay=1 - TCP_NODELAY, so small control requests don't wait for Nagle
+	uint32_t bandwidth_mbit = 0;   // bandwidth_mbit=N - the link's bandwidth (Mbit/s), with rtt_ms sizes SO_SNDBUF
+	uint32_t rtt_ms = 0;           // rtt_ms=N - the round trip time to the server (ms)
+	uint32_t send_buffer_size = 0; // send_buffer_size=N - SO_SNDBUF in bytes, overrides the bandwidth-delay product
+	uint32_t notsent_lowat = 0;    // notsent_lowat=N - TCP_NOTSENT_LOWAT in bytes (0 leaves the OS default)
+	bool cork = true;              // cork=1 - TCP_CORK while the file is written, where the OS has it
+	bool io_uring = false;         // io_uring=1 - read and send the file with io_uring, where the OS has it
+
+	uint32_t sendBufferSize() const; // 0 leaves the OS default
+};
+
+// What the connection is doing: exchanging small control messages, or writing the file's packets.
+enum class SocketPhase {
+	Control,
+	Bulk
+};
+
+// A connection to the server: a TCP socket that also keeps the settings it was tuned with and the phase it is
+// in, for the transaction engine, which only sees the socket. Each connection has its own, so connections
+// written from different threads (the daemon's pool, the load generator's clients) never share them.
+class ClientSocket : public tcp::socket {
+public:
+	SocketSettings settings;                  // set by applySocketSettings
+	SocketPhase phase = SocketPhase::Control; // switched by setSocketPhase
+
+	explicit ClientSocket(boost::asio::io_context& io_context) : tcp::socket(io_context) {}
+};
+
+SocketSettings loadSocketSettings(const string& settings_path);
+void applySocketSettings(ClientSocket& sock, const SocketSettings& settings);
+void setSocketPhase(ClientSocket& sock, SocketPhase phase);
+void writeInPhase(ClientSocket& sock, const vector<boost::asio::const_buffer>& buffers, SocketPhase phase);
+
+// Switches the socket to a phase for one write, and back to the control phase when it goes out of scope -
+// leaving the bulk phase uncorks the socket, so the tail of the write is sent before waiting for the response.
+class SocketPhaseScope {
+private:
+	ClientSocket& sock;
+
+public:
+	SocketPhaseScope(ClientSocket& sock, SocketPhase phase);
+	~SocketPhaseScope();
+
+	SocketPhaseScope(const SocketPhaseScope&) = delete;
+	SocketPhaseScope& operator=(const SocketPhaseScope&) = delete;
+};
+
+#endif
@@ -0,0 +1,111 @@
+// Checks that the paths alloc_tracking.hpp marks as allocation free stay that way: packing a multi-packet file's
+// SendFile requests, writing them to a socket and receiving the server's response. A loopback peer stands in for
+// the server - it reads the packets and answers each write with a FILE_RECEIVED_CRC response - so nothing is
+// encrypted and no server has to run.
+//
+// A marked path that allocates aborts the process (AllocationFreeCheck). Around them the check counts the
+// calling thread's allocations itself and exits with 1 if a warmed up round allocated anything, so it also
+// catches allocations just outside the marked scopes.
+//
+// Usage: allocation_check [--rounds N]
+
+#include "../alloc_tracking.hpp"
+#include "../codes.hpp"
+#include "../requests.hpp"
+#include "../requests_payloads.hpp"
+#include "../response_reader.hpp"
+#include "../socket_policy.hpp"
+
+#include <thread>
+
+#ifndef TRACK_ALLOCATIONS
+#error "allocation_check counts allocations, build it with TRACK_ALLOCATIONS defined"
+#endif
+
+constexpr size_t CHECK_FILE_SIZE = (size_t(1) << 20) + 100; // 1025 packets, the last one padded
+constexpr auto CHECK_FILE_NAME = "allocation_check.bin";
+
+/** answerWrites
+ * The server's side of the check: reads every round's packets and answers each round with a FILE_RECEIVED_CRC
+ * response. It runs on its own thread, so its allocations aren't counted against the client's.
+ *
+ * @param peer The accepted connection.
+ * @param round_size The bytes of a round's packets.
+ * @param rounds How many rounds to answer.
+ */
+static void answerWrites(tcp::socket& peer, size_t round_size, int rounds) {
+	Bytes received(round_size);
+	Bytes response(RESPONSE_HEADER_SIZE + PayloadSize::FILE_RECEIVED_CRC_PAYLOAD_SIZE, 0);
+	response[0] = VERSION;
+	uint16_t code = native_to_little(static_cast<uint16_t>(Codes::FILE_RECEIVED_CRC_CODE));
+	uint32_t payload_size = native_to_little(static_cast<uint32_t>(PayloadSize::FILE_RECEIVED_CRC_PAYLOAD_SIZE));
+	memcpy(response.data() + 1, &code, sizeof(code));
+	memcpy(response.data() + 3, &payload_size, sizeof(payload_size));
+
+	for (int round = 0; round < rounds; round++) {
+		boost::asio::read(peer, boost::asio::buffer(received));
+		boost::asio::write(peer, boost::asio::buffer(response));
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int rounds = 4;
+	if (argc == 3 && string(argv[1]) == "--rounds") {
+		rounds = std::max(2, std::atoi(argv[2]));
+	}
+	else if (argc != 1) {
+		std::cerr << "usage: allocation_check [--rounds N]" << std::endl;
+		return 1;
+	}
+
+	TransferString content(CHECK_FILE_SIZE, '\0');
+	for (size_t i = 0; i < content.size(); i++) {
+		content[i] = static_cast<char>(i * 131 + (i >> 8));
+	}
+	uint16_t total_packets = static_cast<uint16_t>(TOTAL_PACKETS(CHECK_FILE_SIZE));
+	UUID uuid = getUUIDFromString("0123456789abcdef0123456789abcdef");
+	SendFilePayload send_file_payload(static_cast<uint32_t>(content.size()), static_cast<uint32_t>(content.size()), total_packets, CHECK_FILE_NAME, content);
+	SendFileRequest send_file_request(RequestHeader(uuid, Codes::SENDING_FILE_CODE, PayloadSize::SEND_FILE_PAYLOAD_SIZE), std::move(send_file_payload));
+
+	// Packing returns the buffer of every packet, its one allocation - the packets are packed straight into it.
+	uint64_t before = threadAllocationCount();
+	Bytes packets = send_file_request.pack_request();
+	uint64_t packing_allocations = threadAllocationCount() - before;
+	std::cout << "packing " << total_packets << " packets: " << packing_allocations << " allocations" << std::endl;
+
+	boost::asio::io_context io_context;
+	tcp::acceptor acceptor(io_context, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+	ClientSocket sock(io_context);
+	sock.connect(acceptor.local_endpoint());
+	tcp::socket peer(io_context);
+	acceptor.accept(peer);
+	std::thread server(answerWrites, std::ref(peer), packets.size(), rounds);
+
+	// The first round is a warmup: the socket's phase switches and the metrics may set themselves up on first use.
+	ResponseReader reader;
+	vector<boost::asio::const_buffer> buffers{ boost::asio::buffer(packets) };
+	uint64_t round_allocations = 0;
+	for (int round = 0; round < rounds; round++) {
+		before = threadAllocationCount();
+		writeInPhase(sock, buffers, SocketPhase::Bulk);
+		ResponseView response = reader.next(sock);
+		if (!response.is(Codes::FILE_RECEIVED_CRC_CODE, PayloadSize::FILE_RECEIVED_CRC_PAYLOAD_SIZE)) {
+			std::cerr << "unexpected response " << response.code << std::endl;
+			server.join();
+			return 1;
+		}
+		if (round > 0) {
+			round_allocations += threadAllocationCount() - before;
+		}
+	}
+	server.join();
+	std::cout << "writing and receiving " << rounds - 1 << " rounds after the warmup: " << round_allocations << " allocations" << std::endl;
+
+	if (packing_allocations > 1 || round_allocations != 0) {
+		std::cerr << "allocation check failed" << std::endl;
+		return 1;
+	}
+	std::cout << "allocation check passed" << std::endl;
+	return 0;
+}
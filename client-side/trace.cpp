@@ -0,0 +1,113 @@
+#include "trace.hpp"
+#include "utils.hpp"
+
+#include <memory>
+#include <mutex>
+
+bool tracing_enabled = false;
+
+static string trace_path;
+static std::chrono::steady_clock::time_point trace_start;
+
+// Every thread's buffer, in the order the threads first recorded a span. The mutex is only taken once per
+// thread, to add its buffer.
+static std::mutex trace_buffers_mutex;
+static vector<std::unique_ptr<TraceBuffer>> trace_buffers;
+static thread_local TraceBuffer* thread_trace_buffer = nullptr;
+
+/** startTracing
+ * Turns tracing on if the TRANSFER_TRACE environment variable names a file to write the trace to.
+ * Must be called before the client starts any other thread.
+ */
+void startTracing() {
+	trace_path = getEnvironmentVariable("TRANSFER_TRACE");
+	tracing_enabled = !trace_path.empty();
+	trace_start = std::chrono::steady_clock::now();
+}
+
+uint64_t traceClock() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - trace_start).count();
+}
+
+static TraceBuffer* threadTraceBuffer() {
+	if (thread_trace_buffer == nullptr) {
+		std::unique_ptr<TraceBuffer> buffer = std::make_unique<TraceBuffer>();
+		buffer->count.store(0, std::memory_order_relaxed);
+		buffer->dropped = 0;
+
+		std::lock_guard<std::mutex> lock(trace_buffers_mutex);
+		buffer->thread_id = static_cast<uint32_t>(trace_buffers.size() + 1);
+		thread_trace_buffer = buffer.get();
+		trace_buffers.push_back(std::move(buffer));
+	}
+	return thread_trace_buffer;
+}
+
+// Appends a span that started at start_ns and ends now to the calling thread's buffer.
+void recordTraceEvent(const char* name, uint64_t start_ns, int64_t argument) {
+	uint64_t end_ns = traceClock();
+	TraceBuffer* buffer = threadTraceBuffer();
+	size_t index = buffer->count.load(std::memory_order_relaxed);
+	if (index == TRACE_EVENTS_PER_THREAD) {
+		buffer->dropped++;
+		return;
+	}
+	buffer->events[index] = { name, start_ns, end_ns - start_ns, argument };
+	buffer->count.store(index + 1, std::memory_order_release);
+}
+
+/** writeTrace
+ * Writes every recorded span to the TRANSFER_TRACE file in the Chrome trace event format.
+ *
+ * Every thread is its own track (named "main" for the first thread that traced and "worker N" for the others)
+ * and every span is a complete ("X") event with microsecond timestamps, so the file opens as is in Perfetto
+ * or chrome://tracing. Must be called after the other threads stopped tracing.
+ */
+void writeTrace() {
+	if (!tracing_enabled) {
+		return;
+	}
+
+	ofstream trace_file(trace_path, std::ios::trunc);
+	if (!trace_file) {
+		LOG_WARNING({}, "Couldn't write the trace to %s", trace_path.c_str());
+		return;
+	}
+
+	char event[256];
+	bool first = true;
+	auto write_event = [&](const char* text) {
+		trace_file << (first ? "\n" : ",\n") << text;
+		first = false;
+	};
+
+	trace_file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	std::lock_guard<std::mutex> lock(trace_buffers_mutex);
+	for (const std::unique_ptr<TraceBuffer>& buffer : trace_buffers) {
+		string thread_name = buffer->thread_id == 1 ? "main" : "worker " + std::to_string(buffer->thread_id - 1);
+		snprintf(event, sizeof(event), "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}",
+			buffer->thread_id, thread_name.c_str());
+		write_event(event);
+
+		size_t count = buffer->count.load(std::memory_order_acquire);
+		for (size_t i = 0; i < count; i++) {
+			const TraceEvent& span = buffer->events[i];
+			int length = snprintf(event, sizeof(event), "{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"name\":\"%s\",\"ts\":%.3f,\"dur\":%.3f",
+				buffer->thread_id, span.name, span.start_ns / 1000.0, span.duration_ns / 1000.0);
+			if (span.argument >= 0) {
+				snprintf(event + length, sizeof(event) - length, ",\"args\":{\"value\":%lld}}", static_cast<long long>(span.argument));
+			}
+			else {
+				snprintf(event + length, sizeof(event) - length, "}");
+			}
+			write_event(event);
+		}
+
+		if (buffer->dropped > 0) {
+			snprintf(event, sizeof(event), "{\"ph\":\"i\",\"pid\":1,\"tid\":%u,\"s\":\"t\",\"name\":\"dropped %zu events\",\"ts\":%.3f}",
+				buffer->thread_id, buffer->dropped, traceClock() / 1000.0);
+			write_event(event);
+		}
+	}
+	trace_file << "\n]}\n";
+}
@@ -0,0 +1,61 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+constexpr size_t TRACE_EVENTS_PER_THREAD = 1 << 16; // events past this are dropped (and counted in the trace)
+
+// A finished span, as a Chrome trace "complete" event. The name must be a string literal.
+struct TraceEvent {
+	const char* name;
+	uint64_t start_ns;    // since startTracing
+	uint64_t duration_ns;
+	int64_t argument;     // shown as args.value, -1 for none
+};
+
+// The events of one thread. Only the owning thread writes to it, so recording a span is a store and a
+// release of the count - no lock and no allocation. writeTrace reads the buffers after the threads finished.
+struct TraceBuffer {
+	uint32_t thread_id;
+	std::atomic<size_t> count;
+	size_t dropped;
+	TraceEvent events[TRACE_EVENTS_PER_THREAD];
+};
+
+// Set once by startTracing, before the client starts any other thread.
+extern bool tracing_enabled;
+
+void startTracing();
+void writeTrace();
+uint64_t traceClock();
+void recordTraceEvent(const char* name, uint64_t start_ns, int64_t argument);
+
+// Records the time from its construction to its destruction as a span on the calling thread's track.
+class TraceSpan {
+private:
+	const char* name;
+	int64_t argument;
+	uint64_t start_ns;
+
+public:
+	explicit TraceSpan(const char* name, int64_t argument = -1)
+		: name(name), argument(argument), start_ns(0) {
+		if (tracing_enabled) {
+			this->start_ns = traceClock();
+		}
+	}
+
+	~TraceSpan() {
+		if (tracing_enabled) {
+			recordTraceEvent(this->name, this->start_ns, this->argument);
+		}
+	}
+
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+#endif
@@ -0,0 +1,153 @@
+#include "transaction.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
+
+static const TransactionRule& transactionRuleFor(uint16_t request_code) {
+	const TransactionRule* rule = findTransactionRule(request_code);
+	if (rule == nullptr) {
+		throw std::invalid_argument("no transaction rule for request code " + std::to_string(request_code));
+	}
+	return *rule;
+}
+
+/** receiveExpectedResponse
+ * Receives the next response and matches it against the responses a transaction rule expects.
+ *
+ * @param sock A reference to the TCP socket used for communication with the server.
+ * @param reader The connection's response reader.
+ * @param rule The row of the transaction table of the request being answered.
+ * @param uuid The client's uuid, checked against the payload of the responses that carry it.
+ * @param response Set to the view of the response that was received.
+ * @return The entry of the rule the response matched.
+ * @throws std::invalid_argument if the response matches none of the entries, or carries another client's uuid.
+ */
+const ExpectedResponse& receiveExpectedResponse(tcp::socket& sock, ResponseReader& reader, const TransactionRule& rule, const UUID& uuid, ResponseView& response) {
+	TraceSpan span("wait for response", rule.request_code);
+	response = reader.next(sock);
+
+	for (size_t i = 0; i < rule.response_count; i++) {
+		const ExpectedResponse& expected = rule.responses[i];
+		if (response.is(expected.code, expected.payload_size)) {
+			if (expected.carries_client_uuid && !response.isFor(uuid)) {
+				break;
+			}
+			return expected;
+		}
+	}
+	throw std::invalid_argument("server responded with an error");
+}
+
+/** runTransaction
+ * Runs a request through the transaction engine.
+ *
+ * This function performs the following steps:
+ * 1. Looks up the request code's row in the transaction table.
+ * 2. Packs the request once - every attempt writes the same buffer.
+ * 3. Sends the request - corked if the row is in the bulk phase, and uncorked again before waiting for the
+ *    response - and if the server answers this request, receives the response and matches it
+ *    against the row (code, payload size and uuid).
+ * 4. Hands the matched response to the request's handleResponse.
+ * 5. If any step throws, prints the error and tries again, up to the row's max_attempts.
+ *
+ * @param sock A reference to the TCP socket used for communication with the server.
+ * @param reader The connection's response reader.
+ * @param request The request to run.
+ * @return The result of the matched response (SUCCESS or another result code from the table), or FAILURE
+ *         if every attempt failed.
+ */
+int runTransaction(ClientSocket& sock, ResponseReader& reader, Request& request) {
+	TraceSpan span("Request::run", request.getHeader().getCode());
+	const TransactionRule& rule = transactionRuleFor(request.getHeader().getCode());
+	const Bytes& packed_request = request.getPackedRequest();
+	const UUID uuid = request.getHeader().getUUID();
+
+	for (int attempt = 1; attempt <= rule.max_attempts; attempt++) {
+		try {
+			writeInPhase(sock, { boost::asio::buffer(packed_request) }, rule.phase);
+			countRequestsSent(request.packetCount());
+			countPacketsSent(request.packetCount());
+			if (rule.response_count == 0) {
+				return SUCCESS;
+			}
+
+			ResponseView response;
+			PhaseTimer crc_wait_timer(RunPhase::CrcWait, rule.phase == SocketPhase::Bulk);
+			const ExpectedResponse& expected = receiveExpectedResponse(sock, reader, rule, uuid, response);
+			crc_wait_timer.stop();
+			request.handleResponse(response, expected.result);
+			return expected.result;
+		}
+		catch (std::exception& e) {
+			LOG_WARNING(LogFields().withUuid(uuid).withCode(rule.request_code), "attempt %d of %d failed: %s", attempt, rule.max_attempts, e.what());
+			if (attempt < rule.max_attempts) {
+				countRetry(rule.request_code);
+			}
+		}
+	}
+	return FAILURE;
+}
+
+/** runPipeline
+ * Sends independent requests in a single write and then receives their responses in order.
+ *
+ * The server handles requests one after the other on the connection, so requests that don't depend on each
+ * other's responses can be sent together, saving a round trip for each request but the last. The packed
+ * requests are gathered straight into the write, without copying them into one buffer. If any of them carries
+ * the file, the whole write is done in the bulk phase.
+ * Nothing is resent here: a request that failed is reported as FAILURE and the caller decides whether to
+ * run it again on its own.
+ *
+ * @param sock A reference to the TCP socket used for communication with the server.
+ * @param reader The connection's response reader.
+ * @param requests The requests to send, in the order the server should handle them.
+ * @return The result of every request, in the same order.
+ */
+vector<int> runPipeline(ClientSocket& sock, ResponseReader& reader, const vector<Request*>& requests) {
+	TraceSpan span("pipeline", static_cast<int64_t>(requests.size()));
+	vector<int> results(requests.size(), FAILURE);
+	vector<boost::asio::const_buffer> packed_requests;
+	SocketPhase write_phase = SocketPhase::Control;
+
+	try {
+		for (Request* request : requests) {
+			packed_requests.push_back(boost::asio::buffer(request->getPackedRequest()));
+			if (transactionRuleFor(request->getHeader().getCode()).phase == SocketPhase::Bulk) {
+				write_phase = SocketPhase::Bulk;
+			}
+		}
+		writeInPhase(sock, packed_requests, write_phase);
+		for (Request* request : requests) {
+			countRequestsSent(request->packetCount());
+			countPacketsSent(request->packetCount());
+		}
+	}
+	catch (std::exception& e) {
+		LOG_WARNING({}, "sending %zu pipelined requests failed: %s", requests.size(), e.what());
+		return results;
+	}
+
+	// the server answers the file's packets only after the responses to the requests sent before them,
+	// so the wait for the CRC is counted from the end of the write.
+	PhaseTimer crc_wait_timer(RunPhase::CrcWait, write_phase == SocketPhase::Bulk);
+	for (size_t i = 0; i < requests.size(); i++) {
+		try {
+			const TransactionRule& rule = transactionRuleFor(requests[i]->getHeader().getCode());
+			if (rule.response_count == 0) {
+				results[i] = SUCCESS;
+				continue;
+			}
+
+			ResponseView response;
+			const ExpectedResponse& expected = receiveExpectedResponse(sock, reader, rule, requests[i]->getHeader().getUUID(), response);
+			if (rule.phase == SocketPhase::Bulk) {
+				crc_wait_timer.stop();
+			}
+			requests[i]->handleResponse(response, expected.result);
+			results[i] = expected.result;
+		}
+		catch (std::exception& e) {
+			LOG_WARNING(LogFields().withUuid(requests[i]->getHeader().getUUID()).withCode(requests[i]->getHeader().getCode()), "%s", e.what());
+		}
+	}
+	return results;
+}
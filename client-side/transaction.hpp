@@ -0,0 +1,85 @@
+#ifndef TRANSACTION_HPP
+#define TRANSACTION_HPP
+#include "request.hpp"
+#include "socket_policy.hpp"
+
+constexpr size_t MAX_EXPECTED_RESPONSES = 3;
+
+// A response a request can be answered with, and what the transaction returns when it arrives.
+struct ExpectedResponse {
+	uint16_t code;
+	uint32_t payload_size;
+	int result;
+	bool carries_client_uuid; // false when the payload holds a new uuid (or none) instead of the client's
+};
+
+// A row of the transaction table: every response a request code can be answered with, and its retry policy.
+struct TransactionRule {
+	uint16_t request_code;
+	size_t response_count; // 0 means the server doesn't answer the request
+	ExpectedResponse responses[MAX_EXPECTED_RESPONSES];
+	int max_attempts;
+	SocketPhase phase = SocketPhase::Control; // Bulk for the requests that carry the file's packets
+};
+
+// The control-plane exchanges of the protocol. Every request goes through the same engine, which only
+// differs per request by its row here and by the request's handleResponse.
+constexpr TransactionRule TRANSACTION_TABLE[] = {
+	{ Codes::REGISTRATION_CODE, 1, {
+		{ Codes::REGISTRATION_SUCCEEDED_CODE, PayloadSize::REGISTRATION_SUCCEEDED_PAYLOAD_SIZE, SUCCESS, false } }, MAX_REQUEST_FAILS },
+	{ Codes::SENDING_PUBLIC_KEY_CODE, 1, {
+		{ Codes::PUBLIC_KEY_RECEIVED_CODE, PayloadSize::PUBLIC_KEY_RECEIVED_PAYLOAD_SIZE, SUCCESS, true } }, MAX_REQUEST_FAILS },
+	{ Codes::RECONNECTION_CODE, 3, {
+		{ Codes::RECONNECTION_SUCCEEDED_CODE, PayloadSize::RECONNECTION_SUCCEEDED_PAYLOAD_SIZE_WITHOUT_AES_KEY_SIZE, SUCCESS, true },
+		{ Codes::RECONNECTION_X25519_SUCCEEDED_CODE, PayloadSize::RECONNECTION_X25519_SUCCEEDED_PAYLOAD_SIZE, RECONNECTED_WITH_X25519, true },
+		{ Codes::RECONNECTION_FAILED_CODE, PayloadSize::RECONNECTION_FAILED_PAYLOAD_SIZE, REGISTERED_NOT_RECONNECTED, false } }, MAX_REQUEST_FAILS },
+	{ Codes::SENDING_X25519_PUBLIC_KEY_CODE, 1, {
+		{ Codes::X25519_PUBLIC_KEY_RECEIVED_CODE, PayloadSize::X25519_PUBLIC_KEY_RECEIVED_PAYLOAD_SIZE, SUCCESS, true } }, MAX_REQUEST_FAILS },
+	{ Codes::SENDING_FILE_CODE, 1, {
+		{ Codes::FILE_RECEIVED_CRC_CODE, PayloadSize::FILE_RECEIVED_CRC_PAYLOAD_SIZE, SUCCESS, true } }, MAX_REQUEST_FAILS, SocketPhase::Bulk },
+	{ Codes::VALID_CRC_CODE, 1, {
+		{ Codes::MESSAGE_RECEIVED_CODE, PayloadSize::MESSAGE_RECEIVED_PAYLOAD_SIZE, SUCCESS, true } }, MAX_REQUEST_FAILS },
+	{ Codes::SENDING_CRC_AGAIN_CODE, 0, {}, 1 },
+	{ Codes::INVALID_CRC_DONE_CODE, 1, {
+		{ Codes::MESSAGE_RECEIVED_CODE, PayloadSize::MESSAGE_RECEIVED_PAYLOAD_SIZE, SUCCESS, true } }, MAX_REQUEST_FAILS },
+	{ Codes::RESUMPTION_CODE, 2, {
+		{ Codes::RESUMPTION_SUCCEEDED_CODE, PayloadSize::RESUMPTION_SUCCEEDED_PAYLOAD_SIZE, SUCCESS, true },
+		{ Codes::RESUMPTION_FAILED_CODE, PayloadSize::RESUMPTION_FAILED_PAYLOAD_SIZE, RESUMPTION_REJECTED, false } }, MAX_REQUEST_FAILS },
+	{ Codes::RESUMPTION_TICKET_REQUEST_CODE, 1, {
+		{ Codes::RESUMPTION_TICKET_CODE, PayloadSize::RESUMPTION_TICKET_PAYLOAD_SIZE, SUCCESS, true } }, MAX_REQUEST_FAILS },
+	// Never resent - the file sent along with the ticket would reach the server twice.
+	{ Codes::EARLY_DATA_RESUMPTION_CODE, 2, {
+		{ Codes::RESUMPTION_SUCCEEDED_CODE, PayloadSize::RESUMPTION_SUCCEEDED_PAYLOAD_SIZE, SUCCESS, true },
+		{ Codes::RESUMPTION_FAILED_CODE, PayloadSize::RESUMPTION_FAILED_PAYLOAD_SIZE, RESUMPTION_REJECTED, false } }, 1, SocketPhase::Bulk },
+};
+
+// The second response of an early data resumption: the server's answer to the file sent with the ticket.
+constexpr TransactionRule EARLY_DATA_ANSWER_RULE = { Codes::EARLY_DATA_RESUMPTION_CODE, 2, {
+	{ Codes::MESSAGE_RECEIVED_CODE, PayloadSize::MESSAGE_RECEIVED_PAYLOAD_SIZE, SUCCESS, true },
+	{ Codes::FILE_RECEIVED_CRC_CODE, PayloadSize::FILE_RECEIVED_CRC_PAYLOAD_SIZE, EARLY_DATA_NOT_CONFIRMED, true } }, 1 };
+
+constexpr const TransactionRule* findTransactionRule(uint16_t request_code) {
+	for (const TransactionRule& rule : TRANSACTION_TABLE) {
+		if (rule.request_code == request_code) {
+			return &rule;
+		}
+	}
+	return nullptr;
+}
+
+constexpr bool hasTransactionRule(uint16_t request_code) {
+	return findTransactionRule(request_code) != nullptr;
+}
+
+static_assert(hasTransactionRule(Codes::REGISTRATION_CODE) && hasTransactionRule(Codes::SENDING_PUBLIC_KEY_CODE)
+	&& hasTransactionRule(Codes::RECONNECTION_CODE) && hasTransactionRule(Codes::SENDING_X25519_PUBLIC_KEY_CODE)
+	&& hasTransactionRule(Codes::SENDING_FILE_CODE) && hasTransactionRule(Codes::VALID_CRC_CODE)
+	&& hasTransactionRule(Codes::SENDING_CRC_AGAIN_CODE) && hasTransactionRule(Codes::INVALID_CRC_DONE_CODE)
+	&& hasTransactionRule(Codes::RESUMPTION_CODE) && hasTransactionRule(Codes::RESUMPTION_TICKET_REQUEST_CODE)
+	&& hasTransactionRule(Codes::EARLY_DATA_RESUMPTION_CODE), "every request code needs a row in the transaction table");
+
+const ExpectedResponse& receiveExpectedResponse(tcp::socket& sock, ResponseReader& reader, const TransactionRule& rule, const UUID& uuid, ResponseView& response);
+int runTransaction(ClientSocket& sock, ResponseReader& reader, Request& request);
+vector<int> runPipeline(ClientSocket& sock, ResponseReader& reader, const vector<Request*>& requests);
+
+#endif
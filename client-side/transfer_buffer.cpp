@@ -0,0 +1,111 @@
+#include "transfer_buffer.hpp"
+#include "alloc_tracking.hpp"
+
+#include <atomic>
+
+#ifdef __linux__
+#include <sys/mman.h>
+
+static size_t roundUpToHugePage(size_t size) {
+	return (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+// Explicit huge pages only exist if the admin reserved some (vm.nr_hugepages), stop asking after the first refusal.
+static std::atomic<bool> explicit_huge_pages_unavailable{ false };
+
+/** prefault
+ * Faults in every page of a fresh mapping in one go.
+ *
+ * MADV_POPULATE_WRITE (Linux 5.14) faults the whole range inside the kernel. On older kernels every page is
+ * touched instead - with transparent huge pages each touch still faults a whole 2 MiB page.
+ *
+ * @param buffer The start of the mapping.
+ * @param size The size of the mapping.
+ */
+static void prefault(void* buffer, size_t size) {
+#ifdef MADV_POPULATE_WRITE
+	if (madvise(buffer, size, MADV_POPULATE_WRITE) == 0) {
+		return;
+	}
+#endif
+	volatile char* pages = static_cast<char*>(buffer);
+	for (size_t offset = 0; offset < size; offset += 4096) {
+		pages[offset] = 0;
+	}
+}
+
+/** mapHugeBuffer
+ * Maps a buffer of whole huge pages, starting on a huge page boundary.
+ *
+ * This function performs the following steps:
+ * 1. Tries explicit huge pages (MAP_HUGETLB), populated by the mmap itself.
+ * 2. Otherwise maps one huge page more than needed and unmaps the ends, so the buffer is aligned to
+ *    HUGE_PAGE_SIZE - transparent huge pages can only back aligned 2 MiB ranges.
+ * 3. Asks for transparent huge pages (MADV_HUGEPAGE) and pre-faults the buffer.
+ *
+ * @param mapped_size The size to map, a multiple of HUGE_PAGE_SIZE.
+ * @return The buffer, or nullptr if the mapping failed.
+ */
+static void* mapHugeBuffer(size_t mapped_size) {
+	if (!explicit_huge_pages_unavailable.load(std::memory_order_relaxed)) {
+		void* buffer = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+		if (buffer != MAP_FAILED) {
+			return buffer;
+		}
+		explicit_huge_pages_unavailable.store(true, std::memory_order_relaxed);
+	}
+
+	void* mapping = mmap(nullptr, mapped_size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mapping == MAP_FAILED) {
+		return nullptr;
+	}
+
+	uintptr_t start = reinterpret_cast<uintptr_t>(mapping);
+	uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+	if (aligned > start) {
+		munmap(mapping, aligned - start);
+	}
+	size_t tail = start + mapped_size + HUGE_PAGE_SIZE - (aligned + mapped_size);
+	if (tail > 0) {
+		munmap(reinterpret_cast<void*>(aligned + mapped_size), tail);
+	}
+
+	void* buffer = reinterpret_cast<void*>(aligned);
+	madvise(buffer, mapped_size, MADV_HUGEPAGE);
+	prefault(buffer, mapped_size);
+	return buffer;
+}
+#endif
+
+/** allocateTransferBuffer
+ * Allocates a 64-byte aligned buffer, backed by huge pages if it's large enough.
+ *
+ * @param size The size of the buffer in bytes.
+ * @return The buffer, to be freed with freeTransferBuffer and the same size.
+ * @throws std::bad_alloc if there is no memory for the buffer.
+ */
+void* allocateTransferBuffer(size_t size) {
+#ifdef __linux__
+	if (size >= HUGE_PAGE_THRESHOLD) {
+		void* buffer = mapHugeBuffer(roundUpToHugePage(size));
+		if (buffer == nullptr) {
+			throw std::bad_alloc();
+		}
+#ifdef TRACK_ALLOCATIONS
+		recordAllocation(size);
+#endif
+		return buffer;
+	}
+#endif
+	return ::operator new(size, std::align_val_t(TRANSFER_BUFFER_ALIGNMENT));
+}
+
+void freeTransferBuffer(void* buffer, size_t size) {
+#ifdef __linux__
+	if (size >= HUGE_PAGE_THRESHOLD) {
+		munmap(buffer, roundUpToHugePage(size));
+		return;
+	}
+#endif
+	::operator delete(buffer, std::align_val_t(TRANSFER_BUFFER_ALIGNMENT));
+}
@@ -0,0 +1,63 @@
+#ifndef TRANSFER_BUFFER_HPP
+#define TRANSFER_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+constexpr size_t TRANSFER_BUFFER_ALIGNMENT = 64;     // a cache line, and the widest SIMD load
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+constexpr size_t HUGE_PAGE_THRESHOLD = HUGE_PAGE_SIZE; // smaller buffers come from the heap
+
+void* allocateTransferBuffer(size_t size);
+void freeTransferBuffer(void* buffer, size_t size);
+
+// Allocator for the buffers the file goes through (its content, its ciphertext and the packed packets).
+// Every buffer is 64-byte aligned. Buffers of a huge page or more are mapped on their own, backed by huge
+// pages where the OS gives them, and pre-faulted - so a large file costs a few hundred page faults instead of
+// one per 4 KiB page, and the TLB covers it with a few entries.
+template <class T>
+struct TransferAllocator {
+	using value_type = T;
+
+	TransferAllocator() noexcept = default;
+	template <class U>
+	TransferAllocator(const TransferAllocator<U>&) noexcept {}
+
+	T* allocate(size_t count) {
+		if (count > SIZE_MAX / sizeof(T)) {
+			throw std::bad_array_new_length();
+		}
+		return static_cast<T*>(allocateTransferBuffer(count * sizeof(T)));
+	}
+
+	void deallocate(T* buffer, size_t count) noexcept {
+		freeTransferBuffer(buffer, count * sizeof(T));
+	}
+
+	// Sized buffers (Bytes(n), resize) are left uninitialized: the packets are packed over every byte right
+	// after the buffer is sized, and zeroing it first would be one more pass over the file. A buffer that
+	// isn't written over completely before it's read must be sized with a value, e.g. Bytes(n, 0).
+	template <class U>
+	void construct(U* element) noexcept(std::is_nothrow_default_constructible<U>::value) {
+		::new (static_cast<void*>(element)) U;
+	}
+
+	template <class U, class... Args>
+	void construct(U* element, Args&&... args) {
+		::new (static_cast<void*>(element)) U(std::forward<Args>(args)...);
+	}
+};
+
+template <class T, class U>
+bool operator==(const TransferAllocator<T>&, const TransferAllocator<U>&) noexcept { return true; }
+template <class T, class U>
+bool operator!=(const TransferAllocator<T>&, const TransferAllocator<U>&) noexcept { return false; }
+
+using TransferString = std::basic_string<char, std::char_traits<char>, TransferAllocator<char>>;
+
+#endif
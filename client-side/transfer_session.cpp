@@ -0,0 +1,1020 @@
+#include "transfer_session.hpp"
+#include "request.hpp"
+#include "requests.hpp"
+#include "requests_payloads.hpp"
+#include "Base64Wrapper.hpp"
+#include "RSAWrapper.hpp"
+#include "X25519Wrapper.hpp"
+#include "cksum.hpp"
+#include "session_ticket.hpp"
+#include "key_cache.hpp"
+#include "transaction.hpp"
+#include "socket_policy.hpp"
+#include "uring_io.hpp"
+#include "trace.hpp"
+#include "metrics.hpp"
+
+#include <memory>
+
+/** transferValidation
+ *  Validates the parameters required for a file transfer.
+ *
+ * @param client A reference to a Client object that will be set up for the transfer.
+ * @param ip_port A string representing the IP address and port in the format "ip:port".
+ * @param name The username of the client initiating the transfer, must not be empty and within a defined length.
+ * @param file_path The path to the file being transferred, must not be empty.
+ * @param key_exchange The key exchange to use, "rsa", "x25519" or empty (defaults to RSA).
+ * @return A boolean indicating whether the validation succeeded (true) or failed (false).
+ *
+ * The function performs the following checks:
+ * 1. It ensures the ip_port string contains a colon (':') to separate the IP address and port.
+ * 2. It checks that the username length is valid (greater than 0 and less than or equal to MAX_USERNAME_LENGTH).
+ * 3. It verifies that the file_path is not empty.
+ * 4. It extracts the IP address and port from the ip_port string and validates that the port is a valid integer.
+ * 5. It checks that the key exchange is one the client supports.
+ * 6. If all validations pass, it calls the setupClient method on the Client object to configure it for the transfer.
+ */
+static bool transferValidation(Client& client, string ip_port, string name, string file_path, string key_exchange) {
+	size_t colon_postion = ip_port.find(':');
+
+	if (colon_postion == string::npos || name.length() > MAX_USERNAME_LENGTH || name.length() == 0 || file_path.length() == 0) {
+		return false;
+	}
+
+	string ip = ip_port.substr(0, colon_postion);
+	string port = ip_port.substr(colon_postion + 1);
+
+	bool is_port_valid = is_integer(port);
+	if (!is_port_valid) {
+		return false;
+	}
+
+	if (key_exchange == "x25519") {
+		client.setKeyExchange(KeyExchange::X25519);
+	}
+	else if (key_exchange != "rsa" && key_exchange != "") {
+		return false;
+	}
+
+	client.setupClient(ip, port, name, file_path);
+
+	return true;
+}
+
+/** createClient
+ * Creates and initializes a Client object using configuration data from a file.
+ *
+ * @return A Client object that has been set up with values read from the 'transfer.info' file.
+ *
+ * This function performs the following steps:
+ * 1. It constructs the path to the 'transfer.info' file.
+ * 2. It opens the file and reads its contents line by line, expecting three specific pieces of information:
+ *    - The first line contains the IP address and port.
+ *    - The second line contains the client name.
+ *    - The third line contains the file path for the transfer.
+ *    - An optional fourth line chooses the key exchange - "rsa" (the default) or "x25519".
+ * 3. It checks that three or four lines are read from the file. If not, it throws an exception.
+ * 4. It validates the extracted parameters using the transferValidation function.
+ * 5. If all validations pass, it returns the configured Client object.
+ * 6. If any errors occur during the file reading or validation, appropriate exceptions are thrown.
+ */
+
+Client createClient() {
+	string transfer_path = EXE_DIR_FILE_PATH("transfer.info");
+	string line, ip_port, client_name, client_file_path, key_exchange;
+	ifstream transfer_info_file(transfer_path);
+
+	int lines = 1;
+	Client client;
+
+	if (!transfer_info_file.is_open()) {
+		throw std::runtime_error("Error opening 'transfer.info' - exiting");
+	}
+
+	while (getline(transfer_info_file, line)) {
+		switch (lines) {
+		case 1:
+			ip_port = line;
+			break;
+		case 2:
+			client_name = line;
+			break;
+		case 3:
+			client_file_path = line;
+			break;
+		case 4:
+			key_exchange = line;
+			break;
+		default:
+			break;
+		}
+		lines++;
+	}
+
+	if (lines != 4 && lines != 5) {
+		throw std::invalid_argument("Error: transfer.info contains too many lines / not enough lines");
+	}
+
+	if (!transferValidation(client, ip_port, client_name, client_file_path, key_exchange)) {
+		throw std::invalid_argument("Error: transfer.info contains invalid data");
+	}
+
+	transfer_info_file.close();
+	return client;
+
+}
+
+/** use_me_info_file
+ * Reads configuration data from the 'me.info' file and updates the provided Client object.
+ *
+ * @param client A reference to a Client object that will be updated with the read data.
+ * @return A string representing the private key extracted from the 'me.info' file.
+ *
+ * This function performs the following steps:
+ * 1. Constructs the path to the 'me.info' file.
+ * 2. Opens the file and reads its contents line by line, expecting specific information:
+ *    - The first line contains the client name.
+ *    - The second line contains the client ID (expected to be in a specific hexadecimal format).
+ *    - The third line contains the private key, which may be spread across multiple lines.
+ * 3. It checks that the read values meet specific criteria:
+ *    - The client name must not be empty and must not exceed a predefined maximum length.
+ *    - The client ID must have a fixed length defined by HEX_ID_LENGTH.
+ *    - The private key must not be empty.
+ * 4. If any validations fail, an exception is thrown.
+ * 5. The client object is updated with the name and UUID derived from the client ID.
+ * 6. Finally, the function closes the file and returns the private key.
+ */
+
+static string use_me_info_file(Client& client) {
+	string me_info_path = EXE_DIR_FILE_PATH("me.info");
+	string line, client_name, client_id, private_key;
+	int lines = 1;
+	ifstream info_file(me_info_path);
+
+	if (!info_file.is_open()) {
+		throw std::runtime_error("Error opening 'me.info' - exiting");
+	}
+
+	while (getline(info_file, line)) {
+		switch (lines) {
+		case 1:
+			client_name = line;
+			break;
+		case 2:
+			client_id = line;
+			break;
+		case 3:
+			private_key = line;
+			break;
+		default:
+			private_key += line;
+			break;
+		}
+		lines++;
+	}
+
+	if (client_name.length() > MAX_USERNAME_LENGTH || client_name.length() == 0 || client_id.length() != HEX_ID_LENGTH || private_key.length() == 0) {
+		throw std::invalid_argument("Error: me.info contains invalid data.");
+	}
+
+	UUID id = getUUIDFromString(client_id);
+	client.setName(client_name);
+	client.setUUID(id);
+
+	info_file.close();
+	return private_key;
+}
+
+/** save_me_info
+ * Saves the client information to the 'me.info' file.
+ *
+ * @param name The name of the client to be saved.
+ * @param uuid The UUID of the client, which will be converted to a string for storage.
+ * @param private_key The private key of the client, which will be encoded in Base64 before saving.
+ *
+ * This function performs the following steps:
+ * 1. Converts the UUID to a string format and removes any dashes ('-').
+ * 2. Encodes the private key in Base64 to ensure safe storage.
+ * 3. Constructs the path to the 'me.info' file where the information will be saved.
+ * 4. Opens the file for writing. If the file cannot be opened, an exception is thrown.
+ * 5. Writes the client name, UUID (without dashes), and Base64-encoded private key to the file, each on a new line.
+ * 6. Closes the file after writing to ensure all data is properly saved.
+ */
+
+static void save_me_info(string name, UUID uuid, string private_key) {
+	string my_uuid = uuids::to_string(uuid);
+	my_uuid.erase(remove(my_uuid.begin(), my_uuid.end(), '-'), my_uuid.end()); // Remove '-' from the string
+	string base64_private_key = Base64Wrapper::encode(private_key);
+
+	string path_info = EXE_DIR_FILE_PATH("me.info");
+
+	ofstream info_file(path_info);
+
+	if (!info_file.is_open()) {
+		throw std::runtime_error("Error opening the 'me.info' - exiting");
+	}
+
+	// Writing to info file
+	info_file << name << "\n" << my_uuid << "\n" << base64_private_key << "\n";
+
+	info_file.close();
+}
+/** save_priv_key_file
+ * Saves the private key to a file after encoding it in Base64.
+ *
+ * @param private_key The private key to be saved, which will be encoded before storage.
+ *
+ * This function performs the following steps:
+ * 1. Encodes the provided private key in Base64 format for secure storage.
+ * 2. Constructs the path to the 'priv.key' file where the encoded private key will be saved.
+ * 3. Opens the file for writing. If the file cannot be opened, an exception is thrown.
+ * 4. Writes the Base64-encoded private key to the file, followed by a newline.
+ * 5. Closes the file after writing to ensure all data is properly saved.
+ */
+
+static void save_priv_key_file(string private_key) {
+	// Encode the private key to base64 and open files
+	string base64_private_key = Base64Wrapper::encode(private_key);
+	string path_key = EXE_DIR_FILE_PATH("priv.key");
+
+	ofstream private_key_file(path_key);
+
+	if (!private_key_file.is_open()) {
+		throw std::runtime_error("Error opening the 'priv.key' file, aborting program.");
+	}
+	// Writing to priv.key file
+	private_key_file << base64_private_key << "\n";
+	private_key_file.close();
+}
+
+/** cache_rsa_key
+ * Saves the RSA private key to the binary 'priv.cache' file so reconnections can skip the Base64 and ASN.1 parsing.
+ *
+ * @param uuid The UUID of the client the key belongs to.
+ * @param key_base64 The private key as saved in 'me.info', the cache is only used along with it.
+ * @param rsa_wrapper The client's RSA private key.
+ *
+ * Failing to write the cache isn't fatal - the key is still loaded from 'me.info' on the next run.
+ */
+
+static void cache_rsa_key(const UUID& uuid, const string& key_base64, const RSAPrivateWrapper& rsa_wrapper) {
+	try {
+		saveRSAKeyCache(EXE_DIR_FILE_PATH("priv.cache"), uuid, key_base64, rsa_wrapper);
+	}
+	catch (std::exception& e) {
+		LOG_WARNING({}, "%s", e.what());
+	}
+}
+
+/** use_session_ticket_file
+ * Reads the resumption ticket saved by a previous run from the 'session.ticket' file.
+ *
+ * @return A SessionTicket holding the resumption secret and the server's ticket.
+ *
+ * The file holds the RESUMPTION_SECRET_LENGTH bytes of the resumption secret followed by the
+ * TICKET_LENGTH bytes of the ticket. If the file can't be read or is not exactly that long,
+ * an exception is thrown.
+ */
+
+static SessionTicket use_session_ticket_file() {
+	string ticket_path = EXE_DIR_FILE_PATH("session.ticket");
+	ifstream ticket_file(ticket_path, std::ios::binary);
+
+	if (!ticket_file.is_open()) {
+		throw std::runtime_error("Error opening 'session.ticket'");
+	}
+
+	SessionTicket session_ticket;
+	session_ticket.resumption_secret.resize(RESUMPTION_SECRET_LENGTH);
+	session_ticket.ticket.resize(TICKET_LENGTH);
+	ticket_file.read(&session_ticket.resumption_secret[0], RESUMPTION_SECRET_LENGTH);
+	ticket_file.read(&session_ticket.ticket[0], TICKET_LENGTH);
+
+	if (!ticket_file || ticket_file.peek() != EOF) {
+		throw std::invalid_argument("Error: session.ticket contains invalid data.");
+	}
+
+	ticket_file.close();
+	return session_ticket;
+}
+
+/** save_session_ticket
+ * Saves a resumption ticket and its secret to the 'session.ticket' file for the next reconnection.
+ *
+ * @param session_ticket The resumption secret and the ticket the server issued.
+ */
+
+static void save_session_ticket(const SessionTicket& session_ticket) {
+	string ticket_path = EXE_DIR_FILE_PATH("session.ticket");
+	ofstream ticket_file(ticket_path, std::ios::binary | std::ios::trunc);
+
+	if (!ticket_file.is_open()) {
+		throw std::runtime_error("Error opening the 'session.ticket' file");
+	}
+
+	ticket_file.write(session_ticket.resumption_secret.c_str(), session_ticket.resumption_secret.size());
+	ticket_file.write(session_ticket.ticket.c_str(), session_ticket.ticket.size());
+	ticket_file.close();
+}
+
+/** resume_session
+ * Tries to reconnect with the saved resumption ticket instead of the RSA exchange.
+ *
+ * @param sock A reference to a TCP socket for communication with the server.
+ * @param reader The connection's response reader, shared by every request on the socket.
+ * @param client A reference to a Client object containing the client's information.
+ * @param aes_key Set to the AES key of the resumed session if the resumption succeeded.
+ * @return true if the session was resumed, false if the caller should fall back to the RSA reconnection.
+ *
+ * This function performs the following steps:
+ * 1. Reads the ticket from 'session.ticket' and generates a fresh client nonce.
+ * 2. Sends a resumption request with the username, the nonce and the ticket.
+ * 3. If the server accepted the ticket, derives the new AES key from the resumption secret and both
+ *    nonces (no RSA involved) and saves the new ticket the server issued for the next run.
+ * 4. If the ticket is unreadable or the server rejected it, deletes 'session.ticket' and returns false.
+ */
+
+static bool resume_session(ClientSocket& sock, ResponseReader& reader, Client& client, string& aes_key) {
+	try {
+		SessionTicket session_ticket = use_session_ticket_file();
+		string client_nonce = generateSessionNonce();
+
+		RequestHeader resume_request_header(client.getUuid(), Codes::RESUMPTION_CODE, PayloadSize::RESUMPTION_PAYLOAD_SIZE);
+		ResumptionPayload resume_request_payload(client.getName(), client_nonce, session_ticket.ticket);
+		ResumeRequest resume_request(resume_request_header, resume_request_payload);
+
+		if (resume_request.run(sock, reader) == SUCCESS) {
+			aes_key = deriveResumedAESKey(session_ticket.resumption_secret, client_nonce, resume_request.getPayload()->getServerNonce());
+			save_session_ticket({ deriveResumptionSecret(aes_key), resume_request.getPayload()->getNewTicket() });
+			return true;
+		}
+	}
+	catch (std::exception& e) {
+		LOG_WARNING({}, "%s", e.what());
+	}
+
+	// the ticket can't be used anymore, reconnections will use RSA until a new ticket is issued.
+	std::filesystem::remove(EXE_DIR_FILE_PATH("session.ticket"));
+	return false;
+}
+
+/** create_session_ticket_request
+ * Creates the request asking the server for a resumption ticket after a full key exchange.
+ *
+ * The request doesn't depend on anything the server answers before the file, so it isn't run on its own -
+ * it goes out in the same write as the first sending file request (see runPipeline).
+ *
+ * @param client A reference to a Client object containing the client's information.
+ * @return The ticket request.
+ */
+
+static std::unique_ptr<ResumptionTicketRequest> create_session_ticket_request(Client& client) {
+	RequestHeader ticket_request_header(client.getUuid(), Codes::RESUMPTION_TICKET_REQUEST_CODE, PayloadSize::RESUMPTION_TICKET_REQUEST_PAYLOAD_SIZE);
+	ResumptionTicketRequestPayload ticket_request_payload(client.getName());
+	return std::make_unique<ResumptionTicketRequest>(ticket_request_header, ticket_request_payload);
+}
+
+/** save_issued_session_ticket
+ * Saves the ticket the server issued to 'session.ticket'.
+ *
+ * @param result The result of the ticket request.
+ * @param ticket_request The ticket request, holding the ticket if it succeeded.
+ * @param aes_key The AES key of the session, the resumption secret is derived from it.
+ *
+ * Failing to get a ticket isn't fatal - the next reconnection will simply use RSA again.
+ */
+
+static void save_issued_session_ticket(int result, const ResumptionTicketRequest& ticket_request, const string& aes_key) {
+	if (result != SUCCESS) {
+		LOG_WARNING(LogFields().withCode(Codes::RESUMPTION_TICKET_REQUEST_CODE), "couldn't get a resumption ticket from the server.");
+		return;
+	}
+	save_session_ticket({ deriveResumptionSecret(aes_key), ticket_request.getPayload()->getTicket() });
+}
+
+/** create_invalid_crc_request
+ * Creates a sending crc again request (901) for the client's file.
+ * The server doesn't answer it, so it is sent in the same write as the request that follows it.
+ *
+ * @param client A reference to a Client object containing the client's information.
+ * @return The sending crc again request.
+ */
+
+static std::unique_ptr<InvalidCrcRequest> create_invalid_crc_request(Client& client) {
+	countCrcMismatch();
+	RequestHeader invalid_crc_request_header(client.getUuid(), Codes::SENDING_CRC_AGAIN_CODE, PayloadSize::INVALID_CRC_PAYLOAD_SIZE);
+	InvalidCrcPayload invalid_crc_request_payload(client.getFilePath());
+	return std::make_unique<InvalidCrcRequest>(invalid_crc_request_header, invalid_crc_request_payload);
+}
+
+/** handshakeHidesCksum
+ * Tells whether the file's cksum can be computed while the handshake runs, without delaying the upload.
+ *
+ * @return false if the client holds a resumption ticket: resuming takes a single round trip and no RSA, so
+ *         a separate CRC pass would end after it, and the cksum is better computed along with the encryption.
+ */
+bool handshakeHidesCksum() {
+	return !std::filesystem::exists(EXE_DIR_FILE_PATH("session.ticket"));
+}
+
+/** prepareFile
+ * Reads the file to send and computes its cksum.
+ *
+ * @param file_path The path of the file to send, used as given.
+ * @param use_io_uring Whether to read the file with io_uring (falls back to fileToString if it's unavailable).
+ * @param compute_cksum Whether to compute the cksum now (see handshakeHidesCksum), or leave it to the encryption.
+ * @return A PreparedFile holding the file's content and its cksum.
+ *
+ * This function does not depend on the server, so its callers run it on a background thread (std::async, or
+ * the session's thread pool) while the connection, registration/reconnection and key exchange are in progress.
+ */
+PreparedFile prepareFile(const string& file_path, bool use_io_uring, bool compute_cksum) {
+	PreparedFile prepared_file;
+	prepared_file.cksum = 0;
+	prepared_file.has_cksum = compute_cksum;
+	{
+		TraceSpan span("read file");
+		PhaseTimer file_read_timer(RunPhase::FileRead);
+		if (!use_io_uring || !uringFileToString(file_path, prepared_file.content)) {
+			prepared_file.content = fileToString(file_path);
+		}
+	}
+
+	if (compute_cksum) {
+		PhaseTimer local_crc_timer(RunPhase::LocalCrc);
+		prepared_file.cksum = memcrc(prepared_file.content.c_str(), prepared_file.content.length());
+	}
+	return prepared_file;
+}
+
+/** preparedFileSize
+ * Gets the size of the file prepareFile reads, without reading it: it decides whether the file is sent as
+ * early data before the file is prepared.
+ *
+ * @param file_path The path of the file to send, used as given.
+ * @return The file's size, or UNKNOWN_FILE_SIZE if it can't be read (prepareFile reports the error).
+ */
+uintmax_t preparedFileSize(const string& file_path) {
+	std::error_code error;
+	uintmax_t file_size = std::filesystem::file_size(file_path, error);
+	return error ? UNKNOWN_FILE_SIZE : file_size;
+}
+
+/** encrypt_prepared_file
+ * Encrypts the prepared file, and computes its cksum in the same pass if it wasn't computed while preparing it.
+ *
+ * @param aes_wrapper The AES key to encrypt the file with.
+ * @param file The file's content, and its cksum if it has one.
+ * @param cksum Set to the file's cksum.
+ * @return The encrypted file.
+ */
+
+static TransferString encrypt_prepared_file(AESWrapper& aes_wrapper, const PreparedFile& file, unsigned long& cksum) {
+	PhaseTimer encryption_timer(RunPhase::Encryption);
+	if (file.has_cksum) {
+		cksum = file.cksum;
+		return aes_wrapper.encryptFile(file.content.c_str(), static_cast<unsigned int>(file.content.length()));
+	}
+	return aes_wrapper.encryptAndChecksum(file.content.c_str(), static_cast<unsigned int>(file.content.length()), cksum);
+}
+
+/** generateRSAKeyPair
+ * Generates a new RSA key pair for the client.
+ *
+ * @return A pointer to an RSAPrivateWrapper holding the freshly generated key pair.
+ *
+ * Key generation is the slowest step of the registration, and RSAPrivateWrapper can't be copied,
+ * so it is returned through a unique_ptr to let run_client generate it on a background thread.
+ */
+static std::unique_ptr<RSAPrivateWrapper> generateRSAKeyPair() {
+	PhaseTimer key_generation_timer(RunPhase::RSAKeyGeneration);
+	return std::make_unique<RSAPrivateWrapper>();
+}
+
+/** exchange_rsa_key
+ * Sends the client's RSA public key to the server and decrypts the AES key it responds with.
+ *
+ * @param sock A reference to a TCP socket for communication with the server.
+ * @param reader The connection's response reader, shared by every request on the socket.
+ * @param client A reference to a Client object containing the client's information.
+ * @param rsa_wrapper The client's new RSA key pair.
+ * @param aes_key Set to the decrypted AES key if the exchange succeeded.
+ * @return SUCCESS if the AES key was received, FAILURE otherwise.
+ *
+ * This function performs the following steps:
+ * 1. Saves the private key into the 'me.info' and 'priv.key' files, and the binary key cache, for future reconnections.
+ * 2. Sends a sending public key request with the public key.
+ * 3. Decrypts the encrypted AES key from the server's response with the private key.
+ */
+
+static int exchange_rsa_key(ClientSocket& sock, ResponseReader& reader, Client& client, RSAPrivateWrapper& rsa_wrapper, string& aes_key) {
+	string public_key = rsa_wrapper.getPublicKey();
+	string private_key = rsa_wrapper.getPrivateKey();
+
+	// saving files as required for future 
+	save_me_info(client.getName(), client.getUuid(), private_key);
+	save_priv_key_file(private_key);
+	cache_rsa_key(client.getUuid(), Base64Wrapper::encode(private_key), rsa_wrapper);
+
+	RequestHeader send_public_key_request_header(client.getUuid(), Codes::SENDING_PUBLIC_KEY_CODE, PayloadSize::SENDING_PUBLIC_KEY_PAYLOAD_SIZE);
+	string username = client.getName();
+	SendPublicKeyPayload send_public_key_request_payload(username, public_key);
+
+	SendPublicKeyRequest send_public_key_request(send_public_key_request_header, send_public_key_request_payload);
+
+	if (send_public_key_request.run(sock, reader) == FAILURE) {
+		return FAILURE;
+	}
+
+	// Get the encrypted aes key and decrypt it.
+	string encrypted_aes_key = send_public_key_request.getEncryptedAESKey();
+	aes_key = rsa_wrapper.decrypt(encrypted_aes_key);
+	return SUCCESS;
+}
+
+/** exchange_x25519_key
+ * Agrees on the AES key with the server using X25519 instead of RSA.
+ *
+ * @param sock A reference to a TCP socket for communication with the server.
+ * @param reader The connection's response reader, shared by every request on the socket.
+ * @param client A reference to a Client object containing the client's information.
+ * @param aes_key Set to the agreed AES key if the exchange succeeded.
+ * @return SUCCESS if the AES key was agreed, FAILURE otherwise.
+ *
+ * This function performs the following steps:
+ * 1. Generates an X25519 key pair and saves the private key into the 'me.info' and 'priv.key' files,
+ *    the same way the RSA private key is saved, so reconnections can use it.
+ * 2. Sends the public key to the server, which responds with the public key of its ephemeral key pair.
+ * 3. Derives the AES key from the shared secret and both public keys - no key is sent over the wire.
+ */
+
+static int exchange_x25519_key(ClientSocket& sock, ResponseReader& reader, Client& client, string& aes_key) {
+	X25519Wrapper x25519_wrapper;
+	string public_key = x25519_wrapper.getPublicKey();
+	string private_key = x25519_wrapper.getPrivateKey();
+
+	// saving files as required for future 
+	save_me_info(client.getName(), client.getUuid(), private_key);
+	save_priv_key_file(private_key);
+
+	RequestHeader send_public_key_request_header(client.getUuid(), Codes::SENDING_X25519_PUBLIC_KEY_CODE, PayloadSize::SENDING_X25519_PUBLIC_KEY_PAYLOAD_SIZE);
+	SendX25519PublicKeyPayload send_public_key_request_payload(client.getName(), public_key);
+
+	SendX25519PublicKeyRequest send_public_key_request(send_public_key_request_header, send_public_key_request_payload);
+
+	if (send_public_key_request.run(sock, reader) == FAILURE) {
+		return FAILURE;
+	}
+
+	string server_public_key = send_public_key_request.getPayload()->getServerPublicKey();
+	aes_key = x25519_wrapper.agreeAESKey(server_public_key);
+	return SUCCESS;
+}
+
+/** exchange_key
+ * Runs the key exchange the client was configured with after a registration.
+ *
+ * @param sock A reference to a TCP socket for communication with the server.
+ * @param reader The connection's response reader, shared by every request on the socket.
+ * @param client A reference to a Client object containing the client's information.
+ * @param aes_key Set to the AES key if the exchange succeeded.
+ * @param rsa_key_generation An RSA key pair being generated in the background, or an invalid future to generate one now.
+ * @return SUCCESS if the AES key was exchanged, FAILURE otherwise.
+ */
+
+static int exchange_key(ClientSocket& sock, ResponseReader& reader, Client& client, string& aes_key, std::future<std::unique_ptr<RSAPrivateWrapper>>& rsa_key_generation) {
+	if (client.getKeyExchange() == KeyExchange::X25519) {
+		return exchange_x25519_key(sock, reader, client, aes_key);
+	}
+
+	std::unique_ptr<RSAPrivateWrapper> rsa_wrapper = rsa_key_generation.valid() ? rsa_key_generation.get() : generateRSAKeyPair();
+	return exchange_rsa_key(sock, reader, client, *rsa_wrapper, aes_key);
+}
+
+/** resume_session_with_early_data
+ * Tries to reconnect with the saved resumption ticket and sends a small file in the same write (0-RTT).
+ *
+ * @param sock A reference to a TCP socket for communication with the server.
+ * @param reader The connection's response reader, shared by every request on the socket.
+ * @param client A reference to a Client object containing the client's information.
+ * @param aes_key Set to the AES key of the resumed session if the resumption succeeded.
+ * @param file The file's content and cksum.
+ * @return SUCCESS if the server saved the file, EARLY_DATA_NOT_CONFIRMED if the session was resumed but the
+ *         server's CRC didn't match, RESUMPTION_REJECTED or EARLY_DATA_NOT_RECEIVED if the caller should fall back
+ *         to the RSA reconnection, or FAILURE.
+ *
+ * This function performs the following steps:
+ * 1. Reads the ticket from 'session.ticket', generates a fresh client nonce and derives the early data key
+ *    from the resumption secret and the nonce - it doesn't need the server's nonce.
+ * 2. Encrypts the file with the early data key and sends the resumption request, the file's cksum and all
+ *    the file's packets in a single write.
+ * 3. If the server accepted the ticket, derives the AES key for the rest of the session and saves the new ticket -
+ *    even if the file itself didn't get through.
+ * 4. If the ticket is unreadable or the request failed before the server accepted it, deletes 'session.ticket'.
+ */
+
+static int resume_session_with_early_data(ClientSocket& sock, ResponseReader& reader, Client& client, string& aes_key, const PreparedFile& file) {
+	int operation_success = RESUMPTION_REJECTED;
+
+	try {
+		SessionTicket session_ticket = use_session_ticket_file();
+		string client_nonce = generateSessionNonce();
+
+		string early_data_key = deriveEarlyDataKey(session_ticket.resumption_secret, client_nonce);
+		AESWrapper early_data_wrapper(reinterpret_cast<const unsigned char*>(early_data_key.c_str()), static_cast<unsigned int>(early_data_key.size()));
+		unsigned long file_cksum;
+		TransferString file_encrypted_content = encrypt_prepared_file(early_data_wrapper, file, file_cksum);
+		uint32_t content_size = file_encrypted_content.length();
+		reportFileSizes(file.content.length(), content_size);
+
+		RequestHeader send_file_request_header(client.getUuid(), Codes::SENDING_FILE_CODE, PayloadSize::SEND_FILE_PAYLOAD_SIZE);
+		SendFilePayload send_file_request_payload(content_size, file.content.length(), TOTAL_PACKETS(content_size), client.getFilePath(), file_encrypted_content);
+		SendFileRequest send_file_request(send_file_request_header, std::move(send_file_request_payload));
+
+		RequestHeader resume_request_header(client.getUuid(), Codes::EARLY_DATA_RESUMPTION_CODE, PayloadSize::EARLY_DATA_RESUMPTION_PAYLOAD_SIZE);
+		EarlyDataResumptionPayload resume_request_payload(client.getName(), client_nonce, session_ticket.ticket, file_cksum);
+		EarlyDataResumeRequest resume_request(resume_request_header, resume_request_payload, send_file_request);
+
+		operation_success = resume_request.run(sock, reader);
+		if (operation_success == SUCCESS || operation_success == EARLY_DATA_NOT_CONFIRMED || operation_success == EARLY_DATA_NOT_RECEIVED) {
+			aes_key = deriveResumedAESKey(session_ticket.resumption_secret, client_nonce, resume_request.getPayload()->getServerNonce());
+			save_session_ticket({ deriveResumptionSecret(aes_key), resume_request.getPayload()->getNewTicket() });
+			return operation_success;
+		}
+	}
+	catch (std::exception& e) {
+		LOG_WARNING({}, "%s", e.what());
+	}
+
+	// the ticket can't be used anymore, reconnections will use RSA until a new ticket is issued.
+	std::filesystem::remove(EXE_DIR_FILE_PATH("session.ticket"));
+	return operation_success;
+}
+
+// Logs that a request of the upload failed, and returns it as the upload's outcome.
+static UploadOutcome upload_failed(const char* request) {
+	LOG_ERROR({}, "%s request failed.", request);
+	return { false, string(request) + " request failed" };
+}
+
+/** run_client
+ * Executes the client operation, handling registration, reconnection,
+ * and file transfer processes based on the client's state.
+ *
+ * @param sock A reference to a TCP socket for communication with the server.
+ * @param reader The connection's response reader, shared by every request on the socket.
+ * @param client A reference to a Client object containing the client's information.
+ * @param prepared_file A shared future of the file's content and cksum, being read in the background.
+ * @param file_size The size of the file's content, known before it is prepared (UNKNOWN_FILE_SIZE if it isn't).
+ *
+ * This function performs the following steps:
+ * 1. Checks if the 'me.info' file exists to determine if the client needs to register.
+ *    - If the file does not exist, it sends a registration request to the server while generating
+ *      an RSA key pair in the background, saves the client information, and sends the public key.
+ *      If the client is configured for X25519, it sends an X25519 public key instead and derives the AES key.
+ * 2. If the 'me.info' file exists:
+ *    - Reads the client's information. If a 'session.ticket' file exists, it first tries to resume
+ *      the session with it, deriving the AES key without RSA. A file smaller than EARLY_DATA_MAX_FILE_SIZE
+ *      is sent along with the resumption request, and if the server confirms it there is nothing left to do.
+ *    - Otherwise (or if the ticket was rejected), sends a reconnection request to the server, and handles
+ *      the responses accordingly.
+ *    - If registered but not reconnected, it creates a new key pair, saves the client info,
+ *      and sends the public key.
+ *    - If the client is already registered and connected, it decrypts the AES key (with the key from the
+ *      binary 'priv.cache' when it is valid and matches 'me.info', skipping the Base64 and ASN.1 parsing),
+ *      or derives it from the server's ephemeral X25519 public key if the client registered with X25519.
+ *    - After any full key exchange, it asks the server for a resumption ticket for the next runs.
+ * 3. After obtaining the AES key, it waits for the prepared file and encrypts it, then enters a loop to send the file:
+ *    - Sends the encrypted content to the server and compares the returned CRC with the file's cksum.
+ *    - If the server responds with an incorrect checksum, it resends the CRC until a maximum
+ *      number of attempts is reached.
+ *    Requests the server doesn't answer before the file (the ticket request, and the sending crc again request)
+ *    aren't run on their own, they are pipelined into the same write as the next request.
+ * 4. If the maximum attempts are reached, it notifies the server; otherwise, it sends a valid
+ *    CRC request.
+ *
+ * @return Whether the server confirmed the file, and if it didn't, the request that failed or the CRC that
+ *         never matched.
+ */
+UploadOutcome run_client(ClientSocket& sock, ResponseReader& reader, Client& client, std::shared_future<PreparedFile>& prepared_file, uintmax_t file_size) {
+	int operation_success;
+	int early_data_result = RESUMPTION_REJECTED;
+	string private_key, decrypted_aes_key;
+	std::unique_ptr<ResumptionTicketRequest> ticket_request;
+
+	// if me.info does not exist, send registration request.
+	if (!(std::filesystem::exists(EXE_DIR_FILE_PATH("me.info")))) {
+		// the RSA key pair doesn't depend on the server's response, generate it while the registration request is running.
+		std::future<std::unique_ptr<RSAPrivateWrapper>> rsa_key_generation;
+		if (client.getKeyExchange() == KeyExchange::RSA) {
+			rsa_key_generation = std::async(std::launch::async, generateRSAKeyPair);
+		}
+
+		string client_name = client.getName();
+		RequestHeader request_header(client.getUuid(), Codes::REGISTRATION_CODE, PayloadSize::REGISTRATION_PAYLOAD_SIZE);
+		RegistrationPayload registration_payload(client_name);
+		RegisterRequest register_request(request_header, registration_payload);
+		PhaseTimer registration_timer(RunPhase::Registration);
+		operation_success = register_request.run(sock, reader);
+		registration_timer.stop();
+
+		if (operation_success == FAILURE) {
+			return upload_failed("Register");
+		}
+		client.setUUID(register_request.getHeader().getUUID());
+		LOG_INFO(LogFields().withUuid(client.getUuid()), "REGISTER REQUEST COMPLETED");
+
+		// save the new private key into me.info and prev.key files, and exchange the AES key with the server.
+		PhaseTimer key_exchange_timer(RunPhase::KeyExchange);
+		operation_success = exchange_key(sock, reader, client, decrypted_aes_key, rsa_key_generation);
+		key_exchange_timer.stop();
+
+		if (operation_success == FAILURE) {
+			return upload_failed("sending public key");
+		}
+		LOG_INFO(LogFields().withUuid(client.getUuid()), "SEND PUBLIC KEY COMPLETED");
+
+		// ask for a resumption ticket so the next runs can reconnect without RSA.
+		ticket_request = create_session_ticket_request(client);
+	}
+
+	else {
+		// if me.info does exist, read id and send reconnection request.
+		// read the fields from the client.
+		string key_base64 = use_me_info_file(client);
+
+		// if we hold a resumption ticket, try to reconnect without RSA first - with the file itself if it's small enough.
+		bool resumed = false;
+		if (std::filesystem::exists(EXE_DIR_FILE_PATH("session.ticket"))) {
+			PhaseTimer resumption_timer(RunPhase::Resumption);
+			if (file_size < EARLY_DATA_MAX_FILE_SIZE) {
+				early_data_result = resume_session_with_early_data(sock, reader, client, decrypted_aes_key, prepared_file.get());
+				if (early_data_result == FAILURE) {
+					return upload_failed("Resume");
+				}
+				// if the file didn't get through, reconnect and send it as usual.
+				resumed = early_data_result != RESUMPTION_REJECTED && early_data_result != EARLY_DATA_NOT_RECEIVED;
+			}
+			else {
+				resumed = resume_session(sock, reader, client, decrypted_aes_key);
+			}
+		}
+
+		if (resumed) {
+			LOG_INFO(LogFields().withUuid(client.getUuid()), "RESUME REQUEST COMPLETED");
+		}
+		else {
+			// send reconnection request to the server
+			RequestHeader reconnect_request_header(client.getUuid(), Codes::RECONNECTION_CODE, PayloadSize::RECONNECTION_PAYLOAD_SIZE);
+
+			string username = client.getName();
+			ReconnectionPayload reconnect_request_payload(username);
+
+			ReconnectRequest reconnect_request(reconnect_request_header, reconnect_request_payload);
+			PhaseTimer reconnection_timer(RunPhase::Reconnection);
+			operation_success = reconnect_request.run(sock, reader);
+			reconnection_timer.stop();
+			PhaseTimer key_exchange_timer(RunPhase::KeyExchange);
+
+			if (operation_success == FAILURE) {
+				return upload_failed("Reconnect");
+			}
+			else if (operation_success == REGISTERED_NOT_RECONNECTED) {
+				client.setUUID(reconnect_request.getHeader().getUUID());
+				// create a new key pair, save fields data into me.info and prev.key files, and exchange the AES key.
+				std::future<std::unique_ptr<RSAPrivateWrapper>> no_pending_rsa_key;
+				operation_success = exchange_key(sock, reader, client, decrypted_aes_key, no_pending_rsa_key);
+
+				if (operation_success == FAILURE) {
+					return upload_failed("sending public key");
+				}
+				LOG_INFO(LogFields().withUuid(client.getUuid()), "SEND PUBLIC KEY COMPLETED");
+			}
+			else if (operation_success == RECONNECTED_WITH_X25519) {
+				// decode the X25519 private key and agree on the AES key with the server's ephemeral public key
+				private_key = Base64Wrapper::decode(key_base64);
+				X25519Wrapper x25519_wrapper(private_key);
+
+				string server_public_key = reconnect_request.getPayload()->getServerPublicKey();
+				decrypted_aes_key = x25519_wrapper.agreeAESKey(server_public_key);
+			}
+			else{
+				// get the encrypted aes key and decrypt it with the decryptor from the binary key cache
+				string encrypted_aes_key = reconnect_request.getPayload()->getEncryptedAESKey();
+				std::unique_ptr<RSAPrivateWrapper> rsa_wrapper = loadRSAKeyCache(EXE_DIR_FILE_PATH("priv.cache"), client.getUuid(), key_base64);
+				if (rsa_wrapper) {
+					try {
+						decrypted_aes_key = rsa_wrapper->decrypt(encrypted_aes_key);
+					}
+					catch (std::exception& e) {
+						LOG_WARNING({}, "the key cache can't decrypt the AES key, rebuilding it from me.info: %s", e.what());
+						rsa_wrapper.reset();
+					}
+				}
+
+				// or decode the private key if there is no usable cache
+				if (!rsa_wrapper) {
+					private_key = Base64Wrapper::decode(key_base64);
+					rsa_wrapper = std::make_unique<RSAPrivateWrapper>(private_key);
+					cache_rsa_key(client.getUuid(), key_base64, *rsa_wrapper);
+					decrypted_aes_key = rsa_wrapper->decrypt(encrypted_aes_key);
+				}
+			}
+			key_exchange_timer.stop();
+			LOG_INFO(LogFields().withUuid(client.getUuid()), "RECONNECT REQUEST COMPLETED");
+
+			// ask for a resumption ticket so the next runs can reconnect without RSA.
+			ticket_request = create_session_ticket_request(client);
+		}
+	}
+
+	if (early_data_result == SUCCESS) {
+		LOG_INFO(LogFields().withUuid(client.getUuid()), "FILE SENT WITH THE RESUME REQUEST");
+		return { true, "" };
+	}
+
+	AESWrapper aes_key_wrapper(reinterpret_cast<const unsigned char*>(decrypted_aes_key.c_str()), static_cast<unsigned int>(decrypted_aes_key.size()));
+	int times_crc_sent = 0;
+
+	// the file was read (and its cksum computed, unless the session was resumed) while the handshake was running,
+	// encrypt it now that we have the key.
+	const PreparedFile& file = prepared_file.get();
+	unsigned long file_cksum;
+	TransferString file_encrypted_content = encrypt_prepared_file(aes_key_wrapper, file, file_cksum);
+	uint32_t content_size = file_encrypted_content.length();
+	uint32_t orig_file_size = file.content.length();
+	reportFileSizes(orig_file_size, content_size);
+	uint16_t total_packs = TOTAL_PACKETS(content_size);
+
+	// requests waiting to go out in the same write as the next request, the server handles them in order.
+	vector<Request*> pending_requests;
+	std::unique_ptr<InvalidCrcRequest> invalid_crc_request;
+
+	if (ticket_request) {
+		pending_requests.push_back(ticket_request.get());
+	}
+
+	if (early_data_result == EARLY_DATA_NOT_CONFIRMED) {
+		// the server's CRC of the file sent with the resume request was incorrect, send sending crc again request - 901.
+		invalid_crc_request = create_invalid_crc_request(client);
+		pending_requests.push_back(invalid_crc_request.get());
+		times_crc_sent++;
+	}
+
+	while (times_crc_sent != MAX_REQUEST_FAILS) {
+		// send the sending file request to the server.
+		RequestHeader send_file_request_header(client.getUuid(), Codes::SENDING_FILE_CODE, PayloadSize::SEND_FILE_PAYLOAD_SIZE);
+
+		string file_name = client.getFilePath();
+		SendFilePayload send_file_request_payload(content_size, orig_file_size, total_packs , file_name, file_encrypted_content);
+
+		SendFileRequest send_file_request(send_file_request_header, std::move(send_file_request_payload));
+
+		// send the pending requests and the file in one write.
+		pending_requests.push_back(&send_file_request);
+		vector<int> results = runPipeline(sock, reader, pending_requests);
+		operation_success = results.back();
+		pending_requests.clear();
+
+		if (ticket_request) {
+			save_issued_session_ticket(results.front(), *ticket_request, decrypted_aes_key);
+			ticket_request.reset();
+		}
+
+		// the pipeline doesn't resend anything, give the file its usual attempts on its own.
+		if (operation_success == FAILURE) {
+			countRetry(Codes::SENDING_FILE_CODE);
+			operation_success = send_file_request.run(sock, reader);
+		}
+		if (operation_success == FAILURE) {
+			return upload_failed("SEND FILE");
+		}
+		LOG_INFO(LogFields().withUuid(client.getUuid()).withPacket(total_packs), "SEND FILE REQUEST COMPLETED");
+		
+		// get the cksum the server responded with.
+		unsigned long response_cksum = send_file_request.getPayload()->getCksum();
+		LOG_INFO({}, "RESPONSE CRC %lu", response_cksum);
+		if (response_cksum == file_cksum) {
+			LOG_INFO({}, "Correct checksum !");
+			break;
+		}
+
+		// if the crc given by the server is incorrect, send sending crc again request - 901, together with the next request.
+		invalid_crc_request = create_invalid_crc_request(client);
+		pending_requests.push_back(invalid_crc_request.get());
+		// add 1 to times crc sent counter.
+		times_crc_sent++;
+	}
+
+	if (times_crc_sent == MAX_REQUEST_FAILS) {
+		RequestHeader invalid_crc_done_request_header(client.getUuid(), Codes::INVALID_CRC_DONE_CODE, PayloadSize::INVALID_CRC_DONE_PAYLOAD_SIZE);
+		InvalidCrcDonePayload invalid_crc_done_request_payload(client.getFilePath());
+		InvalidCrcDoneRequest invalid_crc_done_request(invalid_crc_done_request_header, invalid_crc_done_request_payload);
+
+		pending_requests.push_back(&invalid_crc_done_request);
+		runPipeline(sock, reader, pending_requests);
+		return { false, "the server's CRC didn't match the file's" };
+	}
+	else {
+		LOG_INFO(LogFields().withUuid(client.getUuid()), "SENT CRC VALID REQUEST");
+		RequestHeader valid_crc_request_header(client.getUuid(), Codes::VALID_CRC_CODE, PayloadSize::VALID_CRC_PAYLOAD_SIZE);
+		ValidCrcPayload valid_crc_request_payload(client.getFilePath());
+		ValidCrcRequest valid_crc_request(valid_crc_request_header, valid_crc_request_payload);
+		operation_success = valid_crc_request.run(sock, reader);
+		if (operation_success == FAILURE) {
+			return upload_failed("VALID CRC");
+		}
+	}
+	return { true, "" };
+}
+
+TransferSession::TransferSession(boost::asio::io_context& io_context, boost::asio::thread_pool& workers, const Client& client, const SocketSettings& settings)
+	: client(client), settings(settings), workers(workers), uploads(workers.get_executor()),
+	connections(io_context, client.getAddress(), client.getPort(), settings, POOLED_CONNECTIONS) {}
+
+/** TransferSession::queue
+ * Queues an upload behind the uploads started before it. It runs on the session's strand once its file is
+ * prepared and every upload ahead of it ran (see runReadyUploads).
+ *
+ * @param file_name The name the server saves the file under.
+ * @param prepared_file The file's content and cksum, being prepared on the thread pool.
+ * @param file_size The size of the file's content (see run_client).
+ * @return A future of the upload's outcome. It holds the exception of an error outside the protocol, such as
+ *         a file that can't be read or a server that can't be reached.
+ */
+std::future<UploadOutcome> TransferSession::queue(const string& file_name, std::shared_future<PreparedFile> prepared_file, uintmax_t file_size) {
+	std::shared_ptr<std::promise<UploadOutcome>> outcome = std::make_shared<std::promise<UploadOutcome>>();
+	std::future<UploadOutcome> result = outcome->get_future();
+	std::lock_guard<std::mutex> lock(this->pending_mutex);
+	this->pending.push_back({ file_name, std::move(prepared_file), file_size, outcome });
+	return result;
+}
+
+/** TransferSession::runReadyUploads
+ * Runs the uploads at the front of the queue whose files are prepared, one after the other. It's posted to the
+ * strand whenever a file is prepared, so it never waits for one: it stops at the first upload whose file isn't
+ * prepared yet, and that file's preparation posts it again.
+ */
+void TransferSession::runReadyUploads() {
+	for (;;) {
+		PendingUpload upload;
+		{
+			std::lock_guard<std::mutex> lock(this->pending_mutex);
+			if (this->pending.empty() || this->pending.front().prepared_file.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+				return;
+			}
+			upload = std::move(this->pending.front());
+			this->pending.pop_front();
+		}
+
+		try {
+			Client upload_client = this->client;
+			upload_client.setFilePath(upload.file_name);
+			ClientSocket sock = this->connections.take();
+			ResponseReader reader;
+			upload.outcome->set_value(run_client(sock, reader, upload_client, upload.prepared_file, upload.file_size));
+		}
+		catch (...) {
+			upload.outcome->set_exception(std::current_exception());
+		}
+	}
+}
+
+/** TransferSession::upload
+ * Starts sending a file, read from the disk on the session's thread pool.
+ *
+ * @param file_path The path of the file, used as given.
+ * @return A future of the upload's outcome (see TransferSession::queue).
+ */
+std::future<UploadOutcome> TransferSession::upload(const string& file_path) {
+	bool use_io_uring = this->settings.io_uring;
+	bool compute_cksum = handshakeHidesCksum();
+	std::shared_ptr<std::packaged_task<PreparedFile()>> preparation = std::make_shared<std::packaged_task<PreparedFile()>>([file_path, use_io_uring, compute_cksum]() {
+		return prepareFile(file_path, use_io_uring, compute_cksum);
+	});
+	std::future<UploadOutcome> outcome = queue(std::filesystem::path(file_path).filename().string(), preparation->get_future().share(), preparedFileSize(file_path));
+
+	// the task is posted through a lambda: asio would take a packaged_task itself for a completion token.
+	boost::asio::post(this->workers, [this, preparation]() {
+		(*preparation)();
+		boost::asio::post(this->uploads, [this]() { runReadyUploads(); });
+	});
+	return outcome;
+}
+
+/** TransferSession::upload
+ * Starts sending a file the caller holds in memory, without writing it to the disk first. There is nothing
+ * to read, so the file is prepared at once, and its cksum is computed in the same pass as its encryption.
+ *
+ * @param file_name The name the server saves the file under.
+ * @param content The file's content.
+ * @return A future of the upload's outcome (see TransferSession::queue).
+ */
+std::future<UploadOutcome> TransferSession::upload(const string& file_name, TransferString content) {
+	uintmax_t file_size = content.length();
+	std::promise<PreparedFile> prepared_file;
+	prepared_file.set_value({ std::move(content), 0, false });
+	std::future<UploadOutcome> outcome = queue(file_name, prepared_file.get_future().share(), file_size);
+	boost::asio::post(this->uploads, [this]() { runReadyUploads(); });
+	return outcome;
+}
@@ -0,0 +1,87 @@
+#ifndef TRANSFER_SESSION_HPP
+#define TRANSFER_SESSION_HPP
+#include "utils.hpp"
+#include "client.hpp"
+#include "connection_pool.hpp"
+#include "response_reader.hpp"
+#include "transfer_buffer.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+// The client's protocol, from the configuration files to the CRC confirmation. The client program (main.cpp)
+// runs it once or as a daemon, and a service that links the client's sources without main.cpp embeds it
+// through TransferSession.
+
+/** PreparedFile
+ * The plaintext of the file to send together with its cksum, produced by prepareFile.
+ * When no handshake hides the CRC pass, the cksum is left to the encryption (AESWrapper::encryptAndChecksum),
+ * which computes it in the same pass over the plaintext.
+ */
+struct PreparedFile {
+	TransferString content;
+	unsigned long cksum;
+	bool has_cksum; // false if the cksum is left to the encryption
+};
+
+constexpr uintmax_t UNKNOWN_FILE_SIZE = UINTMAX_MAX; // the file's size couldn't be read, it isn't sent as early data
+
+// How an upload ended. The caller decides what to do with a failure - the client program puts it in its run
+// report, a service may log it or retry.
+struct UploadOutcome {
+	bool confirmed;  // whether the server confirmed the file
+	string failure;  // why it wasn't, e.g. "Reconnect request failed" (empty if it was)
+};
+
+Client createClient(); // from 'transfer.info', throws if it's missing or invalid
+bool handshakeHidesCksum(); // false when the client will resume its session, see prepareFile
+PreparedFile prepareFile(const string& file_path, bool use_io_uring, bool compute_cksum);
+uintmax_t preparedFileSize(const string& file_path); // the size of the file prepareFile reads, or UNKNOWN_FILE_SIZE
+UploadOutcome run_client(ClientSocket& sock, ResponseReader& reader, Client& client, std::shared_future<PreparedFile>& prepared_file, uintmax_t file_size);
+
+// Sends files to the server on behalf of one client, for a program that embeds the client. Uploads return at
+// once with a future of their outcome, and may be started from any thread. File paths are used as given.
+// A file is read on the caller's thread pool (its cksum is computed there too until the session can be
+// resumed, then in the same pass as its encryption), and the uploads run one at a time, in the order they were
+// started, on a strand of the same pool (they share the client's me.info and session ticket). An upload only
+// goes to the strand once its file is read, so no thread of the pool waits for a file and a pool of one thread
+// works; with more, the next files are read while an upload runs. Every upload takes a connection of the
+// session's pool, the first one registers or reconnects and the following ones resume the session without RSA.
+// Wait for the uploads before destroying the session.
+class TransferSession {
+private:
+	// An upload that was started but didn't run yet.
+	struct PendingUpload {
+		string file_name;
+		std::shared_future<PreparedFile> prepared_file;
+		uintmax_t file_size;
+		std::shared_ptr<std::promise<UploadOutcome>> outcome;
+	};
+
+	Client client;
+	SocketSettings settings;
+	boost::asio::thread_pool& workers;
+	boost::asio::strand<boost::asio::thread_pool::executor_type> uploads;
+	ConnectionPool connections;
+	std::mutex pending_mutex;
+	std::deque<PendingUpload> pending; // in the order the uploads were started
+
+	std::future<UploadOutcome> queue(const string& file_name, std::shared_future<PreparedFile> prepared_file, uintmax_t file_size);
+	void runReadyUploads();
+
+public:
+	TransferSession(boost::asio::io_context& io_context, boost::asio::thread_pool& workers, const Client& client, const SocketSettings& settings);
+
+	TransferSession(const TransferSession&) = delete;
+	TransferSession& operator=(const TransferSession&) = delete;
+
+	std::future<UploadOutcome> upload(const string& file_path); // sent under the file's name, without its directory
+	std::future<UploadOutcome> upload(const string& file_name, TransferString content); // a file held in memory, sent as file_name
+};
+
+#endif
@@ -0,0 +1,383 @@
+#include "uring_io.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
+
+#ifdef HAVE_IO_URING
+#include <algorithm>
+#include <memory>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+constexpr unsigned URING_ENTRIES = 32;
+constexpr size_t URING_READ_BLOCK_SIZE = 1 << 20;    // 1 MiB per read, up to URING_ENTRIES of them in flight
+constexpr size_t MAX_REGISTERED_BUFFER_SIZE = 1 << 30; // the kernel's limit for one registered buffer
+
+static std::system_error uringError(int error, const char* what) {
+	return std::system_error(error, std::generic_category(), what);
+}
+
+IoUring::IoUring(unsigned entries)
+	: ring_fd(-1), sq_ring(MAP_FAILED), sq_ring_size(0), cq_ring(MAP_FAILED), cq_ring_size(0), sqes(nullptr),
+	sqes_size(0), pending_submissions(0) {
+	io_uring_params params = {};
+	this->ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+	if (this->ring_fd < 0) {
+		throw uringError(errno, "io_uring_setup");
+	}
+
+	this->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	this->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		this->sq_ring_size = this->cq_ring_size = std::max(this->sq_ring_size, this->cq_ring_size);
+	}
+
+	this->sq_ring = mmap(nullptr, this->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ring_fd, IORING_OFF_SQ_RING);
+	if (this->sq_ring == MAP_FAILED) {
+		int error = errno;
+		close(this->ring_fd);
+		throw uringError(error, "mmap io_uring");
+	}
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		this->cq_ring = this->sq_ring;
+	}
+	else {
+		this->cq_ring = mmap(nullptr, this->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ring_fd, IORING_OFF_CQ_RING);
+	}
+
+	this->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+	void* sqes_map = mmap(nullptr, this->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ring_fd, IORING_OFF_SQES);
+	if (this->cq_ring == MAP_FAILED || sqes_map == MAP_FAILED) {
+		int error = errno;
+		if (sqes_map != MAP_FAILED) {
+			munmap(sqes_map, this->sqes_size);
+		}
+		if (this->cq_ring != MAP_FAILED && this->cq_ring != this->sq_ring) {
+			munmap(this->cq_ring, this->cq_ring_size);
+		}
+		munmap(this->sq_ring, this->sq_ring_size);
+		close(this->ring_fd);
+		throw uringError(error, "mmap io_uring");
+	}
+	this->sqes = static_cast<io_uring_sqe*>(sqes_map);
+
+	char* sq = static_cast<char*>(this->sq_ring);
+	char* cq = static_cast<char*>(this->cq_ring);
+	this->sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+	this->sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+	this->sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+	this->sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+	this->cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+	this->cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+	this->cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+	this->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+	this->sq_entries = params.sq_entries;
+}
+
+IoUring::~IoUring() {
+	munmap(this->sqes, this->sqes_size);
+	if (this->cq_ring != this->sq_ring) {
+		munmap(this->cq_ring, this->cq_ring_size);
+	}
+	munmap(this->sq_ring, this->sq_ring_size);
+	close(this->ring_fd);
+}
+
+unsigned IoUring::capacity() const {
+	return this->sq_entries;
+}
+
+io_uring_sqe* IoUring::nextSqe() {
+	unsigned head = __atomic_load_n(this->sq_head, __ATOMIC_ACQUIRE);
+	unsigned tail = *this->sq_tail;
+	if (tail - head >= this->sq_entries) {
+		return nullptr;
+	}
+
+	unsigned index = tail & *this->sq_mask;
+	io_uring_sqe* sqe = &this->sqes[index];
+	std::memset(sqe, 0, sizeof(io_uring_sqe));
+	this->sq_array[index] = index;
+	__atomic_store_n(this->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	this->pending_submissions++;
+	return sqe;
+}
+
+/** IoUring::submitAndWait
+ * Hands the queued entries to the kernel and waits until at least `wait_for` completions are in the ring.
+ *
+ * @param wait_for The number of completions to wait for (0 only submits).
+ * @throws std::system_error if io_uring_enter fails.
+ */
+void IoUring::submitAndWait(unsigned wait_for) {
+	while (true) {
+		unsigned flags = wait_for > 0 ? IORING_ENTER_GETEVENTS : 0;
+		long submitted = syscall(__NR_io_uring_enter, this->ring_fd, this->pending_submissions, wait_for, flags, nullptr, 0);
+		if (submitted >= 0) {
+			this->pending_submissions -= static_cast<unsigned>(submitted);
+			if (this->pending_submissions == 0) {
+				return;
+			}
+		}
+		else if (errno != EINTR) {
+			throw uringError(errno, "io_uring_enter");
+		}
+	}
+}
+
+bool IoUring::popCqe(io_uring_cqe& cqe) {
+	unsigned head = *this->cq_head;
+	if (head == __atomic_load_n(this->cq_tail, __ATOMIC_ACQUIRE)) {
+		return false;
+	}
+	cqe = this->cqes[head & *this->cq_mask];
+	__atomic_store_n(this->cq_head, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+void IoUring::waitCqe(io_uring_cqe& cqe) {
+	while (!popCqe(cqe)) {
+		submitAndWait(1);
+	}
+}
+
+bool IoUring::registerBuffers(const struct iovec* buffers, unsigned count) {
+	return syscall(__NR_io_uring_register, this->ring_fd, IORING_REGISTER_BUFFERS, buffers, count) == 0;
+}
+
+void IoUring::unregisterBuffers() {
+	syscall(__NR_io_uring_register, this->ring_fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+}
+
+bool IoUring::supports(uint8_t opcode) const {
+	constexpr unsigned PROBE_OPS = 256;
+	Bytes probe_buffer(sizeof(io_uring_probe) + PROBE_OPS * sizeof(io_uring_probe_op), 0); // the kernel wants it zeroed
+	io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probe_buffer.data());
+
+	if (syscall(__NR_io_uring_register, this->ring_fd, IORING_REGISTER_PROBE, probe, PROBE_OPS) < 0) {
+		return false;
+	}
+	return opcode <= probe->last_op && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED);
+}
+
+
+/** uringFileToString
+ * Reads a whole file with io_uring, straight into the string that returns it.
+ *
+ * This function performs the following steps:
+ * 1. Opens the file and sizes the string to the file's size.
+ * 2. Registers the string's storage with the ring, so the kernel pins it once instead of on every read.
+ * 3. Keeps up to URING_ENTRIES reads of URING_READ_BLOCK_SIZE bytes in flight (READ_FIXED into the registered
+ *    buffer), queuing the next block as each one completes. A short read queues the rest of its block again.
+ * 4. If registering isn't allowed (e.g. the locked memory limit), reads into the same string without it.
+ *
+ * @param full_path The path of the file to read.
+ * @param content Set to the file's content.
+ * @return true if the file was read, false if io_uring isn't available or the file couldn't be read -
+ *         the caller then reads it with fileToString.
+ */
+bool uringFileToString(const string& full_path, TransferString& content) {
+	int fd = open(full_path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+		close(fd);
+		return false;
+	}
+
+	TraceSpan span("io_uring read file", static_cast<int64_t>(file_stat.st_size));
+	try {
+		IoUring ring(URING_ENTRIES);
+		size_t file_size = static_cast<size_t>(file_stat.st_size);
+		content.assign(file_size, '\0');
+
+		struct iovec registered = { content.data(), file_size };
+		bool fixed = file_size > 0 && file_size <= MAX_REGISTERED_BUFFER_SIZE && ring.registerBuffers(&registered, 1);
+
+		// every block is one request: user_data is its offset, and a short read asks again for what's left of it.
+		size_t next_block = 0;
+		size_t in_flight = 0;
+		size_t end_of_file = file_size;
+		auto queue_read = [&](size_t offset, size_t length) {
+			io_uring_sqe* sqe = ring.nextSqe();
+			sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+			sqe->fd = fd;
+			sqe->addr = reinterpret_cast<uint64_t>(content.data() + offset);
+			sqe->len = static_cast<uint32_t>(length);
+			sqe->off = offset;
+			sqe->buf_index = 0;
+			sqe->user_data = offset;
+			in_flight++;
+		};
+
+		while (next_block < file_size && in_flight < ring.capacity()) {
+			queue_read(next_block, std::min(URING_READ_BLOCK_SIZE, file_size - next_block));
+			next_block += URING_READ_BLOCK_SIZE;
+		}
+
+		while (in_flight > 0) {
+			ring.submitAndWait(1);
+			io_uring_cqe cqe;
+			while (ring.popCqe(cqe)) {
+				in_flight--;
+				size_t offset = static_cast<size_t>(cqe.user_data);
+				size_t block_end = std::min(offset - offset % URING_READ_BLOCK_SIZE + URING_READ_BLOCK_SIZE, file_size);
+				if (cqe.res < 0) {
+					throw uringError(-cqe.res, "io_uring read");
+				}
+				if (cqe.res == 0) {
+					end_of_file = std::min(end_of_file, offset); // the file shrank since fstat
+				}
+				else if (offset + cqe.res < block_end) {
+					queue_read(offset + cqe.res, block_end - offset - cqe.res);
+				}
+			}
+			while (next_block < file_size && in_flight < ring.capacity()) {
+				queue_read(next_block, std::min(URING_READ_BLOCK_SIZE, file_size - next_block));
+				next_block += URING_READ_BLOCK_SIZE;
+			}
+		}
+
+		if (fixed) {
+			ring.unregisterBuffers();
+		}
+		content.resize(end_of_file);
+	}
+	catch (std::exception& e) {
+		LOG_WARNING({}, "Reading the file with io_uring failed, falling back: %s", e.what());
+		close(fd);
+		content.clear();
+		return false;
+	}
+
+	close(fd);
+	return true;
+}
+
+// The ring the sends of this thread go through, set up on its first send. Every thread has its own, the ring
+// isn't locked: the sessions of a program that embeds the client send on their connections from several threads.
+static thread_local std::unique_ptr<IoUring> send_ring;
+static thread_local bool send_ring_unavailable = false;
+static thread_local bool zero_copy_unavailable = false;
+
+static IoUring* sendRing() {
+	if (!send_ring && !send_ring_unavailable) {
+		try {
+			send_ring = std::make_unique<IoUring>(URING_ENTRIES);
+			zero_copy_unavailable = !send_ring->supports(IORING_OP_SEND_ZC);
+		}
+		catch (std::exception& e) {
+			LOG_WARNING({}, "io_uring is unavailable, sending with asio: %s", e.what());
+			send_ring_unavailable = true;
+		}
+	}
+	return send_ring.get();
+}
+
+/** uringSend
+ * Sends buffers on the socket, in order, with one io_uring submission.
+ *
+ * This function performs the following steps:
+ * 1. Queues a send per buffer on the calling thread's ring, linked (IOSQE_IO_LINK) so the kernel runs them in
+ *    order, with MSG_WAITALL so each one sends its whole buffer, and MSG_MORE on all but the last so the buffers
+ *    leave as full segments. Where the kernel has it the sends are zero copy (IORING_OP_SEND_ZC): the data goes
+ *    to the NIC from the buffers themselves.
+ * 2. Waits for every completion, and for the notifications of zero copy sends - until they arrive the kernel
+ *    may still read the buffers, which belong to the caller.
+ * 3. A short send breaks the chain (the sends after it are cancelled), so the rest is queued again from there.
+ *
+ * The buffers aren't registered with the ring: they change with every call, so registering them would pin
+ * their pages on every call anyway, on top of a register and an unregister system call.
+ *
+ * @param sock A reference to the connected TCP socket.
+ * @param buffers The buffers to send, in order.
+ * @return false if io_uring isn't available, nothing was sent and the caller should send with asio.
+ * @throws boost::system::system_error if a send fails after the transfer started.
+ */
+bool uringSend(tcp::socket& sock, const vector<boost::asio::const_buffer>& buffers) {
+	IoUring* ring = sendRing();
+	if (ring == nullptr) {
+		return false;
+	}
+
+	size_t index = 0;  // the first buffer that wasn't completely sent
+	size_t offset = 0; // how much of it was sent
+	bool sent_anything = false;
+	while (index < buffers.size()) {
+		size_t chain_end = std::min(buffers.size(), index + ring->capacity());
+		for (size_t i = index; i < chain_end; i++) {
+			size_t start = i == index ? offset : 0;
+			io_uring_sqe* sqe = ring->nextSqe();
+			sqe->opcode = zero_copy_unavailable ? IORING_OP_SEND : IORING_OP_SEND_ZC;
+			sqe->fd = sock.native_handle();
+			sqe->addr = reinterpret_cast<uint64_t>(static_cast<const char*>(buffers[i].data()) + start);
+			sqe->len = static_cast<uint32_t>(buffers[i].size() - start);
+			sqe->msg_flags = MSG_WAITALL | MSG_NOSIGNAL | (i + 1 < buffers.size() ? MSG_MORE : 0);
+			sqe->user_data = i;
+			if (i + 1 < chain_end) {
+				sqe->flags = IOSQE_IO_LINK;
+			}
+		}
+
+		TraceSpan span("io_uring send chain", static_cast<int64_t>(chain_end - index));
+		vector<int> results(chain_end - index, 0);
+		size_t completions = chain_end - index;
+		long notifications = 0; // zero copy sends post a notification after their completion
+		ring->submitAndWait(static_cast<unsigned>(completions));
+		while (completions > 0 || notifications > 0) {
+			io_uring_cqe cqe;
+			ring->waitCqe(cqe);
+			if (cqe.flags & IORING_CQE_F_NOTIF) {
+				notifications--;
+				continue;
+			}
+			if (cqe.flags & IORING_CQE_F_MORE) {
+				notifications++;
+			}
+			results[cqe.user_data - index] = cqe.res;
+			completions--;
+		}
+
+		size_t chain_start = index;
+		for (size_t i = chain_start; i < chain_end; i++) {
+			int result = results[i - chain_start];
+			size_t start = i == chain_start ? offset : 0;
+			if (result == -EOPNOTSUPP && !sent_anything && !zero_copy_unavailable) {
+				// the socket can't send zero copy - send the same buffers again as plain sends.
+				zero_copy_unavailable = true;
+				break;
+			}
+			if (result < 0) {
+				throw boost::system::system_error(-result, boost::system::system_category(), "io_uring send");
+			}
+			sent_anything = sent_anything || result > 0;
+			countBytesWritten(static_cast<size_t>(result), true);
+			if (static_cast<size_t>(result) < buffers[i].size() - start) {
+				offset = start + result;
+				break;
+			}
+			index = i + 1;
+			offset = 0;
+		}
+	}
+	return true;
+}
+
+#else
+
+bool uringFileToString(const string&, TransferString&) {
+	return false;
+}
+
+bool uringSend(tcp::socket&, const vector<boost::asio::const_buffer>&) {
+	return false;
+}
+
+#endif
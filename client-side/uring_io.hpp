@@ -0,0 +1,60 @@
+#ifndef URING_IO_HPP
+#define URING_IO_HPP
+#include "utils.hpp"
+
+// io_uring is only built where the kernel headers have it. Everywhere else (and on kernels or sandboxes
+// that refuse io_uring_setup) the functions below return false and the callers use their asio / iostream path.
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define HAVE_IO_URING 1
+#endif
+
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+
+// A minimal io_uring instance over the raw system calls: the submission and completion rings mapped into
+// the process, and the few operations the client needs. It isn't locked: one thread at a time uses a ring.
+class IoUring {
+private:
+	int ring_fd;
+	void* sq_ring;
+	size_t sq_ring_size;
+	void* cq_ring;
+	size_t cq_ring_size;
+	io_uring_sqe* sqes;
+	size_t sqes_size;
+
+	unsigned* sq_head;
+	unsigned* sq_tail;
+	unsigned* sq_mask;
+	unsigned* sq_array;
+	unsigned* cq_head;
+	unsigned* cq_tail;
+	unsigned* cq_mask;
+	io_uring_cqe* cqes;
+	unsigned sq_entries;
+	unsigned pending_submissions;
+
+public:
+	explicit IoUring(unsigned entries); // throws std::system_error if the kernel won't set up a ring
+	~IoUring();
+
+	IoUring(const IoUring&) = delete;
+	IoUring& operator=(const IoUring&) = delete;
+
+	unsigned capacity() const;
+	io_uring_sqe* nextSqe(); // a zeroed entry, or nullptr when the submission ring is full
+	void submitAndWait(unsigned wait_for);
+	bool popCqe(io_uring_cqe& cqe);
+	void waitCqe(io_uring_cqe& cqe);
+
+	bool registerBuffers(const struct iovec* buffers, unsigned count);
+	void unregisterBuffers();
+	bool supports(uint8_t opcode) const;
+};
+#endif
+
+bool uringFileToString(const string& full_path, TransferString& content);
+bool uringSend(tcp::socket& sock, const vector<boost::asio::const_buffer>& buffers);
+
+#endif
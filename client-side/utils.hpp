@@ -1,101 +1,123 @@
-#ifndef UTILS_HPP
-#define UTILS_HPP
-
-#include <fstream>
-#include <iostream>
-#include <string>
-#include <string.h>    
-#include <vector>
-#include <filesystem>
-
-#include <boost/asio.hpp>
-#include <boost/uuid/uuid.hpp>
-#include <boost/uuid/uuid_io.hpp>
-//#include <boost/uuid/nil.hpp>
-#include <boost/uuid/nil_generator.hpp>
-#include <boost/endian/conversion.hpp>
-#include <boost/uuid/string_generator.hpp>
-
-#include "AESWrapper.hpp"
-#include "Base64Wrapper.hpp"
-#include "RSAWrapper.hpp"
-
-#include "codes.hpp"
-#include "payloads_sizes.hpp"
-
-
-namespace uuids = boost::uuids;
-
-using std::cout;
-using std::cin;
-
-using std::vector;
-using std::string;
-using std::ifstream;
-using std::ofstream;
-using std::fstream;
-
-using boost::asio::ip::tcp;
-using UUID = boost::uuids::uuid;
-const UUID NIL_UUID = boost::uuids::nil_uuid();
-using UUIDGenerator = boost::uuids::string_generator;
-using boost::uuids::to_string;
-using boost::endian::little_to_native;
-using boost::endian::native_to_little;
-
-using Byte = uint8_t;
-using Bytes = std::vector<Byte>;
-
-constexpr auto VERSION = 3;
-constexpr auto MAX_USERNAME_LENGTH = 255;
-constexpr auto PUBLIC_KEY_LENGTH = 160;
-constexpr auto ENCRYPTED_AES_KEY_LENGTH = 128;
-constexpr auto MAX_FILE_NAME_LENGTH = 255;
-constexpr auto REQUEST_HEADER_SIZE = 23;
-constexpr auto RESPONSE_HEADER_SIZE = 7;
-constexpr auto HEX_ID_LENGTH = 32;
-constexpr size_t CONTENT_SIZE_PER_PACKET = 1024;
-constexpr auto MAX_REQUEST_FAILS = 3;
-constexpr size_t UUID_SIZE = 16;
-
-constexpr size_t SEND_FILE_REQUEST_HEADER_EXTRAS_SIZE = 267;
-
-
-constexpr int SUCCESS = 0;
-constexpr int FAILURE = 1;
-constexpr int REGISTERED_NOT_RECONNECTED = 2;
-
-
-const std::string EXE_DIR = "client.cpp\\..\\..\\x64\\debug"; //Todo: change later cuz folders
-#define EXE_DIR_FILE_PATH(file_name) (EXE_DIR + "\\" + file_name)
-#define FATAL_MESSAGE_RETURN(type) \
-	std::cerr << "Fatal: " << type << " request failed.\n"; \
-	return;
-
-#define TOTAL_PACKETS(content_size) \
-	((content_size % CONTENT_SIZE_PER_PACKET) ? (content_size/CONTENT_SIZE_PER_PACKET + 1) : content_size/CONTENT_SIZE_PER_PACKET)
-
-
-
-Bytes operator+(const Bytes& first, const Bytes& second);
-std::ostream& operator<<(std::ostream & os, const Bytes & bytes);
-UUID getUUIDFromString(string client_id);
-bool is_integer(const std::string& num);
-uint16_t extractCodeFromResponseHeader(const Bytes& header);
-uint32_t extractPayloadSizeFromResponseHeader(const Bytes& header);
-uint32_t extractPayloadContentSize(Bytes response_payload);
-string extractSendFileResponseFileName(Bytes response_payload);
-unsigned long extractSendFileResponseCksum(Bytes response_payload);
-
-// This method receives two uuids, one as a vector<uint8_s> (Bytes) and one as a boost::uuids::uuid type, and checks if they're identical.
-bool are_uuids_equal(const Bytes first, const UUID second);
-
-uint32_t htole32(uint32_t x);
-uint16_t htole16(uint16_t x);
-
-string fileToString(std::string file_path);
-Bytes stringToBytes(const string & input);
-
-
-
+#ifndef UTILS_HPP
+#define UTILS_HPP
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string.h>    
+#include <string_view>
+#include <vector>
+#include <filesystem>
+
+#include <boost/asio.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_io.hpp>
+//#include <boost/uuid/nil.hpp>
+#include <boost/uuid/nil_generator.hpp>
+#include <boost/endian/conversion.hpp>
+#include <boost/uuid/string_generator.hpp>
+
+#include "AESWrapper.hpp"
+#include "Base64Wrapper.hpp"
+#include "RSAWrapper.hpp"
+#include "X25519Wrapper.hpp"
+
+#include "codes.hpp"
+#include "transfer_buffer.hpp"
+#include "run_report.hpp"
+#include "log.hpp"
+#include "payloads_sizes.hpp"
+
+
+namespace uuids = boost::uuids;
+
+using std::cout;
+using std::cin;
+
+using std::vector;
+using std::string;
+using std::ifstream;
+using std::ofstream;
+using std::fstream;
+
+using boost::asio::ip::tcp;
+using UUID = boost::uuids::uuid;
+const UUID NIL_UUID = boost::uuids::nil_uuid();
+using UUIDGenerator = boost::uuids::string_generator;
+using boost::uuids::to_string;
+using boost::endian::little_to_native;
+using boost::endian::native_to_little;
+
+using Byte = uint8_t;
+using Bytes = std::vector<Byte, TransferAllocator<Byte>>; // aligned, and on huge pages when it holds a whole file
+
+constexpr auto VERSION = 3;
+constexpr auto MAX_USERNAME_LENGTH = 255;
+constexpr auto PUBLIC_KEY_LENGTH = 160;
+constexpr auto ENCRYPTED_AES_KEY_LENGTH = 128;
+constexpr auto MAX_FILE_NAME_LENGTH = 255;
+constexpr auto REQUEST_HEADER_SIZE = 23;
+constexpr auto RESPONSE_HEADER_SIZE = 7;
+constexpr auto HEX_ID_LENGTH = 32;
+constexpr size_t CONTENT_SIZE_PER_PACKET = 1024;
+constexpr auto MAX_REQUEST_FAILS = 3;
+constexpr size_t UUID_SIZE = 16;
+constexpr size_t TICKET_LENGTH = 112;
+constexpr size_t SESSION_NONCE_LENGTH = 16;
+constexpr size_t RESUMPTION_SECRET_LENGTH = 32;
+constexpr size_t X25519_KEY_LENGTH = 32;
+constexpr size_t EARLY_DATA_MAX_FILE_SIZE = 4 * CONTENT_SIZE_PER_PACKET; // files smaller than this are sent with the resumption request
+
+constexpr size_t SEND_FILE_REQUEST_HEADER_EXTRAS_SIZE = 267;
+
+
+constexpr int SUCCESS = 0;
+constexpr int FAILURE = 1;
+constexpr int REGISTERED_NOT_RECONNECTED = 2;
+constexpr int RESUMPTION_REJECTED = 3;
+constexpr int RECONNECTED_WITH_X25519 = 4;
+constexpr int EARLY_DATA_NOT_CONFIRMED = 5;
+constexpr int EARLY_DATA_NOT_RECEIVED = 6; // the ticket was accepted, but not the file sent along with it
+
+
+const std::string EXE_DIR = "client.cpp\\..\\..\\x64\\debug"; //Todo: change later cuz folders
+#define EXE_DIR_FILE_PATH(file_name) (EXE_DIR + "\\" + file_name)
+
+#define TOTAL_PACKETS(content_size) \
+	((content_size % CONTENT_SIZE_PER_PACKET) ? (content_size/CONTENT_SIZE_PER_PACKET + 1) : content_size/CONTENT_SIZE_PER_PACKET)
+
+
+
+Bytes operator+(const Bytes& first, const Bytes& second);
+std::ostream& operator<<(std::ostream & os, const Bytes & bytes);
+UUID getUUIDFromString(string client_id);
+bool is_integer(const std::string& num);
+uint16_t extractCodeFromResponseHeader(const Byte* header);
+uint32_t extractPayloadSizeFromResponseHeader(const Byte* header);
+uint32_t extractPayloadContentSize(const Byte* response_payload);
+std::string_view extractSendFileResponseFileName(const Byte* response_payload, size_t payload_size);
+unsigned long extractSendFileResponseCksum(const Byte* response_payload);
+
+// This method receives two uuids, one as the raw 16 bytes of a response and one as a boost::uuids::uuid type, and checks if they're identical.
+bool are_uuids_equal(const Byte* first, const UUID& second);
+
+// glibc's <endian.h> defines htole32 and htole16 as macros, which would rename the functions below.
+#undef htole32
+#undef htole16
+uint32_t htole32(uint32_t x);
+uint16_t htole16(uint16_t x);
+
+// strcpy_s and memcpy_s are MSVC's, other compilers get the same bounds checked copies from utils.cpp.
+#ifndef _MSC_VER
+using errno_t = int;
+errno_t strcpy_s(char* destination, size_t destination_size, const char* source);
+errno_t memcpy_s(void* destination, size_t destination_size, const void* source, size_t count);
+#endif
+
+TransferString fileToString(const std::string& full_path);
+Bytes stringToBytes(const string & input);
+string getEnvironmentVariable(const char* name);
+
+
+
 #endif
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "wire_capture.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+bool capture_enabled = false;
+
+// The connection is only used by one thread, the mutex keeps the records whole if that ever changes.
+static std::mutex capture_mutex;
+static ofstream capture_file;
+static bool session_started = false;
+static std::chrono::steady_clock::time_point last_record_time;
+
+static void writeVarint(uint64_t value) {
+	char bytes[10];
+	size_t length = 0;
+	do {
+		Byte byte = value & 0x7f;
+		value >>= 7;
+		bytes[length++] = static_cast<char>(value != 0 ? byte | 0x80 : byte);
+	} while (value != 0);
+	capture_file.write(bytes, length);
+}
+
+static bool readVarint(std::istream& input, uint64_t& value) {
+	value = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		int byte = input.get();
+		if (byte == EOF) {
+			return false;
+		}
+		value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/** startCapture
+ * Turns the capture on if the TRANSFER_CAPTURE environment variable names a file to append the session to.
+ *
+ * This function performs the following steps:
+ * 1. Opens the file for appending, and writes CAPTURE_MAGIC if it's new (or empty).
+ * 2. Refuses a file that doesn't start with CAPTURE_MAGIC, so nothing else gets appended to.
+ * The session record itself is written with the first bytes captured, so the time it takes to connect
+ * isn't part of the session.
+ */
+void startCapture() {
+	string capture_path = getEnvironmentVariable("TRANSFER_CAPTURE");
+	if (capture_path.empty()) {
+		return;
+	}
+
+	std::error_code error;
+	uintmax_t existing_size = std::filesystem::file_size(capture_path, error);
+	if (!error && existing_size > 0) {
+		char magic[sizeof(CAPTURE_MAGIC)] = {};
+		ifstream existing(capture_path, std::ios::binary);
+		existing.read(magic, sizeof(magic));
+		if (!std::equal(std::begin(magic), std::end(magic), std::begin(CAPTURE_MAGIC))) {
+			LOG_WARNING({}, "%s isn't a capture file, the connection isn't captured", capture_path.c_str());
+			return;
+		}
+	}
+
+	capture_file.open(capture_path, std::ios::binary | std::ios::app);
+	if (!capture_file) {
+		LOG_WARNING({}, "Couldn't open %s, the connection isn't captured", capture_path.c_str());
+		return;
+	}
+	if (error || existing_size == 0) {
+		capture_file.write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+	}
+	capture_enabled = true;
+}
+
+// Writes the type of a record and its time, starting the session first if this is its first record.
+// capture_mutex must be held.
+static void writeRecordStart(CaptureRecordType type) {
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (!session_started) {
+		capture_file.put(static_cast<char>(CaptureRecordType::Session));
+		writeVarint(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+		last_record_time = now;
+		session_started = true;
+	}
+	capture_file.put(static_cast<char>(type));
+	writeVarint(std::chrono::duration_cast<std::chrono::microseconds>(now - last_record_time).count());
+	last_record_time = now;
+}
+
+/** captureSent
+ * Appends a write on the socket to the capture, as one Sent record holding every buffer in order.
+ *
+ * @param buffers The buffers about to be written.
+ */
+void captureSent(const vector<boost::asio::const_buffer>& buffers) {
+	std::lock_guard<std::mutex> lock(capture_mutex);
+	writeRecordStart(CaptureRecordType::Sent);
+	writeVarint(boost::asio::buffer_size(buffers));
+	for (const boost::asio::const_buffer& buffer : buffers) {
+		capture_file.write(static_cast<const char*>(buffer.data()), buffer.size());
+	}
+}
+
+/** captureReceived
+ * Appends a read from the socket to the capture, as one Received record.
+ *
+ * @param data The bytes read.
+ * @param size How many bytes were read.
+ */
+void captureReceived(const Byte* data, size_t size) {
+	std::lock_guard<std::mutex> lock(capture_mutex);
+	writeRecordStart(CaptureRecordType::Received);
+	writeVarint(size);
+	capture_file.write(reinterpret_cast<const char*>(data), size);
+}
+
+/** stopCapture
+ * Flushes the captured session to the file and closes it.
+ */
+void stopCapture() {
+	if (!capture_enabled) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(capture_mutex);
+	capture_file.close();
+	if (capture_file.fail()) {
+		LOG_WARNING({}, "Couldn't write the whole capture, the last session may be cut short");
+	}
+	capture_enabled = false;
+}
+
+/** readCapture
+ * Reads every session of a capture file.
+ *
+ * A session cut short (the client crashed in the middle of a record) keeps the records before the cut.
+ *
+ * @param path The capture file.
+ * @return The sessions, in the order they were captured.
+ * @throws std::runtime_error if the file can't be read or doesn't start with CAPTURE_MAGIC.
+ */
+vector<CapturedSession> readCapture(const string& path) {
+	ifstream input(path, std::ios::binary);
+	char magic[sizeof(CAPTURE_MAGIC)] = {};
+	if (!input.read(magic, sizeof(magic)) || !std::equal(std::begin(magic), std::end(magic), std::begin(CAPTURE_MAGIC))) {
+		throw std::runtime_error(path + " isn't a capture file");
+	}
+
+	vector<CapturedSession> sessions;
+	int type;
+	while ((type = input.get()) != EOF) {
+		uint64_t time_us;
+		if (!readVarint(input, time_us)) {
+			break;
+		}
+		if (type == static_cast<int>(CaptureRecordType::Session)) {
+			sessions.push_back({ time_us, {} });
+			continue;
+		}
+
+		if (sessions.empty() || (type != static_cast<int>(CaptureRecordType::Sent) && type != static_cast<int>(CaptureRecordType::Received))) {
+			throw std::runtime_error(path + " has a broken record");
+		}
+		uint64_t size;
+		if (!readVarint(input, size)) {
+			break;
+		}
+		CapturedSession& session = sessions.back();
+		uint64_t previous_offset = session.records.empty() ? 0 : session.records.back().offset_us;
+		CaptureRecord record{ static_cast<CaptureRecordType>(type), previous_offset + time_us, Bytes(static_cast<size_t>(size)) };
+		if (!input.read(reinterpret_cast<char*>(record.data.data()), static_cast<std::streamsize>(size))) {
+			break;
+		}
+		session.records.push_back(std::move(record));
+	}
+	return sessions;
+}
@@ -0,0 +1,45 @@
+#ifndef WIRE_CAPTURE_HPP
+#define WIRE_CAPTURE_HPP
+#include "utils.hpp"
+
+// Wire capture: when the TRANSFER_CAPTURE environment variable names a file, every byte the client sends and
+// receives on its connection is appended to it, with the time it went out or came in. The session can then be
+// replayed against a server without the client (see benchmarks/wire_replay.cpp), so no keys are generated and
+// nothing is encrypted again.
+//
+// The file starts with CAPTURE_MAGIC, followed by records. Each record starts with its type (one byte):
+//   Session  | microseconds since the epoch (varint)                                    - a new connection
+//   Sent     | microseconds since the previous record (varint) | size (varint) | the bytes
+//   Received | microseconds since the previous record (varint) | size (varint) | the bytes
+// Varints are LEB128: 7 bits per byte, the least significant first. Every run appends its own session, so one
+// file can collect many runs - one client at a time, their records aren't interleaved.
+constexpr char CAPTURE_MAGIC[8] = { 'W', 'I', 'R', 'E', 'C', 'A', 'P', 1 }; // the last byte is the format version
+
+enum class CaptureRecordType : uint8_t {
+	Session = 1,
+	Sent = 2,
+	Received = 3
+};
+
+struct CaptureRecord {
+	CaptureRecordType type; // Sent or Received
+	uint64_t offset_us;     // since the start of the session
+	Bytes data;
+};
+
+struct CapturedSession {
+	uint64_t start_us;      // since the epoch
+	vector<CaptureRecord> records;
+};
+
+// Set once by startCapture, before the client connects.
+extern bool capture_enabled;
+
+void startCapture();
+void captureSent(const vector<boost::asio::const_buffer>& buffers);
+void captureReceived(const Byte* data, size_t size);
+void stopCapture();
+
+vector<CapturedSession> readCapture(const string& path); // throws std::runtime_error if it isn't a capture file
+
+#endif
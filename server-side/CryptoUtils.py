@@ -1,56 +1,207 @@
-from Crypto.Cipher import PKCS1_OAEP, AES
-from Crypto.Random import get_random_bytes
-from Crypto.Util.Padding import unpad
-
-def encrypt_aes_key_with_public_key(aes_key, public_key):
-    """
-       Encrypts an AES key using a given RSA public key.
-
-       This function utilizes the PKCS1 OAEP padding scheme to encrypt the AES key.
-
-       Args:
-           aes_key (bytes): The AES key to encrypt.
-           public_key (Crypto.PublicKey.RSA._RSAobj): The RSA public key used for encryption.
-
-       Returns:
-           bytes: The encrypted AES key.
-       """
-    rsa_cipher = PKCS1_OAEP.new(public_key)
-    encrypted_key = rsa_cipher.encrypt(aes_key)
-    return encrypted_key
-
-
-def decrypt_file_with_aes_key(encrypted_file, aes_key):
-    """
-        Decrypts an encrypted file using a given AES key.
-
-        This function assumes that the initialization vector (IV) is zeroed out for the decryption process.
-
-        Args:
-            encrypted_file (bytes): The encrypted data to decrypt.
-            aes_key (bytes): The AES key used for decryption.
-
-        Returns:
-            bytes: The decrypted data.
-
-        Raises:
-            ValueError: If the padding is incorrect after decryption.
-        """
-    iv = bytes(16)  # Reset IV to zeros for decryption
-    cipher = AES.new(aes_key, AES.MODE_CBC, iv)
-    decrypted_data = unpad(cipher.decrypt(encrypted_file), AES.block_size)
-    return decrypted_data
-
-def compute_new_aes_key(key_size=256):
-    """
-        Generates a new random AES key.
-
-        The key size can be specified. The default size is 256 bits.
-
-        Args:
-            key_size (int): The size of the AES key in bits. Must be either 128, 192, or 256.
-
-        Returns:
-            bytes: A randomly generated AES key.
-        """
-    return get_random_bytes(key_size // 8)
+import hashlib
+import hmac
+import struct
+import time
+
+from Crypto.Cipher import PKCS1_OAEP, AES
+from Crypto.Protocol.DH import key_agreement
+from Crypto.PublicKey import ECC
+from Crypto.Random import get_random_bytes
+from Crypto.Util.Padding import pad, unpad
+
+SESSION_TICKET_LENGTH = 112  # 16 bytes IV + 64 bytes encrypted state + 32 bytes HMAC-SHA256 tag
+SESSION_TICKET_LIFETIME_SECONDS = 24 * 60 * 60
+SESSION_TICKET_STATE_FORMAT = '<16s Q 32s'  # client_id, issue time, resumption secret
+
+def encrypt_aes_key_with_public_key(aes_key, public_key):
+    """
+       Encrypts an AES key using a given RSA public key.
+
+       This function utilizes the PKCS1 OAEP padding scheme to encrypt the AES key.
+
+       Args:
+           aes_key (bytes): The AES key to encrypt.
+           public_key (Crypto.PublicKey.RSA._RSAobj): The RSA public key used for encryption.
+
+       Returns:
+           bytes: The encrypted AES key.
+       """
+    rsa_cipher = PKCS1_OAEP.new(public_key)
+    encrypted_key = rsa_cipher.encrypt(aes_key)
+    return encrypted_key
+
+
+def decrypt_file_with_aes_key(encrypted_file, aes_key):
+    """
+        Decrypts an encrypted file using a given AES key.
+
+        This function assumes that the initialization vector (IV) is zeroed out for the decryption process.
+
+        Args:
+            encrypted_file (bytes): The encrypted data to decrypt.
+            aes_key (bytes): The AES key used for decryption.
+
+        Returns:
+            bytes: The decrypted data.
+
+        Raises:
+            ValueError: If the padding is incorrect after decryption.
+        """
+    iv = bytes(16)  # Reset IV to zeros for decryption
+    cipher = AES.new(aes_key, AES.MODE_CBC, iv)
+    decrypted_data = unpad(cipher.decrypt(encrypted_file), AES.block_size)
+    return decrypted_data
+
+def compute_new_aes_key(key_size=256):
+    """
+        Generates a new random AES key.
+
+        The key size can be specified. The default size is 256 bits.
+
+        Args:
+            key_size (int): The size of the AES key in bits. Must be either 128, 192, or 256.
+
+        Returns:
+            bytes: A randomly generated AES key.
+        """
+    return get_random_bytes(key_size // 8)
+
+
+def compute_new_ticket_keys():
+    """
+        Generates the server's secret keys used to seal resumption tickets.
+
+        Tickets sealed with these keys can only be opened by this server process, so a restart
+        invalidates every ticket and the clients fall back to the RSA reconnection.
+
+        Returns:
+            tuple: (encryption_key, mac_key), 32 random bytes each.
+        """
+    return get_random_bytes(32), get_random_bytes(32)
+
+
+def derive_resumption_secret(aes_key):
+    """
+        Derives the resumption secret bound to a session's AES key.
+
+        The client derives the same secret on its side, so it never goes over the wire.
+
+        Args:
+            aes_key (bytes): The AES key of the session.
+
+        Returns:
+            bytes: A 32 bytes long resumption secret.
+        """
+    return hmac.new(aes_key, b"resumption", hashlib.sha256).digest()
+
+
+def derive_resumed_aes_key(resumption_secret, client_nonce, server_nonce):
+    """
+        Derives the AES key of a resumed session from the ticket's secret and both nonces.
+
+        Args:
+            resumption_secret (bytes): The secret stored inside the ticket.
+            client_nonce (bytes): The 16 bytes nonce sent by the client.
+            server_nonce (bytes): The 16 bytes nonce the server answers with.
+
+        Returns:
+            bytes: A fresh 256 bits AES key.
+        """
+    return hmac.new(resumption_secret, b"session key" + client_nonce + server_nonce, hashlib.sha256).digest()
+
+
+def derive_early_data_key(resumption_secret, client_nonce):
+    """
+        Derives the AES key of the file a client sends along with its resumption request.
+
+        The client sends the file before it gets the server's nonce, so only its own nonce is mixed in.
+        A replay of the request can only upload the same file again, and the rest of the session uses
+        the key from derive_resumed_aes_key.
+
+        Args:
+            resumption_secret (bytes): The secret stored inside the ticket.
+            client_nonce (bytes): The 16 bytes nonce sent by the client.
+
+        Returns:
+            bytes: A 256 bits AES key.
+        """
+    return hmac.new(resumption_secret, b"early data key" + client_nonce, hashlib.sha256).digest()
+
+
+def seal_session_ticket(ticket_keys, client_id, resumption_secret):
+    """
+        Builds a resumption ticket that only this server can open.
+
+        The ticket holds the client id, the issue time and the resumption secret, encrypted with
+        AES-CBC and authenticated with HMAC-SHA256, so the server doesn't need to store it.
+
+        Args:
+            ticket_keys (tuple): The (encryption_key, mac_key) pair of the server.
+            client_id (bytes): The UUID of the client the ticket is issued to.
+            resumption_secret (bytes): The 32 bytes secret the client holds alongside the ticket.
+
+        Returns:
+            bytes: A SESSION_TICKET_LENGTH bytes long ticket.
+        """
+    encryption_key, mac_key = ticket_keys
+    iv = get_random_bytes(AES.block_size)
+    state = struct.pack(SESSION_TICKET_STATE_FORMAT, client_id, int(time.time()), resumption_secret)
+    encrypted_state = AES.new(encryption_key, AES.MODE_CBC, iv).encrypt(pad(state, AES.block_size))
+    tag = hmac.new(mac_key, iv + encrypted_state, hashlib.sha256).digest()
+    return iv + encrypted_state + tag
+
+
+def open_session_ticket(ticket_keys, ticket):
+    """
+        Verifies and opens a resumption ticket sealed by seal_session_ticket.
+
+        Args:
+            ticket_keys (tuple): The (encryption_key, mac_key) pair of the server.
+            ticket (bytes): The ticket presented by the client.
+
+        Returns:
+            tuple: (client_id, resumption_secret) stored in the ticket.
+
+        Raises:
+            ValueError: If the ticket was forged, altered or has expired.
+        """
+    encryption_key, mac_key = ticket_keys
+    if len(ticket) != SESSION_TICKET_LENGTH:
+        raise ValueError("Resumption ticket has a wrong length")
+
+    iv, encrypted_state, tag = ticket[:AES.block_size], ticket[AES.block_size:-32], ticket[-32:]
+    if not hmac.compare_digest(tag, hmac.new(mac_key, iv + encrypted_state, hashlib.sha256).digest()):
+        raise ValueError("Resumption ticket failed authentication")
+
+    state = unpad(AES.new(encryption_key, AES.MODE_CBC, iv).decrypt(encrypted_state), AES.block_size)
+    client_id, issued_at, resumption_secret = struct.unpack(SESSION_TICKET_STATE_FORMAT, state)
+    if time.time() - issued_at > SESSION_TICKET_LIFETIME_SECONDS:
+        raise ValueError("Resumption ticket has expired")
+    return client_id, resumption_secret
+
+
+def agree_x25519_aes_key(client_public_key):
+    """
+        Agrees on a new AES key with a client that uses the X25519 key exchange.
+
+        The server generates an ephemeral X25519 key pair for every agreement, so each session gets
+        a fresh key even though the client's key pair is long-lived. The AES key is derived from the
+        shared secret and both public keys, the same way the client derives it.
+
+        Args:
+            client_public_key (Crypto.PublicKey.ECC.EccKey): The client's X25519 public key.
+
+        Returns:
+            tuple: (aes_key, server_public_key) - a 256 bits AES key and the raw 32 bytes public key
+                   of the ephemeral key pair, to send to the client.
+        """
+    server_key = ECC.generate(curve='Curve25519')
+    server_public_key = server_key.public_key().export_key(format='raw')
+    client_public_key_bytes = client_public_key.export_key(format='raw')
+
+    def derive_aes_key(shared_secret):
+        return hmac.new(shared_secret, b"x25519 session key" + client_public_key_bytes + server_public_key,
+                        hashlib.sha256).digest()
+
+    aes_key = key_agreement(static_priv=server_key, static_pub=client_public_key, kdf=derive_aes_key)
+    return aes_key, server_public_key
\ No newline at end of file
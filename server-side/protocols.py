@@ -1,229 +1,507 @@
-import struct
-from abc import abstractmethod
-
-from Crypto.PublicKey import RSA
-
-import Response
-from Request import ClientRequestCodes, receive_public_key, ClientRequestPayloadSizes, RequestHeader, \
-    RequestPayloadFormats, receive_client_crc_conformation_message
-from CryptoUtils import compute_new_aes_key, encrypt_aes_key_with_public_key
-from Request import Request
-
-
-class Protocol:
-    def __init__(self, server, conn):
-        self.server = server
-        self.conn = conn
-
-    @abstractmethod
-    def protocol(self, header: RequestHeader):
-        """
-               Abstract method for handling protocol-specific logic.
-
-               Args:
-                   header (RequestHeader): The header containing request information.
-        """
-        pass
-
-
-class RegisterRequestProtocol(Protocol):
-    def __init__(self, server, conn):
-        super().__init__(server, conn)
-
-    def protocol(self, header: RequestHeader):
-        """
-               Handles the registration protocol.
-
-               Args:
-                   header (RequestHeader): The header containing request information.
-        """
-        print("Initiating RegisterRequestProtocol!")
-        try:
-            payload = Request.receive_payload_bytes(conn=self.conn,
-                                                    payload_size=ClientRequestPayloadSizes.REGISTER_REQUEST_PAYLOAD_SIZE.value)
-            username = payload[:255].decode('utf-8').rstrip('\x00')
-
-            if not self.server.get_database().is_username_already_registered(username):
-                uuid = self.server.get_database().add_new_user_to_database(username=username)
-                Response.send_register_success_response(self, uuid)
-            else:
-                raise Exception("User already exists in database trying to register")
-
-        except Exception as error:
-            print(error)
-            Response.send_registration_failed_response(self)
-            return  # Exiting in case of failure
-        try:
-            public_key_bytes = receive_public_key(conn=self.conn, username=username, uuid=uuid)
-            public_key = RSA.import_key(public_key_bytes)
-            self.server.get_database().set_new_user_public_key(username=username, public_key=public_key)
-            aes_key = self.server.get_database().get_user_by_uuid(uuid).get_aes_key()
-            encrypted_aes_key = encrypt_aes_key_with_public_key(aes_key=aes_key, public_key=public_key)
-            Response.send_encrypted_aes_key_response(self, uuid, encrypted_aes_key)
-
-        except Exception as error:
-            print(error)
-            Response.send_general_server_error(self)
-
-
-class SendFileRequestProtocol(Protocol):
-    def __init__(self, server, conn):
-        super().__init__(server, conn)
-
-    def protocol(self, header: RequestHeader):
-        """
-               Handles the file sending protocol.
-
-               Args:
-                   header (RequestHeader): The header containing request information.
-        """
-        try:
-            if self.server.get_database().does_uuid_already_exist(header.client_id):
-                payload = Request.receive_payload_bytes(conn=self.conn, payload_size=header.payload_size)
-                payload_dict = self.get_payload_dict(payload)
-                self.server.get_database().save_user_file_data(header.client_id, payload_dict)
-                user = self.server.get_database().get_user_by_uuid(header.client_id)
-                if not user.received_entire_file():
-                    header = Request.receive_request_header(conn=self.conn)
-                    if header.client_id != user.get_uuid() or header.code != ClientRequestCodes.SEND_FILE_REQUEST.value:
-                        Response.send_general_server_error(self)
-                        return
-                    self.protocol(header=header)
-                    return
-
-                user.get_file().decrypt_and_write_file_data_to_memory(aes_key=user.get_aes_key())
-                file_crc = user.get_file().get_crc()
-                encrypted_content_size = user.get_file().get_encrypted_content_size()
-                Response.send_file_received_crc_response(
-                    self, client_id=header.client_id,
-                    encrypted_content_size=encrypted_content_size,
-                    message_file_name=payload_dict["file_name"],
-                    file_checksum_value=file_crc)
-
-                # Receiving the client crc conformation code
-                crc_conformation_code = receive_client_crc_conformation_message(
-                    conn=self.conn, file_name=payload_dict["file_name"],
-                    client_id=header.client_id)
-
-                # Handling the conformation code we got
-                self.handle_crc_conformation_code(crc_conformation_code=crc_conformation_code,
-                                                  client_id=header.client_id)
-            else:
-                raise KeyError("UUID doesn't exist in database, tried to initiate send file protocol")
-
-        except OSError as error:
-            print(error)
-            Response.send_general_server_error(self)
-        print("FINISHED METHOD")
-    @staticmethod
-    def get_payload_dict(payload: bytes):
-        """
-               Unpacks the payload bytes into a structured dictionary.
-
-               Args:
-                   payload (bytes): The raw bytes received from the client.
-
-               Returns:
-                   dict: A dictionary containing the unpacked data, including content size,
-                         original file size, packet number, total packets, file name, and message content.
-        """
-        # Unpack the first 265 bytes (the header extras)
-        payload_format = RequestPayloadFormats.SEND_FILE_REQUEST_PAYLOAD_FORMAT.value
-        header_extras_size = ClientRequestPayloadSizes.SEND_FILE_REQUEST_HEADER_EXTRAS_SIZE.value
-        unpacked_data = struct.unpack(payload_format, payload)
-        content_size, orig_file_size, packet_number, total_packets, file_name_bytes, content = unpacked_data
-
-        file_name = file_name_bytes.decode('utf-8').rstrip('\x00')  # Clean null termination
-
-        # Return the unpacked header data and the remaining payload (message content)
-        return {
-            'content_size': content_size,
-            'orig_file_size': orig_file_size,
-            'packet_number': packet_number,
-            'total_packets': total_packets,
-            'file_name': file_name,
-            'message_content': payload[header_extras_size:]
-        }
-
-    def handle_crc_conformation_code(self, crc_conformation_code, client_id):
-        """
-               Handles the CRC confirmation code received from the client.
-
-               Args:
-                   crc_conformation_code: The confirmation code received from the client.
-                   client_id: The UUID of the client.
-
-               Raises:
-                   ValueError: If the confirmation code does not match any expected values.
-        """
-        print("Handle CRC")
-        if crc_conformation_code == ClientRequestCodes.ADEQUATE_CRC_VALUE.value:
-            Response.send_receive_message_thanks_response(self, client_id=client_id)
-        elif crc_conformation_code == ClientRequestCodes.INADEQUATE_CRC_VALUE.value:
-            return
-        elif crc_conformation_code == ClientRequestCodes.INADEQUATE_CRC_VALUE_FOR_THE_FORTH_TIME.value:
-            self.server.get_database().get_user_by_uuid(client_id).clear_file_data()
-            Response.send_receive_message_thanks_response(self, client_id=client_id)
-        else:  # The client replied with a crc conformation value that does not match any expected reply code
-            self.server.get_database().get_user_by_uuid(client_id).clear_file_data()
-            raise ValueError("Client replied with a crc conformation value that does not match any expected reply code")
-
-
-class ReconnectionRequestProtocol(Protocol):
-    def __init__(self, server, conn):
-        super().__init__(server, conn)
-
-    def protocol(self, header: RequestHeader):
-        """
-               Handles the reconnection protocol.
-
-               Args:
-                   header (RequestHeader): The header containing request information.
-
-               Raises:
-                   ValueError: If the reconnection request payload size is incorrect.
-        """
-        print("Initiating ReconnectionRequestProtocol!")
-        try:
-            if header.payload_size != ClientRequestPayloadSizes.RECONNECTION_REQUEST_PAYLOAD_SIZE.value:
-                raise ValueError("Reconnection Request wrong payload size")
-
-            payload = Request.receive_payload_bytes(conn=self.conn, payload_size=header.payload_size)
-            username = payload.decode("utf-8").rstrip('\x00')
-
-            if not self.server.get_database().is_username_already_registered(
-                    username) or self.server.get_database().get_user_by_uuid(header.client_id).get_public_key() is None:
-
-                self.server.get_database().remove_user_if_registered(username, header.client_id)
-                self.register_user(username)
-            else:
-                aes_key = compute_new_aes_key()
-                self.server.get_database().get_user_by_uuid(header.client_id).set_aes_key(aes_key)
-
-                # Clear the packet dictionary.
-                self.server.get_database().get_user_by_uuid(header.client_id).get_file().clear_dict()
-                public_key = self.server.get_database().get_user_by_uuid(header.client_id).get_public_key()
-                encrypted_aes_key = encrypt_aes_key_with_public_key(aes_key=aes_key, public_key=public_key)
-                Response.send_reconnect_request_accepted_sending_aes_key_response(self, header.client_id,
-                                                                                  encrypted_aes_key=encrypted_aes_key)
-
-        except OSError as error:
-            print(error)
-            Response.send_general_server_error(self)
-            return
-
-    def register_user(self, username):
-        """
-                Registers a new user during the reconnection process.
-
-                Args:
-                    username (str): The username of the user to register.
-        """
-        uuid = self.server.get_database().add_new_user_to_database(username=username)
-        Response.send_reconnect_request_has_been_rejected_response(self, uuid)
-
-        public_key_bytes = receive_public_key(conn=self.conn, username=username, uuid=uuid)
-        public_key = RSA.import_key(public_key_bytes)
-        aes_key = self.server.get_database().get_user_by_uuid(uuid=uuid).get_aes_key()
-        encrypted_aes_key = encrypt_aes_key_with_public_key(aes_key=aes_key, public_key=public_key)
-        Response.send_encrypted_aes_key_response(self, uuid, encrypted_aes_key)
+import struct
+from abc import abstractmethod
+
+from Crypto.Protocol.DH import import_x25519_public_key
+from Crypto.PublicKey import RSA, ECC
+from Crypto.Random import get_random_bytes
+
+import Response
+from Request import ClientRequestCodes, receive_public_key, ClientRequestPayloadSizes, RequestHeader, \
+    RequestPayloadFormats, receive_client_crc_conformation_message
+from CryptoUtils import compute_new_aes_key, encrypt_aes_key_with_public_key, derive_resumption_secret, \
+    derive_resumed_aes_key, seal_session_ticket, open_session_ticket, agree_x25519_aes_key, derive_early_data_key
+from Request import Request
+
+
+class Protocol:
+    def __init__(self, server, conn):
+        self.server = server
+        self.conn = conn
+
+    @abstractmethod
+    def protocol(self, header: RequestHeader):
+        """
+               Abstract method for handling protocol-specific logic.
+
+               Args:
+                   header (RequestHeader): The header containing request information.
+        """
+        pass
+
+    def exchange_aes_key(self, username, uuid: bytes):
+        """
+               Receives the new public key of a user and sends it the AES key of the session.
+
+               An RSA public key is answered with the AES key encrypted with it. An X25519 public key
+               is answered with the public key of an ephemeral server key pair, and both sides derive
+               the AES key from the shared secret.
+
+               Args:
+                   username (str): The username of the user.
+                   uuid (bytes): The UUID of the user.
+        """
+        request_code, public_key_bytes = receive_public_key(conn=self.conn, username=username, uuid=uuid)
+        database = self.server.get_database()
+
+        if request_code == ClientRequestCodes.SEND_X25519_PUBLIC_KEY_REQUEST.value:
+            public_key = import_x25519_public_key(public_key_bytes)
+            database.set_new_user_public_key(username=username, public_key=public_key)
+            aes_key, server_public_key = agree_x25519_aes_key(client_public_key=public_key)
+            database.get_user_by_uuid(uuid).set_aes_key(aes_key)
+            Response.send_x25519_public_key_received_response(self, uuid, server_public_key)
+        else:
+            public_key = RSA.import_key(public_key_bytes)
+            database.set_new_user_public_key(username=username, public_key=public_key)
+            aes_key = database.get_user_by_uuid(uuid).get_aes_key()
+            encrypted_aes_key = encrypt_aes_key_with_public_key(aes_key=aes_key, public_key=public_key)
+            Response.send_encrypted_aes_key_response(self, uuid, encrypted_aes_key)
+
+
+class RegisterRequestProtocol(Protocol):
+    def __init__(self, server, conn):
+        super().__init__(server, conn)
+
+    def protocol(self, header: RequestHeader):
+        """
+               Handles the registration protocol.
+
+               Args:
+                   header (RequestHeader): The header containing request information.
+        """
+        print("Initiating RegisterRequestProtocol!")
+        try:
+            payload = Request.receive_payload_bytes(conn=self.conn,
+                                                    payload_size=ClientRequestPayloadSizes.REGISTER_REQUEST_PAYLOAD_SIZE.value)
+            username = payload[:255].decode('utf-8').rstrip('\x00')
+
+            if not self.server.get_database().is_username_already_registered(username):
+                uuid = self.server.get_database().add_new_user_to_database(username=username)
+                Response.send_register_success_response(self, uuid)
+            else:
+                raise Exception("User already exists in database trying to register")
+
+        except Exception as error:
+            print(error)
+            Response.send_registration_failed_response(self)
+            return  # Exiting in case of failure
+        try:
+            self.exchange_aes_key(username=username, uuid=uuid)
+
+        except Exception as error:
+            print(error)
+            Response.send_general_server_error(self)
+
+
+class SendFileRequestProtocol(Protocol):
+    def __init__(self, server, conn, aes_key=None):
+        super().__init__(server, conn)
+        self.aes_key = aes_key  # Decrypts the file instead of the user's AES key (for a file sent with a resumption)
+
+    def protocol(self, header: RequestHeader):
+        """
+               Handles the file sending protocol.
+
+               Args:
+                   header (RequestHeader): The header containing request information.
+
+               Returns:
+                   bool: True if the client's CRC didn't match and it sends the file again (901).
+        """
+        try:
+            if self.server.get_database().does_uuid_already_exist(header.client_id):
+                payload_dict = self.receive_file(header=header)
+                user = self.server.get_database().get_user_by_uuid(header.client_id)
+
+                file_crc = user.get_file().get_crc()
+                encrypted_content_size = user.get_file().get_encrypted_content_size()
+                Response.send_file_received_crc_response(
+                    self, client_id=header.client_id,
+                    encrypted_content_size=encrypted_content_size,
+                    message_file_name=payload_dict["file_name"],
+                    file_checksum_value=file_crc)
+
+                crc_conformation_code = self.receive_crc_conformation(client_id=header.client_id,
+                                                                      file_name=payload_dict["file_name"])
+                print("FINISHED METHOD")
+                return crc_conformation_code == ClientRequestCodes.INADEQUATE_CRC_VALUE.value
+            else:
+                raise KeyError("UUID doesn't exist in database, tried to initiate send file protocol")
+
+        except (OSError, ValueError) as error:
+            print(error)
+            Response.send_general_server_error(self)
+        print("FINISHED METHOD")
+        return False
+
+    def receive_file(self, header: RequestHeader):
+        """
+               Receives every packet of a file, starting with the packet of the given header, and decrypts it.
+
+               Args:
+                   header (RequestHeader): The header of the file's first packet.
+
+               Returns:
+                   dict: The payload dictionary of the file's last packet.
+
+               Raises:
+                   ValueError: If a packet of another request or another client arrives before the file is complete.
+        """
+        user = self.server.get_database().get_user_by_uuid(header.client_id)
+        while True:
+            payload = Request.receive_payload_bytes(conn=self.conn, payload_size=header.payload_size)
+            payload_dict = self.get_payload_dict(payload)
+            self.server.get_database().save_user_file_data(header.client_id, payload_dict)
+            if user.received_entire_file():
+                break
+
+            header = Request.receive_request_header(conn=self.conn)
+            if header.client_id != user.get_uuid() or header.code != ClientRequestCodes.SEND_FILE_REQUEST.value:
+                raise ValueError("Expected the next packet of the file")
+
+        aes_key = self.aes_key if self.aes_key is not None else user.get_aes_key()
+        user.get_file().decrypt_and_write_file_data_to_memory(aes_key=aes_key)
+        return payload_dict
+
+    def receive_crc_conformation(self, client_id, file_name):
+        """
+               Receives the client's answer to the CRC the server computed, and handles it.
+
+               Args:
+                   client_id: The UUID of the client.
+                   file_name (str): The name of the file the CRC belongs to.
+
+               Returns:
+                   int: The client's confirmation code.
+        """
+        # Receiving the client crc conformation code
+        crc_conformation_code = receive_client_crc_conformation_message(
+            conn=self.conn, file_name=file_name, client_id=client_id)
+
+        # Handling the conformation code we got
+        self.handle_crc_conformation_code(crc_conformation_code=crc_conformation_code, client_id=client_id)
+        return crc_conformation_code
+
+    @staticmethod
+    def get_payload_dict(payload: bytes):
+        """
+               Unpacks the payload bytes into a structured dictionary.
+
+               Args:
+                   payload (bytes): The raw bytes received from the client.
+
+               Returns:
+                   dict: A dictionary containing the unpacked data, including content size,
+                         original file size, packet number, total packets, file name, and message content.
+        """
+        # Unpack the first 265 bytes (the header extras)
+        payload_format = RequestPayloadFormats.SEND_FILE_REQUEST_PAYLOAD_FORMAT.value
+        header_extras_size = ClientRequestPayloadSizes.SEND_FILE_REQUEST_HEADER_EXTRAS_SIZE.value
+        unpacked_data = struct.unpack(payload_format, payload)
+        content_size, orig_file_size, packet_number, total_packets, file_name_bytes, content = unpacked_data
+
+        file_name = file_name_bytes.decode('utf-8').rstrip('\x00')  # Clean null termination
+
+        # Return the unpacked header data and the remaining payload (message content)
+        return {
+            'content_size': content_size,
+            'orig_file_size': orig_file_size,
+            'packet_number': packet_number,
+            'total_packets': total_packets,
+            'file_name': file_name,
+            'message_content': payload[header_extras_size:]
+        }
+
+    def handle_crc_conformation_code(self, crc_conformation_code, client_id):
+        """
+               Handles the CRC confirmation code received from the client.
+
+               Args:
+                   crc_conformation_code: The confirmation code received from the client.
+                   client_id: The UUID of the client.
+
+               Raises:
+                   ValueError: If the confirmation code does not match any expected values.
+        """
+        print("Handle CRC")
+        if crc_conformation_code == ClientRequestCodes.ADEQUATE_CRC_VALUE.value:
+            Response.send_receive_message_thanks_response(self, client_id=client_id)
+        elif crc_conformation_code == ClientRequestCodes.INADEQUATE_CRC_VALUE.value:
+            # The client sends the file again, its packets replace these ones
+            self.server.get_database().get_user_by_uuid(client_id).clear_file_data()
+        elif crc_conformation_code == ClientRequestCodes.INADEQUATE_CRC_VALUE_FOR_THE_FORTH_TIME.value:
+            self.server.get_database().get_user_by_uuid(client_id).clear_file_data()
+            Response.send_receive_message_thanks_response(self, client_id=client_id)
+        else:  # The client replied with a crc conformation value that does not match any expected reply code
+            self.server.get_database().get_user_by_uuid(client_id).clear_file_data()
+            raise ValueError("Client replied with a crc conformation value that does not match any expected reply code")
+
+
+class ReconnectionRequestProtocol(Protocol):
+    def __init__(self, server, conn):
+        super().__init__(server, conn)
+
+    def protocol(self, header: RequestHeader):
+        """
+               Handles the reconnection protocol.
+
+               Args:
+                   header (RequestHeader): The header containing request information.
+
+               Raises:
+                   ValueError: If the reconnection request payload size is incorrect.
+        """
+        print("Initiating ReconnectionRequestProtocol!")
+        try:
+            if header.payload_size != ClientRequestPayloadSizes.RECONNECTION_REQUEST_PAYLOAD_SIZE.value:
+                raise ValueError("Reconnection Request wrong payload size")
+
+            payload = Request.receive_payload_bytes(conn=self.conn, payload_size=header.payload_size)
+            username = payload.decode("utf-8").rstrip('\x00')
+
+            if not self.server.get_database().is_username_already_registered(
+                    username) or self.server.get_database().get_user_by_uuid(header.client_id).get_public_key() is None:
+
+                self.server.get_database().remove_user_if_registered(username, header.client_id)
+                self.register_user(username)
+            else:
+                # Clear the packet dictionary.
+                user = self.server.get_database().get_user_by_uuid(header.client_id)
+                if user.file is not None:
+                    user.get_file().clear_dict()
+                public_key = self.server.get_database().get_user_by_uuid(header.client_id).get_public_key()
+
+                if isinstance(public_key, ECC.EccKey):
+                    # The user registered with X25519, agree on the new AES key with an ephemeral server key
+                    aes_key, server_public_key = agree_x25519_aes_key(client_public_key=public_key)
+                    self.server.get_database().get_user_by_uuid(header.client_id).set_aes_key(aes_key)
+                    Response.send_reconnect_request_accepted_sending_x25519_public_key_response(
+                        self, header.client_id, server_public_key=server_public_key)
+                    return
+
+                aes_key = compute_new_aes_key()
+                self.server.get_database().get_user_by_uuid(header.client_id).set_aes_key(aes_key)
+                encrypted_aes_key = encrypt_aes_key_with_public_key(aes_key=aes_key, public_key=public_key)
+                Response.send_reconnect_request_accepted_sending_aes_key_response(self, header.client_id,
+                                                                                  encrypted_aes_key=encrypted_aes_key)
+
+        except OSError as error:
+            print(error)
+            Response.send_general_server_error(self)
+            return
+
+    def register_user(self, username):
+        """
+                Registers a new user during the reconnection process.
+
+                Args:
+                    username (str): The username of the user to register.
+        """
+        uuid = self.server.get_database().add_new_user_to_database(username=username)
+        Response.send_reconnect_request_has_been_rejected_response(self, uuid)
+
+        self.exchange_aes_key(username=username, uuid=uuid)
+
+
+class ResumptionRequestProtocol(Protocol):
+    SERVER_NONCE_LENGTH = 16
+
+    def __init__(self, server, conn):
+        super().__init__(server, conn)
+
+    def protocol(self, header: RequestHeader) -> bool:
+        """
+               Handles the resumption protocol - a reconnection with a ticket instead of RSA.
+
+               The AES key of the resumed session is derived from the secret sealed in the ticket
+               and a nonce from each side, and a new ticket is issued in the same response.
+
+               Args:
+                   header (RequestHeader): The header containing request information.
+
+               Returns:
+                   bool: True if the session was resumed, False if the ticket was rejected and the
+                         client is expected to fall back to the reconnection protocol.
+        """
+        print("Initiating ResumptionRequestProtocol!")
+        try:
+            if header.payload_size != ClientRequestPayloadSizes.RESUMPTION_REQUEST_PAYLOAD_SIZE.value:
+                raise ValueError("Resumption Request wrong payload size")
+
+            payload = Request.receive_payload_bytes(conn=self.conn, payload_size=header.payload_size)
+            payload_format = RequestPayloadFormats.RESUMPTION_REQUEST_FORMAT.value
+            username_bytes, client_nonce, ticket = struct.unpack(payload_format, payload)
+            user, resumption_secret = self.open_ticket(header, username_bytes, ticket)
+
+        except (ValueError, KeyError, struct.error) as error:
+            print(error)
+            Response.send_resumption_failed_response(self, header.client_id)
+            return False
+
+        response = self.resume_session(user, resumption_secret, client_nonce)
+        response.response(self.conn)
+        return True
+
+    def open_ticket(self, header: RequestHeader, username_bytes: bytes, ticket: bytes):
+        """
+               Opens the ticket the client presented and checks it was issued to this client.
+
+               Returns:
+                   tuple: (user, resumption_secret) - the user the ticket was issued to and the secret in it.
+
+               Raises:
+                   ValueError: If the ticket can't be opened or belongs to another user.
+                   KeyError: If the client's UUID isn't registered.
+        """
+        username = username_bytes.decode('utf-8').rstrip('\x00')
+
+        ticket_client_id, resumption_secret = open_session_ticket(self.server.get_ticket_keys(), ticket)
+        user = self.server.get_database().get_user_by_uuid(header.client_id)
+        if ticket_client_id != header.client_id or user.get_name() != username:
+            raise ValueError("Resumption ticket was not issued to this user")
+        return user, resumption_secret
+
+    def resume_session(self, user, resumption_secret: bytes, client_nonce: bytes):
+        """
+               Sets the AES key of the resumed session and builds the response carrying the server's
+               nonce and a new ticket.
+
+               Returns:
+                   Response: The RESUMPTION_SUCCEEDED_SENDING_NEW_TICKET response, not sent yet.
+        """
+        server_nonce = get_random_bytes(self.SERVER_NONCE_LENGTH)
+        aes_key = derive_resumed_aes_key(resumption_secret, client_nonce, server_nonce)
+        user.set_aes_key(aes_key)
+
+        # Clear the packet dictionary.
+        if user.file is not None:
+            user.get_file().clear_dict()
+
+        new_ticket = seal_session_ticket(self.server.get_ticket_keys(), user.get_uuid(),
+                                         derive_resumption_secret(aes_key))
+        return Response.build_resumption_succeeded_response(self.server.get_version(), user.get_uuid(),
+                                                            server_nonce, new_ticket)
+
+
+class EarlyDataResumptionRequestProtocol(ResumptionRequestProtocol):
+    def __init__(self, server, conn):
+        super().__init__(server, conn)
+        self.crc_conformation_code = None  # The client's answer to the CRC, if the file's CRC didn't match
+
+    def protocol(self, header: RequestHeader) -> bool:
+        """
+               Handles the 0-RTT resumption protocol - a resumption request immediately followed by the
+               packets of a small file, encrypted with a key derived from the ticket's secret and the client's nonce.
+
+               The request carries the client's cksum of the file, so the server can confirm the file on its
+               own and answer with the new ticket and the file's result in a single write.
+
+               Args:
+                   header (RequestHeader): The header containing request information.
+
+               Returns:
+                   bool: True if the session was resumed and the file received (see file_sent_again), False if
+                         the ticket was rejected or the file couldn't be received - the file is then discarded and
+                         the client is expected to fall back to the reconnection protocol.
+        """
+        print("Initiating EarlyDataResumptionRequestProtocol!")
+        try:
+            if header.payload_size != ClientRequestPayloadSizes.EARLY_DATA_RESUMPTION_REQUEST_PAYLOAD_SIZE.value:
+                raise ValueError("Early Data Resumption Request wrong payload size")
+
+            payload = Request.receive_payload_bytes(conn=self.conn, payload_size=header.payload_size)
+            payload_format = RequestPayloadFormats.EARLY_DATA_RESUMPTION_REQUEST_FORMAT.value
+            username_bytes, client_nonce, ticket, client_crc = struct.unpack(payload_format, payload)
+            user, resumption_secret = self.open_ticket(header, username_bytes, ticket)
+
+        except (ValueError, KeyError, struct.error) as error:
+            print(error)
+            self.discard_early_data()
+            Response.send_resumption_failed_response(self, header.client_id)
+            return False
+
+        resumption_response = self.resume_session(user, resumption_secret, client_nonce)
+
+        # The file sent with the request always starts a new user file
+        user.clear_file_data()
+        early_data_key = derive_early_data_key(resumption_secret, client_nonce)
+        send_file_request_protocol = SendFileRequestProtocol(server=self.server, conn=self.conn, aes_key=early_data_key)
+        try:
+            payload_dict = send_file_request_protocol.receive_file(header=Request.receive_request_header(conn=self.conn))
+        except (OSError, ValueError) as error:
+            print(error)
+            user.clear_file_data()
+            Response.send_responses(self, [resumption_response,
+                                           Response.build_send_general_server_error_response(self.server.get_version())])
+            return False
+
+        file_crc = user.get_file().get_crc()
+        if file_crc == client_crc:
+            Response.send_responses(self, [resumption_response,
+                                           Response.build_receive_message_thanks_response(self.server.get_version(),
+                                                                                          header.client_id)])
+            return True
+
+        # The CRC doesn't match, go on like the file sending protocol: send the CRC and wait for the client's answer
+        Response.send_responses(self, [resumption_response, Response.build_send_file_received_crc_response(
+            self.server.get_version(), client_id=header.client_id,
+            encrypted_content_size=user.get_file().get_encrypted_content_size(),
+            message_file_name=payload_dict["file_name"], file_checksum_value=file_crc)])
+        self.crc_conformation_code = send_file_request_protocol.receive_crc_conformation(
+            client_id=header.client_id, file_name=payload_dict["file_name"])
+        return True
+
+    def file_sent_again(self) -> bool:
+        """
+               Tells whether the client answered the file's CRC with a 901, and sends the file again on the
+               connection - with the resumed session's AES key, like the file sending protocol.
+        """
+        return self.crc_conformation_code == ClientRequestCodes.INADEQUATE_CRC_VALUE.value
+
+    def discard_early_data(self):
+        """
+               Reads and drops the file packets sent along with a rejected resumption request, so the
+               connection can go on with the reconnection protocol.
+        """
+        while True:
+            header = Request.receive_request_header(conn=self.conn)
+            if header.code != ClientRequestCodes.SEND_FILE_REQUEST.value or \
+                    header.payload_size != ClientRequestPayloadSizes.SEND_FILE_REQUEST_PAYLOAD_SIZE.value:
+                print("Expected the packets of the file sent with the resumption request")
+                return
+
+            payload = Request.receive_payload_bytes(conn=self.conn, payload_size=header.payload_size)
+            payload_dict = SendFileRequestProtocol.get_payload_dict(payload)
+            if payload_dict["packet_number"] + 1 >= payload_dict["total_packets"]:
+                return
+
+
+class ResumptionTicketRequestProtocol(Protocol):
+    def __init__(self, server, conn):
+        super().__init__(server, conn)
+
+    def protocol(self, header: RequestHeader):
+        """
+               Issues a resumption ticket for the session the client has just set up with RSA.
+
+               Args:
+                   header (RequestHeader): The header containing request information.
+        """
+        print("Initiating ResumptionTicketRequestProtocol!")
+        try:
+            if header.payload_size != ClientRequestPayloadSizes.RESUMPTION_TICKET_REQUEST_PAYLOAD_SIZE.value:
+                raise ValueError("Resumption Ticket Request wrong payload size")
+
+            payload = Request.receive_payload_bytes(conn=self.conn, payload_size=header.payload_size)
+            username = payload.decode("utf-8").rstrip('\x00')
+
+            user = self.server.get_database().get_user_by_uuid(header.client_id)
+            if user.get_name() != username:
+                raise ValueError("Resumption Ticket Request username does not match the user")
+
+            ticket = seal_session_ticket(self.server.get_ticket_keys(), header.client_id,
+                                         derive_resumption_secret(user.get_aes_key()))
+            Response.send_resumption_ticket_response(self, header.client_id, ticket)
+
+        except (ValueError, KeyError) as error:
+            print(error)
+            Response.send_general_server_error(self)
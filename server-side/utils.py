@@ -1,7 +1,7 @@
-from checksum import memcrc
-
-
-def calculate_checksum_value(file):
-    return memcrc(file)
-
-
+from checksum import memcrc
+
+
+def calculate_checksum_value(file):
+    return memcrc(file)
+
+